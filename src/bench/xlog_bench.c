@@ -0,0 +1,239 @@
+/*
+##########################################################################
+# If not stated otherwise in this file or this component's LICENSE
+# file the following copyright and licenses apply:
+#
+# Copyright 2019 RDK Management
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+##########################################################################
+*/
+// Measures the cost in ns per call of each public entry point for every XLOG_OPTS_* combination, message size and thread
+// quantity.  Output is written to /dev/null so the results exclude the cost of the device.  Results are written as JSON.
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <errno.h>
+#include <getopt.h>
+#include <pthread.h>
+#ifndef XLOG_MODULE_ID
+#define XLOG_MODULE_ID XLOG_MODULE_ID_XLOG
+#endif
+#include "rdkx_logger.h"
+#include "rdkx_logger_private.h"
+
+#define XLOG_BENCH_ITERATIONS  (20000)
+#define XLOG_BENCH_THREADS_MAX (64)
+#define XLOG_BENCH_OPTS_QTY    (XLOG_OPTS_COLOR << 1) // All combinations of XLOG_OPTS_GMT through XLOG_OPTS_COLOR
+
+typedef enum {
+   XLOG_BENCH_ENTRY_PRINTF,
+   XLOG_BENCH_ENTRY_FPRINTF,
+   XLOG_BENCH_ENTRY_DPRINTF,
+   XLOG_BENCH_ENTRY_SNPRINTF,
+   XLOG_BENCH_ENTRY_PRINTF_SAFE,
+   XLOG_BENCH_ENTRY_DISABLED,
+   XLOG_BENCH_ENTRY_QTY
+} xlog_bench_entry_t;
+
+typedef struct {
+   xlog_bench_entry_t entry;
+   const xlog_args_t *args;
+   const char *       message;
+   uint32_t           iterations;
+   FILE *             stream;
+   int                fd;
+   pthread_barrier_t *barrier;
+} xlog_bench_params_t;
+
+static const char *g_entry_names[XLOG_BENCH_ENTRY_QTY] = {
+   "xlog_printf", "xlog_fprintf", "xlog_dprintf", "xlog_snprintf", "xlog_printf_safe", "XLOGD_DEBUG_disabled"
+};
+
+static const uint32_t g_sizes[] = { 16, 128, 1024, XLOG_STACK_BUF_SIZE - 128 };
+
+static void * xlog_bench_thread(void *data);
+static double xlog_bench_run(xlog_bench_params_t *params, uint32_t threads);
+static void   xlog_bench_result(FILE *json, bool *first, xlog_bench_entry_t entry, int options, uint32_t size, uint32_t threads, uint32_t iterations, double ns);
+
+int main(int argc, char *argv[]) {
+   const char *filename    = "xlog_bench.json";
+   uint32_t    iterations  = XLOG_BENCH_ITERATIONS;
+   uint32_t    threads_max = 4;
+   int         opt;
+
+   while((opt = getopt(argc, argv, "o:i:t:h")) != -1) {
+      switch(opt) {
+         case 'o': { filename    = optarg;                     break; }
+         case 'i': { iterations  = strtoul(optarg, NULL, 0);   break; }
+         case 't': { threads_max = strtoul(optarg, NULL, 0);   break; }
+         default: {
+            fprintf(stderr, "Usage: %s [-o FILE] [-i ITERATIONS] [-t THREADS]\n", argv[0]);
+            return((opt == 'h') ? 0 : 1);
+         }
+      }
+   }
+   if(iterations == 0 || threads_max == 0 || threads_max > XLOG_BENCH_THREADS_MAX) {
+      fprintf(stderr, "invalid parameters\n");
+      return(1);
+   }
+
+   FILE *json = fopen(filename, "w");
+   if(json == NULL) {
+      int errsv = errno;
+      fprintf(stderr, "unable to open <%s> <%s>\n", filename, strerror(errsv));
+      return(1);
+   }
+
+   // All output goes to /dev/null including stdout which is used by xlog_printf and xlog_printf_safe
+   int fd = open("/dev/null", O_WRONLY);
+   FILE *stream = fopen("/dev/null", "w");
+   if(fd < 0 || stream == NULL || freopen("/dev/null", "w", stdout) == NULL) {
+      fprintf(stderr, "unable to open /dev/null\n");
+      return(1);
+   }
+
+   char *message = (char *)malloc(g_sizes[sizeof(g_sizes) / sizeof(g_sizes[0]) - 1] + 1);
+   if(message == NULL) {
+      return(1);
+   }
+
+   fprintf(json, "{\n  \"version\": 1,\n  \"stack_buf_size\": %u,\n  \"results\": [\n", XLOG_STACK_BUF_SIZE);
+   bool first = true;
+
+   for(uint32_t entry = 0; entry < XLOG_BENCH_ENTRY_QTY; entry++) {
+      for(int options = 0; options < XLOG_BENCH_OPTS_QTY; options++) {
+         for(uint32_t size_index = 0; size_index < sizeof(g_sizes) / sizeof(g_sizes[0]); size_index++) {
+            uint32_t size = g_sizes[size_index];
+            memset(message, 'x', size);
+            message[size] = '\0';
+
+            xlog_args_t args = {
+               .options  = options,
+               .color    = XLOG_COLOR_YEL,
+               .function = __FUNCTION__,
+               .line     = __LINE__,
+               .level    = (entry == XLOG_BENCH_ENTRY_DISABLED) ? XLOG_LEVEL_DEBUG : XLOG_LEVEL_WARN,
+               .id       = XLOG_MODULE_ID_XLOG
+            };
+            xlog_level_set_all((entry == XLOG_BENCH_ENTRY_DISABLED) ? XLOG_LEVEL_INFO : XLOG_LEVEL_ALL);
+
+            xlog_bench_params_t params = { .entry = entry, .args = &args, .message = message, .iterations = iterations, .stream = stream, .fd = fd };
+
+            for(uint32_t threads = 1; threads <= threads_max; threads <<= 1) {
+               double ns = xlog_bench_run(&params, threads);
+               xlog_bench_result(json, &first, entry, options, size, threads, iterations, ns);
+            }
+            if(entry == XLOG_BENCH_ENTRY_DISABLED) { // Message size has no effect
+               break;
+            }
+         }
+      }
+      fprintf(stderr, "%s done\n", g_entry_names[entry]);
+   }
+   fprintf(json, "\n  ]\n}\n");
+
+   fclose(json);
+   fclose(stream);
+   close(fd);
+   free(message);
+   return(0);
+}
+
+double xlog_bench_run(xlog_bench_params_t *params, uint32_t threads) {
+   pthread_t         ids[XLOG_BENCH_THREADS_MAX];
+   pthread_barrier_t barrier;
+   struct timespec   begin, end;
+
+   // The threads wait on a barrier so they all contend for the stream at the same time.  None of them can start until
+   // this thread reaches the barrier so the begin time is taken before it.
+   pthread_barrier_init(&barrier, NULL, threads + 1);
+   params->barrier = &barrier;
+
+   for(uint32_t index = 0; index < threads; index++) {
+      pthread_create(&ids[index], NULL, xlog_bench_thread, params);
+   }
+   clock_gettime(CLOCK_MONOTONIC, &begin);
+   pthread_barrier_wait(&barrier);
+   for(uint32_t index = 0; index < threads; index++) {
+      pthread_join(ids[index], NULL);
+   }
+   clock_gettime(CLOCK_MONOTONIC, &end);
+   pthread_barrier_destroy(&barrier);
+
+   // Wall clock time per call for a single thread, or per call per thread when contending
+   return((((end.tv_sec - begin.tv_sec) * 1000000000.0) + (end.tv_nsec - begin.tv_nsec)) / params->iterations);
+}
+
+void *xlog_bench_thread(void *data) {
+   const xlog_bench_params_t *params = (const xlog_bench_params_t *)data;
+   const xlog_args_t *        args   = params->args;
+   char                       buffer[XLOG_STACK_BUF_SIZE];
+
+   pthread_barrier_wait(params->barrier);
+
+   switch(params->entry) {
+      case XLOG_BENCH_ENTRY_PRINTF: {
+         for(uint32_t index = 0; index < params->iterations; index++) {
+            xlog_printf(args, "%s", params->message);
+         }
+         break;
+      }
+      case XLOG_BENCH_ENTRY_FPRINTF: {
+         for(uint32_t index = 0; index < params->iterations; index++) {
+            xlog_fprintf(args, params->stream, "%s", params->message);
+         }
+         break;
+      }
+      case XLOG_BENCH_ENTRY_DPRINTF: {
+         for(uint32_t index = 0; index < params->iterations; index++) {
+            xlog_dprintf(args, params->fd, "%s", params->message);
+         }
+         break;
+      }
+      case XLOG_BENCH_ENTRY_SNPRINTF: {
+         for(uint32_t index = 0; index < params->iterations; index++) {
+            xlog_snprintf(args, buffer, sizeof(buffer), "%s", params->message);
+         }
+         break;
+      }
+      case XLOG_BENCH_ENTRY_PRINTF_SAFE: {
+         for(uint32_t index = 0; index < params->iterations; index++) {
+            xlog_printf_safe(args, params->message);
+         }
+         break;
+      }
+      case XLOG_BENCH_ENTRY_DISABLED: {
+         for(uint32_t index = 0; index < params->iterations; index++) {
+            XLOGD_DEBUG("%s", params->message);
+            __asm__ volatile("" ::: "memory"); // Force the level to be loaded on each iteration as it would be in real code
+         }
+         break;
+      }
+      default: {
+         break;
+      }
+   }
+   return(NULL);
+}
+
+void xlog_bench_result(FILE *json, bool *first, xlog_bench_entry_t entry, int options, uint32_t size, uint32_t threads, uint32_t iterations, double ns) {
+   fprintf(json, "%s    { \"entry\": \"%s\", \"options\": %d, \"size\": %u, \"threads\": %u, \"iterations\": %u, \"ns_per_call\": %.1f }",
+           *first ? "" : ",\n", g_entry_names[entry], options, size, threads, iterations, ns);
+   *first = false;
+}
@@ -0,0 +1,218 @@
+/*
+##########################################################################
+# If not stated otherwise in this file or this component's LICENSE
+# file the following copyright and licenses apply:
+#
+# Copyright 2019 RDK Management
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+##########################################################################
+*/
+// Compares the output of the built-in formatter with vsnprintf for combinations of flags, width, precision, length
+// modifiers and values, then measures the cost per call of both.  Exits with an error if any output differs.
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <limits.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/types.h>
+#ifndef XLOG_MODULE_ID
+#define XLOG_MODULE_ID XLOG_MODULE_ID_XLOG
+#endif
+#include "rdkx_logger.h"
+
+#define XLOG_BENCH_ITERATIONS (1000000)
+
+extern volatile bool g_xlog_format_enable;
+
+int xlog_vformat(char *str, size_t size, const char *format, va_list ap);
+
+static uint32_t g_check_qty    = 0;
+static uint32_t g_mismatch_qty = 0;
+
+static void   xlog_bench_check(const char *format, ...);
+static void   xlog_bench_check_ints(void);
+static void   xlog_bench_check_others(void);
+static void   xlog_bench_spec(char *str, size_t size, const char *flags, const char *width, const char *precision, const char *length, char conversion);
+static double xlog_bench_run(bool enable, uint32_t iterations, const char *format, ...);
+
+static const char *g_flags[]      = { "", "-", "0", "#", "+", " ", "-0", "+0", "-#", "0#", " #", "-+ #0" };
+static const char *g_widths[]     = { "", "1", "5", "20", "*" };
+static const char *g_precisions[] = { "", ".", ".0", ".3", ".25", ".*" };
+static const int   g_star_values[] = { 0, 7, -7 };
+
+int main(int argc, char *argv[]) {
+   uint32_t iterations = (argc > 1) ? strtoul(argv[1], NULL, 0) : XLOG_BENCH_ITERATIONS;
+
+   xlog_bench_check_ints();
+   xlog_bench_check_others();
+
+   printf("format check: %u outputs compared, %u mismatches\n", g_check_qty, g_mismatch_qty);
+   if(g_mismatch_qty > 0) {
+      return(1);
+   }
+
+   #define XLOG_BENCH_RUN(NAME, ...) do {                                          \
+      double libc = xlog_bench_run(false, iterations, __VA_ARGS__);               \
+      double fast = xlog_bench_run(true,  iterations, __VA_ARGS__);               \
+      printf("%-8s vsnprintf: %7.1f ns/call  built-in: %7.1f ns/call\n", NAME, libc, fast); \
+   } while(0)
+
+   XLOG_BENCH_RUN("literal", "Initializing...");
+   XLOG_BENCH_RUN("int",     "device <%d> state <%u> flags <0x%08X>", -42, 7u, 0xBEEFu);
+   XLOG_BENCH_RUN("string",  "session <%s> reason <%s>", "voice", "timeout");
+   XLOG_BENCH_RUN("mixed",   "%s: rssi <%d> lqi <%u> ptr <%p> len <%lld>", "abc", -42, 7u, (void *)&iterations, 123456789LL);
+   XLOG_BENCH_RUN("float",   "voltage <%.2f>", 3.3);
+   #undef XLOG_BENCH_RUN
+   return(0);
+}
+
+void xlog_bench_check(const char *format, ...) {
+   static const size_t sizes[] = { 0, 1, 4, 16, 256 };
+   char expected[256];
+   char actual[256];
+
+   for(uint32_t index = 0; index < sizeof(sizes) / sizeof(sizes[0]); index++) {
+      va_list ap;
+      memset(expected, 0x55, sizeof(expected));
+      memset(actual,   0x55, sizeof(actual));
+
+      va_start(ap, format);
+      int rc_expected = vsnprintf(expected, sizes[index], format, ap);
+      va_end(ap);
+      va_start(ap, format);
+      int rc_actual = xlog_vformat(actual, sizes[index], format, ap);
+      va_end(ap);
+
+      g_check_qty++;
+      if(rc_expected != rc_actual || 0 != memcmp(expected, actual, sizeof(expected))) {
+         if(g_mismatch_qty++ < 20) {
+            printf("mismatch format <%s> size <%zu> vsnprintf <%d> <%.*s> built-in <%d> <%.*s>\n", format, sizes[index],
+                   rc_expected, (int)sizes[index], expected, rc_actual, (int)sizes[index], actual);
+         }
+      }
+   }
+}
+
+void xlog_bench_check_ints(void) {
+   static const long long values[] = { 0, 1, -1, 9, 10, 99, 100, 12345, -12345, 255, 65535, INT_MAX, INT_MIN, UINT_MAX, LLONG_MAX, LLONG_MIN };
+   static const char *lengths[]    = { "", "hh", "h", "l", "ll", "z", "j", "t" };
+   static const char conversions[] = "diuxX";
+   char format[64];
+
+   for(uint32_t f = 0; f < sizeof(g_flags) / sizeof(g_flags[0]); f++) {
+   for(uint32_t w = 0; w < sizeof(g_widths) / sizeof(g_widths[0]); w++) {
+   for(uint32_t p = 0; p < sizeof(g_precisions) / sizeof(g_precisions[0]); p++) {
+   for(uint32_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+   for(uint32_t c = 0; c < sizeof(conversions) - 1; c++) {
+      xlog_bench_spec(format, sizeof(format), g_flags[f], g_widths[w], g_precisions[p], lengths[l], conversions[c]);
+      for(uint32_t v = 0; v < sizeof(values) / sizeof(values[0]); v++) {
+         long long value = values[v];
+         int       ws    = g_star_values[v % 3];
+         int       ps    = g_star_values[(v + 1) % 3];
+         // Pass the argument with the type the length modifier expects (width and precision are passed first if used)
+         #define XLOG_BENCH_CHECK_ARG(TYPE)                                                                          \
+            if(*g_widths[w] == '*' && g_precisions[p][1] == '*') { xlog_bench_check(format, ws, ps, (TYPE)value); } \
+            else if(*g_widths[w] == '*') { xlog_bench_check(format, ws, (TYPE)value); }                            \
+            else if(g_precisions[p][1] == '*') { xlog_bench_check(format, ps, (TYPE)value); }                     \
+            else { xlog_bench_check(format, (TYPE)value); }
+         switch(l) {
+            case 3:  { XLOG_BENCH_CHECK_ARG(long);      break; }
+            case 4:  { XLOG_BENCH_CHECK_ARG(long long); break; }
+            case 5:  { XLOG_BENCH_CHECK_ARG(size_t);    break; }
+            case 6:  { XLOG_BENCH_CHECK_ARG(intmax_t);  break; }
+            case 7:  { XLOG_BENCH_CHECK_ARG(ptrdiff_t); break; }
+            default: { XLOG_BENCH_CHECK_ARG(int);       break; }
+         }
+         #undef XLOG_BENCH_CHECK_ARG
+      }
+   }}}}}
+}
+
+void xlog_bench_check_others(void) {
+   static const char *strings[] = { "", "a", "abcdef", "hello world with spaces", NULL };
+   static const char  chars[]   = { 'a', ' ', '%', '\0' };
+   char format[64];
+
+   for(uint32_t f = 0; f < sizeof(g_flags) / sizeof(g_flags[0]); f++) {
+   for(uint32_t w = 0; w < sizeof(g_widths) / sizeof(g_widths[0]); w++) {
+   for(uint32_t p = 0; p < sizeof(g_precisions) / sizeof(g_precisions[0]); p++) {
+      int ws = g_star_values[(f + p) % 3];
+      int ps = g_star_values[(f + w) % 3];
+      #define XLOG_BENCH_CHECK_ARG(VALUE)                                                                        \
+         if(*g_widths[w] == '*' && g_precisions[p][1] == '*') { xlog_bench_check(format, ws, ps, VALUE); }     \
+         else if(*g_widths[w] == '*') { xlog_bench_check(format, ws, VALUE); }                                \
+         else if(g_precisions[p][1] == '*') { xlog_bench_check(format, ps, VALUE); }                         \
+         else { xlog_bench_check(format, VALUE); }
+
+      xlog_bench_spec(format, sizeof(format), g_flags[f], g_widths[w], g_precisions[p], "", 's');
+      for(uint32_t index = 0; index < sizeof(strings) / sizeof(strings[0]); index++) {
+         XLOG_BENCH_CHECK_ARG(strings[index]);
+      }
+      xlog_bench_spec(format, sizeof(format), g_flags[f], g_widths[w], g_precisions[p], "", 'c');
+      for(uint32_t index = 0; index < sizeof(chars); index++) {
+         XLOG_BENCH_CHECK_ARG(chars[index]);
+      }
+      xlog_bench_spec(format, sizeof(format), g_flags[f], g_widths[w], g_precisions[p], "", 'p');
+      XLOG_BENCH_CHECK_ARG((void *)NULL);
+      XLOG_BENCH_CHECK_ARG((void *)format);
+      XLOG_BENCH_CHECK_ARG((void *)UINTPTR_MAX);
+      #undef XLOG_BENCH_CHECK_ARG
+   }}}
+
+   // Literals, mixed conversions and conversions which are formatted by vsnprintf
+   xlog_bench_check("");
+   xlog_bench_check("Initializing...");
+   xlog_bench_check("100%% done %%");
+   xlog_bench_check("%s: <%d> <%u> <0x%08x> <%p> <%lld> <%c>", "func", -5, 5u, 0xBEEFu, (void *)&g_check_qty, -1LL, 'z');
+   xlog_bench_check("a very long literal which does not fit in the smaller buffers used by the check");
+   xlog_bench_check("%5% %d", 3);
+   xlog_bench_check("%f %e %g", 1.5, 2.5, 3.5);
+   xlog_bench_check("%d %.2f %s", 1, 2.25, "x");
+   xlog_bench_check("%o %#o", 8u, 8u);
+   xlog_bench_check("%ls", L"wide");
+   xlog_bench_check("%2$s %1$s", "a", "b");
+   xlog_bench_check("%'d", 1234567);
+   xlog_bench_check("%Lf", (long double)1.0);
+   errno = ENOENT;
+   xlog_bench_check("error <%m>");
+   xlog_bench_check("trailing %");
+}
+
+void xlog_bench_spec(char *str, size_t size, const char *flags, const char *width, const char *precision, const char *length, char conversion) {
+   snprintf(str, size, "<%%%s%s%s%s%c>", flags, width, precision, length, conversion);
+}
+
+double xlog_bench_run(bool enable, uint32_t iterations, const char *format, ...) {
+   char buffer[256];
+   struct timespec begin, end;
+   bool saved = g_xlog_format_enable;
+
+   g_xlog_format_enable = enable;
+   clock_gettime(CLOCK_MONOTONIC, &begin);
+   for(uint32_t index = 0; index < iterations; index++) {
+      va_list ap;
+      va_start(ap, format);
+      xlog_vformat(buffer, sizeof(buffer), format, ap);
+      va_end(ap);
+   }
+   clock_gettime(CLOCK_MONOTONIC, &end);
+   g_xlog_format_enable = saved;
+
+   return((((end.tv_sec - begin.tv_sec) * 1000000000.0) + (end.tv_nsec - begin.tv_nsec)) / iterations);
+}
@@ -0,0 +1,137 @@
+/*
+##########################################################################
+# If not stated otherwise in this file or this component's LICENSE
+# file the following copyright and licenses apply:
+#
+# Copyright 2019 RDK Management
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+##########################################################################
+*/
+// Measures the time taken by xlog_init when the levels are read from the JSON configuration file and from the binary
+// configuration cache.  Each run is a new process since the library is only initialized once.
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <getopt.h>
+#include <sys/wait.h>
+#ifndef XLOG_MODULE_ID
+#define XLOG_MODULE_ID XLOG_MODULE_ID_XLOG
+#endif
+#include "rdkx_logger.h"
+
+#define XLOG_BENCH_RUNS_MAX (10000)
+
+extern bool g_xlog_config_cache_enable;
+
+static double xlog_bench_init_run(bool cache);
+static int    xlog_bench_compare(const void *a, const void *b);
+static void   xlog_bench_report(const char *label, double *ns, uint32_t runs);
+
+int main(int argc, char *argv[]) {
+   uint32_t runs = 200;
+   int      opt;
+
+   while((opt = getopt(argc, argv, "n:h")) != -1) {
+      switch(opt) {
+         case 'n': { runs = strtoul(optarg, NULL, 0); break; }
+         default: {
+            fprintf(stderr, "Usage: %s [-n RUNS]\n", argv[0]);
+            return((opt == 'h') ? 0 : 1);
+         }
+      }
+   }
+   if(runs == 0 || runs > XLOG_BENCH_RUNS_MAX) {
+      fprintf(stderr, "invalid parameters\n");
+      return(1);
+   }
+   static double json[XLOG_BENCH_RUNS_MAX];
+   static double cache[XLOG_BENCH_RUNS_MAX];
+
+   // The first run with the cache enabled writes the cache if it is missing or out of date
+   if(xlog_bench_init_run(true) < 0.0) {
+      fprintf(stderr, "init failed\n");
+      return(1);
+   }
+   // The runs are interleaved so both paths see the same system state
+   for(uint32_t index = 0; index < runs; index++) {
+      json[index]  = xlog_bench_init_run(false);
+      cache[index] = xlog_bench_init_run(true);
+   }
+   xlog_bench_report("json ", json, runs);
+   xlog_bench_report("cache", cache, runs);
+   return(0);
+}
+
+double xlog_bench_init_run(bool cache) {
+   int fds[2];
+   if(pipe(fds) < 0) {
+      return(-1.0);
+   }
+   pid_t pid = fork();
+   if(pid < 0) {
+      close(fds[0]);
+      close(fds[1]);
+      return(-1.0);
+   }
+   if(pid == 0) {
+      int null = open("/dev/null", O_WRONLY);
+      dup2(null, STDOUT_FILENO);
+      dup2(null, STDERR_FILENO);
+      close(fds[0]);
+
+      // The first record sets up the time zone and the output stream, which is the same for both paths
+      XLOGD_INFO("start");
+
+      struct timespec begin, end;
+      g_xlog_config_cache_enable = cache;
+      clock_gettime(CLOCK_MONOTONIC, &begin);
+      xlog_init(XLOG_MODULE_ID_XLOG, NULL, 0);
+      clock_gettime(CLOCK_MONOTONIC, &end);
+
+      double ns = ((end.tv_sec - begin.tv_sec) * 1000000000.0) + (end.tv_nsec - begin.tv_nsec);
+      if(write(fds[1], &ns, sizeof(ns)) != sizeof(ns)) {
+         _exit(1);
+      }
+      _exit(0);
+   }
+   close(fds[1]);
+   double ns = -1.0;
+   if(read(fds[0], &ns, sizeof(ns)) != sizeof(ns)) {
+      ns = -1.0;
+   }
+   close(fds[0]);
+   waitpid(pid, NULL, 0);
+   return(ns);
+}
+
+int xlog_bench_compare(const void *a, const void *b) {
+   double value_a = *(const double *)a;
+   double value_b = *(const double *)b;
+   return((value_a > value_b) - (value_a < value_b));
+}
+
+void xlog_bench_report(const char *label, double *ns, uint32_t runs) {
+   double total = 0.0;
+   for(uint32_t index = 0; index < runs; index++) {
+      total += ns[index];
+   }
+   qsort(ns, runs, sizeof(ns[0]), xlog_bench_compare);
+   printf("%s: runs <%u> mean <%8.1f us> median <%8.1f us> min <%8.1f us> max <%8.1f us>\n", label, runs, total / runs / 1000.0,
+          ns[runs / 2] / 1000.0, ns[0] / 1000.0, ns[runs - 1] / 1000.0);
+}
@@ -0,0 +1,156 @@
+/*
+##########################################################################
+# If not stated otherwise in this file or this component's LICENSE
+# file the following copyright and licenses apply:
+#
+# Copyright 2019 RDK Management
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+##########################################################################
+*/
+// Measures the cost per line of building the prefix with and without the per call site prefix template cache, and the cost
+// of adding the thread id and name (XLOG_OPTS_TID | XLOG_OPTS_TNAME) or a context tag compared to a memcpy of the same length
+#include <float.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#ifndef XLOG_MODULE_ID
+#define XLOG_MODULE_ID XLOG_MODULE_ID_XLOG
+#endif
+#include "rdkx_logger.h"
+
+#define XLOG_BENCH_ITERATIONS (1000000)
+#define XLOG_BENCH_REPEATS    (7)
+
+extern bool g_xlog_prefix_cache_enable;
+
+static double xlog_bench_run(const xlog_args_t *args, uint32_t iterations);
+static double xlog_bench_field(const xlog_args_t *with, const xlog_args_t *without, const char *context, uint32_t iterations);
+static double xlog_bench_memcpy(size_t len, uint32_t iterations);
+
+int main(int argc, char *argv[]) {
+   uint32_t iterations = (argc > 1) ? strtoul(argv[1], NULL, 0) : XLOG_BENCH_ITERATIONS;
+
+   static const xlog_args_t args = {
+      .options  = XLOG_OPTS_DEFAULT,
+      .color    = XLOG_COLOR_YEL,
+      .function = __FUNCTION__,
+      .line     = __LINE__,
+      .level    = XLOG_LEVEL_WARN,
+      .id       = XLOG_MODULE_ID_XLOG
+   };
+   xlog_level_set_all(XLOG_LEVEL_ALL);
+
+   bool   enable = g_xlog_prefix_cache_enable;
+   g_xlog_prefix_cache_enable = false;
+   double off = xlog_bench_run(&args, iterations);
+   g_xlog_prefix_cache_enable = true;
+   double on  = xlog_bench_run(&args, iterations);
+   g_xlog_prefix_cache_enable = enable;
+
+   printf("prefix cache off: %8.1f ns/line\n", off);
+   printf("prefix cache on:  %8.1f ns/line\n", on);
+   printf("gain:             %8.1f ns/line\n", off - on);
+
+   xlog_args_t args_thread = args;
+   args_thread.options |= XLOG_OPTS_TID | XLOG_OPTS_TNAME;
+   xlog_thread_name_set("xlog-bench");
+
+   char   with[256];
+   char   without[256];
+   int    len_with    = xlog_snprintf(&args_thread, with, sizeof(with), "message");
+   int    len_without = xlog_snprintf(&args, without, sizeof(without), "message");
+   size_t field_len   = (len_with > len_without) ? len_with - len_without : 0;
+
+   double thread = xlog_bench_field(&args_thread, &args, NULL, iterations);
+   double copy   = xlog_bench_memcpy(field_len, iterations);
+
+   printf("thread field:     %8.1f ns/line (%zu bytes)\n", thread, field_len);
+   printf("memcpy:           %8.1f ns/copy (%zu bytes)\n", copy, field_len);
+
+   xlog_context_push("sess=%u", 1234u);
+   len_with  = xlog_snprintf(&args, with, sizeof(with), "message");
+   field_len = (len_with > len_without) ? len_with - len_without : 0;
+   xlog_context_pop();
+
+   double context = xlog_bench_field(&args, &args, "sess=1234", iterations);
+   copy = xlog_bench_memcpy(field_len, iterations);
+
+   printf("context field:    %8.1f ns/line (%zu bytes)\n", context, field_len);
+   printf("memcpy:           %8.1f ns/copy (%zu bytes)\n", copy, field_len);
+   return(0);
+}
+
+double xlog_bench_run(const xlog_args_t *args, uint32_t iterations) {
+   char buffer[256];
+   struct timespec begin, end;
+
+   clock_gettime(CLOCK_MONOTONIC, &begin);
+   for(uint32_t index = 0; index < iterations; index++) {
+      xlog_snprintf(args, buffer, sizeof(buffer), "message");
+   }
+   clock_gettime(CLOCK_MONOTONIC, &end);
+
+   return((((end.tv_sec - begin.tv_sec) * 1000000000.0) + (end.tv_nsec - begin.tv_nsec)) / iterations);
+}
+
+double xlog_bench_field(const xlog_args_t *with, const xlog_args_t *without, const char *context, uint32_t iterations) {
+   // The runs are interleaved and the minimum of each is kept so that a single noisy run doesn't skew the difference.  The
+   // context tag (if any) is only pushed for the runs with the field.
+   double min_with    = DBL_MAX;
+   double min_without = DBL_MAX;
+
+   for(uint32_t repeat = 0; repeat < XLOG_BENCH_REPEATS; repeat++) {
+      double ns = xlog_bench_run(without, iterations);
+      if(ns < min_without) {
+         min_without = ns;
+      }
+      if(context != NULL) {
+         xlog_context_push("%s", context);
+      }
+      ns = xlog_bench_run(with, iterations);
+      if(context != NULL) {
+         xlog_context_pop();
+      }
+      if(ns < min_with) {
+         min_with = ns;
+      }
+   }
+   return(min_with - min_without);
+}
+
+double xlog_bench_memcpy(size_t len, uint32_t iterations) {
+   static char     src[64] = "[12345:xlog-bench] ";
+   static char     dst[64];
+   struct timespec begin, end;
+   double          min = DBL_MAX;
+
+   for(uint32_t repeat = 0; repeat < XLOG_BENCH_REPEATS; repeat++) {
+      clock_gettime(CLOCK_MONOTONIC, &begin);
+      for(uint32_t index = 0; index < iterations; index++) {
+         // Tell the compiler the buffers are read and changed so the copy is not removed from or hoisted out of the loop
+         __asm__ volatile("" : : "r"(src), "r"(dst) : "memory");
+         memcpy(dst, src, len);
+      }
+      clock_gettime(CLOCK_MONOTONIC, &end);
+
+      double ns = (((end.tv_sec - begin.tv_sec) * 1000000000.0) + (end.tv_nsec - begin.tv_nsec)) / iterations;
+      if(ns < min) {
+         min = ns;
+      }
+   }
+   return(min);
+}
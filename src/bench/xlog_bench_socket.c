@@ -0,0 +1,116 @@
+/*
+##########################################################################
+# If not stated otherwise in this file or this component's LICENSE
+# file the following copyright and licenses apply:
+#
+# Copyright 2019 RDK Management
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+##########################################################################
+*/
+// Writes records to a XLOG_SINK_TYPE_SOCKET sink as fast as possible and reports the cost per record for the caller.
+// Run xlog-collector on the same socket to measure the records per second received.
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <time.h>
+#include <getopt.h>
+#include <pthread.h>
+#ifndef XLOG_MODULE_ID
+#define XLOG_MODULE_ID XLOG_MODULE_ID_XLOG
+#endif
+#include "rdkx_logger.h"
+
+#define XLOG_BENCH_THREADS_MAX (64)
+
+typedef struct {
+   uint32_t records;
+} xlog_bench_params_t;
+
+static void *xlog_bench_thread(void *data);
+
+int main(int argc, char *argv[]) {
+   uint32_t records  = 1000000;
+   uint32_t threads  = 1;
+   uint32_t batch    = 0;
+   bool     datagram = false;
+   int      opt;
+
+   while((opt = getopt(argc, argv, "n:t:b:dh")) != -1) {
+      switch(opt) {
+         case 'n': { records  = strtoul(optarg, NULL, 0); break; }
+         case 't': { threads  = strtoul(optarg, NULL, 0); break; }
+         case 'b': { batch    = strtoul(optarg, NULL, 0); break; }
+         case 'd': { datagram = true;                     break; }
+         default: {
+            fprintf(stderr, "Usage: %s [-n RECORDS] [-t THREADS] [-b BATCH_SIZE] [-d] SOCKET\n", argv[0]);
+            return((opt == 'h') ? 0 : 1);
+         }
+      }
+   }
+   if(optind >= argc || threads == 0 || threads > XLOG_BENCH_THREADS_MAX) {
+      fprintf(stderr, "invalid parameters\n");
+      return(1);
+   }
+
+   xlog_init(XLOG_MODULE_ID_XLOG, NULL, 0);
+   xlog_level_set_all(XLOG_LEVEL_ALL);
+
+   // The buffer is large enough to absorb the bursts so records are only dropped if the collector falls behind
+   xlog_sink_params_t params = {
+      .type          = XLOG_SINK_TYPE_SOCKET,
+      .filename      = argv[optind],
+      .id            = XLOG_MODULE_ID_INVALID,
+      .options_clear = XLOG_OPTS_COLOR,
+      .datagram      = datagram,
+      .batch_size    = batch,
+      .buffer_size   = 4 * 1024 * 1024
+   };
+   if(xlog_sink_add(&params) < 0) {
+      return(1);
+   }
+   sleep(1); // Let the sender connect
+
+   pthread_t           ids[XLOG_BENCH_THREADS_MAX];
+   xlog_bench_params_t bench = { .records = records / threads };
+   struct timespec     begin, end;
+
+   clock_gettime(CLOCK_MONOTONIC, &begin);
+   for(uint32_t index = 0; index < threads; index++) {
+      pthread_create(&ids[index], NULL, xlog_bench_thread, &bench);
+   }
+   for(uint32_t index = 0; index < threads; index++) {
+      pthread_join(ids[index], NULL);
+   }
+   clock_gettime(CLOCK_MONOTONIC, &end);
+
+   xlog_stats_t stats;
+   xlog_stats_get(XLOG_MODULE_ID_XLOG, &stats);
+   double ns = ((end.tv_sec - begin.tv_sec) * 1000000000.0) + (end.tv_nsec - begin.tv_nsec);
+   fprintf(stderr, "records <%u> threads <%u> ns per record <%.1f> records per second <%.0f> dropped <%llu>\n", bench.records * threads, threads,
+           ns / bench.records, (bench.records * threads) / (ns / 1000000000.0), (unsigned long long)stats.errors);
+
+   xlog_term(); // Sends the remaining records
+   return(0);
+}
+
+void *xlog_bench_thread(void *data) {
+   const xlog_bench_params_t *params = (const xlog_bench_params_t *)data;
+   for(uint32_t index = 0; index < params->records; index++) {
+      XLOGD_INFO("record <%u> state <%s> value <%d>", index, "ACTIVE", -42);
+   }
+   return(NULL);
+}
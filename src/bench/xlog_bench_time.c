@@ -0,0 +1,114 @@
+/*
+##########################################################################
+# If not stated otherwise in this file or this component's LICENSE
+# file the following copyright and licenses apply:
+#
+# Copyright 2019 RDK Management
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+##########################################################################
+*/
+// Measures the cost per line of the time options compared to the default date and time (gettimeofday with the cached
+// date string) and to formatting the date and time with gettimeofday, localtime_r and strftime for every line
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+#ifndef XLOG_MODULE_ID
+#define XLOG_MODULE_ID XLOG_MODULE_ID_XLOG
+#endif
+#include "rdkx_logger.h"
+
+#define XLOG_BENCH_ITERATIONS (1000000)
+
+typedef struct {
+   const char *label;
+   uint32_t    options;
+} xlog_bench_case_t;
+
+static const xlog_bench_case_t g_xlog_bench_cases[] = {
+   { "default (msec)",      0                                          },
+   { "usec",                XLOG_OPTS_USEC                             },
+   { "nsec",                XLOG_OPTS_NSEC                             },
+   { "coarse",              XLOG_OPTS_COARSE                           },
+   { "mono (msec)",         XLOG_OPTS_MONO                             },
+   { "mono usec",           XLOG_OPTS_MONO | XLOG_OPTS_USEC            },
+   { "mono nsec",           XLOG_OPTS_MONO | XLOG_OPTS_NSEC            },
+   { "mono coarse",         XLOG_OPTS_MONO | XLOG_OPTS_COARSE          },
+   { "mono start",          XLOG_OPTS_MONO | XLOG_OPTS_MONO_START      },
+};
+
+static volatile char g_xlog_bench_sink; // Keeps the strftime result from being optimized away
+
+static double xlog_bench_run(const xlog_args_t *args, uint32_t iterations);
+static double xlog_bench_strftime(uint32_t iterations);
+
+int main(int argc, char *argv[]) {
+   uint32_t iterations = (argc > 1) ? strtoul(argv[1], NULL, 0) : XLOG_BENCH_ITERATIONS;
+
+   xlog_args_t args = {
+      .options  = XLOG_OPTS_DEFAULT,
+      .color    = XLOG_COLOR_NONE,
+      .function = __FUNCTION__,
+      .line     = XLOG_LINE_NONE,
+      .level    = XLOG_LEVEL_INFO,
+      .id       = XLOG_MODULE_ID_XLOG
+   };
+   xlog_level_set_all(XLOG_LEVEL_ALL);
+
+   printf("%-20s %8.1f ns/line\n", "strftime", xlog_bench_strftime(iterations));
+   for(uint32_t index = 0; index < sizeof(g_xlog_bench_cases) / sizeof(g_xlog_bench_cases[0]); index++) {
+      char buffer[256];
+      args.options = XLOG_OPTS_DEFAULT | g_xlog_bench_cases[index].options;
+      xlog_snprintf(&args, buffer, sizeof(buffer), "message");
+      double ns = xlog_bench_run(&args, iterations);
+      printf("%-20s %8.1f ns/line  %s", g_xlog_bench_cases[index].label, ns, buffer);
+   }
+   return(0);
+}
+
+double xlog_bench_run(const xlog_args_t *args, uint32_t iterations) {
+   char buffer[256];
+   struct timespec begin, end;
+
+   clock_gettime(CLOCK_MONOTONIC, &begin);
+   for(uint32_t index = 0; index < iterations; index++) {
+      xlog_snprintf(args, buffer, sizeof(buffer), "message");
+   }
+   clock_gettime(CLOCK_MONOTONIC, &end);
+
+   return((((end.tv_sec - begin.tv_sec) * 1000000000.0) + (end.tv_nsec - begin.tv_nsec)) / iterations);
+}
+
+double xlog_bench_strftime(uint32_t iterations) {
+   // Reference for the date and time alone, formatted the usual way without any caching
+   char            buffer[64];
+   struct timespec begin, end;
+
+   clock_gettime(CLOCK_MONOTONIC, &begin);
+   for(uint32_t index = 0; index < iterations; index++) {
+      struct timeval tv;
+      struct tm      tm_val;
+      gettimeofday(&tv, NULL);
+      localtime_r(&tv.tv_sec, &tm_val);
+      size_t len = strftime(buffer, sizeof(buffer), "%Y%m%d %H:%M:%S", &tm_val);
+      snprintf(&buffer[len], sizeof(buffer) - len, ":%03u", (uint32_t)(tv.tv_usec / 1000));
+      g_xlog_bench_sink = buffer[len + 3];
+   }
+   clock_gettime(CLOCK_MONOTONIC, &end);
+
+   return((((end.tv_sec - begin.tv_sec) * 1000000000.0) + (end.tv_nsec - begin.tv_nsec)) / iterations);
+}
@@ -0,0 +1,201 @@
+/*
+##########################################################################
+# If not stated otherwise in this file or this component's LICENSE
+# file the following copyright and licenses apply:
+#
+# Copyright 2019 RDK Management
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+##########################################################################
+*/
+// Stand-in for a log collector.  Receives the messages sent by XLOG_SINK_TYPE_SOCKET sinks, optionally writes the records
+// to a file and reports the quantity of records (lines), messages and bytes received per second.
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <errno.h>
+#include <getopt.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define XLOG_COLLECTOR_CLIENT_QTY_MAX (32)
+#define XLOG_COLLECTOR_MESSAGE_SIZE   (64 * 1024)
+
+typedef struct {
+   uint64_t records;
+   uint64_t messages;
+   uint64_t bytes;
+} xlog_collector_counts_t;
+
+static double xlog_collector_time(void);
+static void   xlog_collector_report(const char *label, const xlog_collector_counts_t *counts, double seconds);
+
+int main(int argc, char *argv[]) {
+   const char *output   = NULL;
+   bool        datagram = false;
+   uint64_t    limit    = 0;
+   uint32_t    idle     = 0;
+   int         opt;
+
+   while((opt = getopt(argc, argv, "do:n:t:h")) != -1) {
+      switch(opt) {
+         case 'd': { datagram = true;                         break; }
+         case 'o': { output   = optarg;                       break; }
+         case 'n': { limit    = strtoull(optarg, NULL, 0);    break; }
+         case 't': { idle     = strtoul(optarg, NULL, 0);     break; }
+         default: {
+            fprintf(stderr, "Usage: %s [-d] [-o FILE] [-n RECORDS] [-t SECONDS] SOCKET\n", argv[0]);
+            fprintf(stderr, "  -d          use SOCK_DGRAM instead of SOCK_SEQPACKET\n");
+            fprintf(stderr, "  -o FILE     write the records to FILE (- for stdout)\n");
+            fprintf(stderr, "  -n RECORDS  exit after receiving RECORDS records\n");
+            fprintf(stderr, "  -t SECONDS  exit when nothing is received for SECONDS (ie. records were dropped)\n");
+            return((opt == 'h') ? 0 : 1);
+         }
+      }
+   }
+   if(optind >= argc) {
+      fprintf(stderr, "missing socket path\n");
+      return(1);
+   }
+   const char *       path = argv[optind];
+   struct sockaddr_un addr;
+   if(strlen(path) >= sizeof(addr.sun_path)) {
+      fprintf(stderr, "socket path is too long\n");
+      return(1);
+   }
+   int out = -1;
+   if(output != NULL) {
+      out = (strcmp(output, "-") == 0) ? STDOUT_FILENO : open(output, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+      if(out < 0) {
+         int errsv = errno;
+         fprintf(stderr, "unable to open <%s> <%s>\n", output, strerror(errsv));
+         return(1);
+      }
+   }
+
+   memset(&addr, 0, sizeof(addr));
+   addr.sun_family = AF_UNIX;
+   strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+   unlink(path);
+
+   int listener = socket(AF_UNIX, datagram ? SOCK_DGRAM : SOCK_SEQPACKET, 0);
+   if(listener < 0 || bind(listener, (struct sockaddr *)&addr, sizeof(addr)) < 0 || (!datagram && listen(listener, 8) < 0)) {
+      int errsv = errno;
+      fprintf(stderr, "unable to listen on <%s> <%s>\n", path, strerror(errsv));
+      return(1);
+   }
+
+   // Entry 0 is the listening socket for SOCK_SEQPACKET or the only socket for SOCK_DGRAM
+   struct pollfd           fds[XLOG_COLLECTOR_CLIENT_QTY_MAX + 1];
+   nfds_t                  fd_qty = 1;
+   static char             message[XLOG_COLLECTOR_MESSAGE_SIZE];
+   xlog_collector_counts_t total  = { 0 };
+   xlog_collector_counts_t period = { 0 };
+   double                  begin  = 0.0;
+   double                  last   = xlog_collector_time();
+   double                  active = last; // Time of the last message or connection
+
+   fds[0].fd     = listener;
+   fds[0].events = POLLIN;
+
+   while(limit == 0 || total.records < limit) {
+      int rc = poll(fds, fd_qty, 1000);
+      if(rc < 0 && errno != EINTR) {
+         break;
+      }
+      for(nfds_t index = 0; index < fd_qty && rc > 0; index++) {
+         if(fds[index].revents == 0) {
+            continue;
+         }
+         if(index == 0 && !datagram) {
+            int client = accept(listener, NULL, NULL);
+            active = xlog_collector_time();
+            if(client >= 0 && fd_qty <= XLOG_COLLECTOR_CLIENT_QTY_MAX) {
+               fds[fd_qty].fd     = client;
+               fds[fd_qty].events = POLLIN;
+               fd_qty++;
+            } else if(client >= 0) {
+               close(client);
+            }
+            continue;
+         }
+         ssize_t len = recv(fds[index].fd, message, sizeof(message), 0);
+         if(len <= 0) { // Client disconnected
+            close(fds[index].fd);
+            fds[index] = fds[--fd_qty];
+            index--;
+            continue;
+         }
+         active = xlog_collector_time();
+         if(begin == 0.0) {
+            begin = active;
+         }
+         for(ssize_t pos = 0; pos < len; pos++) {
+            period.records += (message[pos] == '\n');
+         }
+         period.messages++;
+         period.bytes += len;
+         if(out >= 0 && write(out, message, len) != len) {
+            fprintf(stderr, "write failed\n");
+         }
+      }
+
+      double now = xlog_collector_time();
+      if(now - last >= 1.0) {
+         xlog_collector_report("period", &period, now - last);
+         total.records  += period.records;
+         total.messages += period.messages;
+         total.bytes    += period.bytes;
+         memset(&period, 0, sizeof(period));
+         last = now;
+      }
+      if(idle > 0 && now - active >= idle) {
+         fprintf(stderr, "nothing received for <%u> seconds\n", idle);
+         break;
+      }
+   }
+   total.records  += period.records;
+   total.messages += period.messages;
+   total.bytes    += period.bytes;
+   xlog_collector_report("total", &total, active - begin); // Up to the last message so an idle timeout is not counted
+
+   for(nfds_t index = 0; index < fd_qty; index++) {
+      close(fds[index].fd);
+   }
+   unlink(path);
+   if(out > STDOUT_FILENO) {
+      close(out);
+   }
+   return((limit != 0 && total.records < limit) ? 1 : 0);
+}
+
+double xlog_collector_time(void) {
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return(ts.tv_sec + (ts.tv_nsec / 1000000000.0));
+}
+
+void xlog_collector_report(const char *label, const xlog_collector_counts_t *counts, double seconds) {
+   if(seconds <= 0.0) {
+      seconds = 1.0;
+   }
+   fprintf(stderr, "%s: records <%llu> <%.0f/s> messages <%llu> <%.0f/s> bytes <%llu> records per message <%.1f>\n", label,
+           (unsigned long long)counts->records, counts->records / seconds, (unsigned long long)counts->messages, counts->messages / seconds,
+           (unsigned long long)counts->bytes, (counts->messages == 0) ? 0.0 : (double)counts->records / counts->messages);
+}
@@ -30,7 +30,10 @@
 #include <sys/time.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
 #include <fcntl.h>
+#include <pthread.h>
 #include "jansson.h"
 #ifdef RDK_PLATFORM
 #include "rdkversion.h"
@@ -42,31 +45,84 @@
 #include "curtail.h"
 #endif
 
-// This value indicates the maximum print size and also the size of local stack variable
-#ifndef XLOG_STACK_BUF_SIZE
-#define XLOG_STACK_BUF_SIZE (4096)
+#define XLOG_PREFIX_SIZE (30)
+
+// Space kept after the function name for the line number, level and separator
+#define XLOG_PREFIX_TAIL_SIZE (32)
+
+// Quantity of per thread prefix cache slots (must be a power of 2, 0 to disable the cache).  Each thread which logs with the
+// cache enabled allocates a table of XLOG_PREFIX_CACHE_QTY pointers, and each entry (about 180 bytes) is only allocated the
+// first time a call site hashes to its slot.  Call sites which share a slot replace each other's template.
+#ifndef XLOG_PREFIX_CACHE_QTY
+#define XLOG_PREFIX_CACHE_QTY (64)
+#endif
+
+// Maximum size of a cached prefix template (longer prefixes are built for every call)
+#define XLOG_PREFIX_CACHE_STR_SIZE (128)
+
+// Records between checks of the thread name for XLOG_OPTS_TNAME
+#ifndef XLOG_THREAD_CHECK_RECORDS
+#define XLOG_THREAD_CHECK_RECORDS (256)
+#endif
+
+// Size of the thread field ("[" + 10 digits + ":" + 15 characters + "] ")
+#define XLOG_THREAD_FIELD_SIZE (32)
+
+// Largest body kept in the per thread body buffer.  Longer bodies are formatted into a buffer which is freed after the write.
+#ifndef XLOG_BODY_KEEP_SIZE_MAX
+#define XLOG_BODY_KEEP_SIZE_MAX (64 * 1024)
 #endif
 
-#define XLOG_PREFIX_SIZE (22)
+// Size of the context field (" [" + tags separated by spaces + "]") and the quantity of tags which can be pushed
+#define XLOG_CONTEXT_SIZE      (64)
+#define XLOG_CONTEXT_DEPTH_MAX (8)
 
-#ifndef XLOG_CONFIG_FILE_DIR_NAME_PRD
-#define XLOG_CONFIG_FILE_DIR_NAME_PRD "/etc"
+// Period in seconds at which the local time UTC offset is refreshed (picks up time zone and daylight saving changes)
+#define XLOG_TIME_OFFSET_PERIOD (60)
+
+// Period in seconds at which a time anchor record is written before the records with XLOG_OPTS_MONO
+#ifndef XLOG_TIME_ANCHOR_PERIOD
+#define XLOG_TIME_ANCHOR_PERIOD (60)
 #endif
 
-#ifndef XLOG_CONFIG_FILE_DIR_NAME_DEV
-#define XLOG_CONFIG_FILE_DIR_NAME_DEV "/opt"
+#ifdef CLOCK_MONOTONIC_COARSE
+#define XLOG_CLOCK_MONOTONIC_COARSE CLOCK_MONOTONIC_COARSE
+#define XLOG_CLOCK_REALTIME_COARSE  CLOCK_REALTIME_COARSE
+#else
+#define XLOG_CLOCK_MONOTONIC_COARSE CLOCK_MONOTONIC
+#define XLOG_CLOCK_REALTIME_COARSE  CLOCK_REALTIME
 #endif
 
-#define XLOG_CONFIG_FILE_PRD      XLOG_CONFIG_FILE_DIR_NAME_PRD "/rdkx_logger.json"
-#define XLOG_CONFIG_FILE_PRD_ROOT XLOG_CONFIG_FILE_DIR_NAME_PRD "/rdkx_logger_"
-#define XLOG_CONFIG_FILE_DEV      XLOG_CONFIG_FILE_DIR_NAME_DEV "/rdkx_logger.json"
-#define XLOG_CONFIG_FILE_DEV_ROOT XLOG_CONFIG_FILE_DIR_NAME_DEV "/rdkx_logger_"
+#define XLOG_CONFIG_FILE_PRD      XLOG_CONFIG_FILE_DIR_NAME_PRD "/" XLOG_CONFIG_FILE_NAME
+#define XLOG_CONFIG_FILE_PRD_ROOT XLOG_CONFIG_FILE_DIR_NAME_PRD "/" XLOG_CONFIG_FILE_NAME_ROOT
+#define XLOG_CONFIG_FILE_DEV      XLOG_CONFIG_FILE_DIR_NAME_DEV "/" XLOG_CONFIG_FILE_NAME
+#define XLOG_CONFIG_FILE_DEV_ROOT XLOG_CONFIG_FILE_DIR_NAME_DEV "/" XLOG_CONFIG_FILE_NAME_ROOT
+
+xlog_level_t  g_xlog_modules[XLOG_MODULE_SLOT_QTY];
+
+// Level at which each module's records are printed.  g_xlog_modules is the level at which the XLOG macros call the library,
+// which is lower than the print level when the flight recorder captures records which are not printed.
+static xlog_level_t g_xlog_print_levels[XLOG_MODULE_SLOT_QTY];
 
-xlog_level_t  g_xlog_modules[XLOG_MODULE_QTY_MAX];
+// Levels read from the configuration file.  Used to determine which modules were changed when the file is reloaded.
+static xlog_level_t     g_xlog_config_levels[XLOG_MODULE_SLOT_QTY];
+static xlog_module_id_t g_xlog_config_id = XLOG_MODULE_ID_INVALID;
+
+// Names of the registered modules.  An entry is written before the quantity is published and is not changed afterwards so
+// the names are read without a lock.  The mutex serializes registration with the configuration updates.
+static char            g_xlog_module_dynamic_names[XLOG_MODULE_DYNAMIC_QTY_MAX][XLOG_MODULE_NAME_SIZE_MAX];
+static uint32_t        g_xlog_module_dynamic_strlen[XLOG_MODULE_DYNAMIC_QTY_MAX];
+static uint32_t        g_xlog_module_dynamic_qty = 0;
+static pthread_mutex_t g_xlog_module_mutex       = PTHREAD_MUTEX_INITIALIZER;
+
+// Production flag used to select the configuration file (-1 until read).  Taken from the configuration cache if present.
+static int g_xlog_config_production = -1;
 
 static bool          g_xlog_init       = false;
 static xlog_print_t  g_xlog_print      = NULL;
 static xlog_print_t  g_xlog_print_safe = NULL;
+static xlog_printv_t g_xlog_printv      = NULL;
+static xlog_printv_t g_xlog_printv_safe = NULL;
 
 #ifdef USE_CURTAIL
 static bool g_crtl_init = false;
@@ -81,12 +137,102 @@ static const xlog_args_t g_xlog_args_default = {
    .id        = XLOG_MODULE_ID_XLOG
 };
 
-extern const char * const g_xlog_module_id_to_str[];
+// Formatted "YYYYMMDD HH:MM:SS" string for the current second, cached per thread for local time [0] and GMT [1]
+typedef struct {
+   bool   valid;
+   time_t second;
+   char   str[18];
+} xlog_time_cache_t;
+
+static __thread xlog_time_cache_t g_xlog_time_cache[2];
 
-static int      xlog_init_int(xlog_module_id_t id, const char *filename, uint32_t file_size_max, xlog_print_t print, xlog_print_t print_safe);
-static uint32_t xlog_date_time(const xlog_args_t *args, char *buffer);
-static int      xlog_prefix(const xlog_args_t *args, char *str, size_t size);
+// UTC offset for local time packed as (period index << 32 | offset in seconds) so it can be read atomically
+static uint64_t g_xlog_time_offset = 0;
+
+// Monotonic time in nanoseconds when the library was loaded (XLOG_OPTS_MONO_START) and when the next time anchor is due
+static uint64_t g_xlog_time_start       = 0;
+static uint64_t g_xlog_time_anchor_next = 0;
+
+// Constant part of the prefix for a call site, which is everything except the date and time
+typedef struct {
+   xlog_args_t args;      // Call site which the template was built for
+   uint16_t    color_len; // Length of the template before the date and time
+   uint16_t    len;       // Total length of the template
+   char        str[XLOG_PREFIX_CACHE_STR_SIZE];
+} xlog_prefix_cache_t;
+
+#if XLOG_PREFIX_CACHE_QTY > 0
+bool g_xlog_prefix_cache_enable = true;
+#else
+bool g_xlog_prefix_cache_enable = false;
+#endif
+
+static __thread xlog_prefix_cache_t **g_xlog_prefix_cache = NULL; // Table of XLOG_PREFIX_CACHE_QTY entries
+static pthread_key_t                  g_xlog_prefix_cache_key;
+static pthread_once_t                 g_xlog_prefix_cache_once = PTHREAD_ONCE_INIT;
+
+// Bodies which don't fit in the stack buffer are formatted into a buffer kept by the thread.  Once the buffer has grown, the
+// thread's later records are formatted directly into it so a long record is formatted once without allocating memory.
+typedef struct {
+   char * str;
+   size_t size;
+   bool   busy; // Holds the record being written.  Records written meanwhile by the library (ie. reports) use the stack.
+} xlog_body_buf_t;
+
+static __thread xlog_body_buf_t g_xlog_body_buf;
+static pthread_key_t            g_xlog_body_buf_key;
+static pthread_once_t           g_xlog_body_buf_once = PTHREAD_ONCE_INIT;
+
+// Thread id and name rendered for the XLOG_OPTS_TID and XLOG_OPTS_TNAME options.  The field is also part of the thread's
+// prefix templates so the templates are dropped when the field changes.
+typedef struct {
+   bool     valid;
+   uint32_t records;                                // Records since the name was read
+   char     name[16];
+   uint8_t  field_len[3];                           // TID, TNAME, both
+   char     field[3][XLOG_THREAD_FIELD_SIZE];
+} xlog_thread_cache_t;
+
+static __thread xlog_thread_cache_t g_xlog_thread_cache;
+static pthread_once_t               g_xlog_thread_once = PTHREAD_ONCE_INIT;
+
+// Context tags pushed by the thread, rendered once as the field which is inserted before the separator of each prefix.  The
+// field is not part of the prefix templates so pushing a tag does not drop them.
+typedef struct {
+   uint32_t len;                           // Length of the field (0 when no tag is set)
+   uint32_t depth;                         // Quantity of tags pushed
+   uint32_t marks[XLOG_CONTEXT_DEPTH_MAX]; // Length of the field before each tag was pushed
+   char     field[XLOG_CONTEXT_SIZE];
+} xlog_context_t;
+
+static __thread xlog_context_t g_xlog_context;
+
+extern const char * const g_xlog_module_id_to_str[];
+extern unsigned long      g_xlog_module_id_to_strlen[];
+
+static int      xlog_init_int(xlog_module_id_t id, const char *filename, uint32_t file_size_max, xlog_print_t print, xlog_print_t print_safe, const xlog_async_params_t *async);
+static uint32_t xlog_date_time(const xlog_args_t *args, const struct timeval *tv, char *buffer);
+static void     xlog_time_cache_update(xlog_time_cache_t *cache, time_t second, bool gmt);
+static int32_t  xlog_time_offset_get(time_t second);
+static void     xlog_time_get(uint32_t options, struct timespec *ts);
+static uint32_t xlog_time_mono(const struct timespec *ts, uint32_t digits, char *buffer);
+static uint32_t xlog_time_fraction(uint32_t nsec, uint32_t digits, char separator, char *buffer);
+static bool     xlog_time_anchor_due(void);
+static void     xlog_time_anchor(const xlog_args_t *args, FILE *stream, int fd);
+static void     xlog_time_start_set(void) __attribute__((constructor));
+static int      xlog_prefix(const xlog_args_t *args, const struct timeval *tv, char *str, size_t size);
+static int      xlog_prefix_build(const xlog_args_t *args, const struct timeval *tv, char *str, size_t size, const xlog_context_t *context, bool safe, bool *complete);
+static xlog_prefix_cache_t *xlog_prefix_cache_get(const xlog_args_t *args);
+static void     xlog_prefix_cache_key_create(void);
+static void     xlog_prefix_cache_clear(void);
+static void     xlog_prefix_cache_release(void *data);
+static void     xlog_thread_check(void);
+static void     xlog_thread_refresh(void);
+static uint32_t xlog_thread_field_safe(uint32_t thread, char *str);
+static void     xlog_thread_atfork(void);
+static void     xlog_thread_fork_child(void);
 static int      xlog_postfix(const xlog_args_t *args, char *str, size_t size);
+static int      xlog_output_join(xlog_print_t print, xlog_level_t level, const struct iovec *iov, int iovcnt, bool safe) __attribute__((noinline));
 
 #define MACRO_LEVEL_CHECK
 #ifndef MACRO_LEVEL_CHECK
@@ -95,28 +241,53 @@ static __inline bool xlog_level_enabled(xlog_module_id_t id, xlog_level_t level)
 
 static __inline int     xlog_vfprintf_dvi(const xlog_args_t *args, FILE *stream, const char *format, va_list ap);
 static __inline int     xlog_vdprintf_dvi(const xlog_args_t *args, int fd, const char *format, va_list ap);
+static int              xlog_vwrite_dvi(const xlog_args_t *args, FILE *stream, int fd, const char *format, va_list ap);
+static int              xlog_write_iov(const xlog_args_t *args, FILE *stream, int fd, struct iovec *iov);
+static char *           xlog_body_buf_grow(size_t size);
+static void             xlog_body_buf_key_create(void);
 static __inline int     xlog_vsnprintf_dvi(const xlog_args_t *args, char *str, size_t size, const char *format, va_list ap);
+static __inline int     xlog_binary(const xlog_args_t *args, const char *format, va_list ap);
+static void             xlog_args_skipped(const xlog_args_t *args);
+static int              xlog_emitv_kv(const xlog_args_t *args, FILE *stream, int fd, const struct iovec *iov, int iovcnt, const xlog_kv_record_t *kv);
+static int              xlog_kv_encode(const xlog_args_t *args, xlog_kv_format_t format, char *buffer, size_t size, const char *event, const xlog_kv_t *kvs, uint32_t kv_qty, struct iovec *iov, bool *truncated);
 
 static xlog_level_t     xlog_level_str_to_enum(const char *level);
-static xlog_module_id_t xlog_module_to_id(const char *module);
-static json_t *         xlog_config_load(xlog_module_id_t id);
-static bool             xlog_file_get_contents(const char *file, char **contents);
+static json_t *         xlog_config_load(xlog_module_id_t id, char *file, size_t size, struct stat *source);
+static void             xlog_config_levels_get(json_t *obj, xlog_level_t *levels, bool verbose);
+static bool             xlog_file_get_contents(const char *file, char **contents, struct stat *st);
 
 #ifndef XLOG_PREFIX_SIZE
 #error XLOG_PREFIX_SIZE is not defined
-#elif XLOG_PREFIX_SIZE < 22
+#elif XLOG_PREFIX_SIZE < 30
 #error XLOG_PREFIX_SIZE is too small
 #endif
 
 int xlog_init(xlog_module_id_t id, const char *filename, uint32_t file_size_max) {
-   return(xlog_init_int(id, filename, file_size_max, NULL, NULL));
+   return(xlog_init_int(id, filename, file_size_max, NULL, NULL, NULL));
 }
 
 int xlog_init_user_print(xlog_module_id_t id, xlog_print_t print, xlog_print_t print_safe) {
-   return(xlog_init_int(id, NULL, 0, print, print_safe));
+   return(xlog_init_int(id, NULL, 0, print, print_safe, NULL));
+}
+
+int xlog_init_user_printv(xlog_module_id_t id, xlog_printv_t printv, xlog_printv_t printv_safe) {
+   int rc = xlog_init_int(id, NULL, 0, NULL, NULL, NULL);
+   if(rc == 0) {
+      g_xlog_printv_safe = printv_safe;
+      g_xlog_printv      = printv;
+   }
+   return(rc);
+}
+
+int xlog_init_async(xlog_module_id_t id, const char *filename, uint32_t file_size_max, const xlog_async_params_t *params) {
+   if(params == NULL) {
+      XLOGD_ERROR("invalid params");
+      return(-1);
+   }
+   return(xlog_init_int(id, filename, file_size_max, NULL, NULL, params));
 }
 
-int xlog_init_int(xlog_module_id_t id, const char *filename, uint32_t file_size_max, xlog_print_t print, xlog_print_t print_safe) {
+int xlog_init_int(xlog_module_id_t id, const char *filename, uint32_t file_size_max, xlog_print_t print, xlog_print_t print_safe, const xlog_async_params_t *async) {
    if(g_xlog_init) {
       XLOGD_WARN("Already initialized");
       return(-1);
@@ -140,20 +311,52 @@ int xlog_init_int(xlog_module_id_t id, const char *filename, uint32_t file_size_
    g_xlog_print_safe = print_safe;
    g_xlog_print      = print;
 
-   // First, initialize to INFO level
-   for(uint32_t index = 0; index < XLOG_MODULE_QTY_MAX; index++) {
-      g_xlog_modules[index] = XLOG_LEVEL_INFO;
+   // First, initialize to INFO level.  Modules registered before initialization are included.
+   pthread_mutex_lock(&g_xlog_module_mutex);
+   for(uint32_t index = 0; index < XLOG_MODULE_SLOT_QTY; index++) {
+      if(xlog_module_valid(index)) {
+         xlog_level_update(index, XLOG_LEVEL_INFO);
+         g_xlog_config_levels[index] = XLOG_LEVEL_INFO;
+      }
    }
+   g_xlog_config_id = id;
+   pthread_mutex_unlock(&g_xlog_module_mutex);
 
-   // Load module name and level from config file
-   json_t *obj = xlog_config_load(id);
+   if(async != NULL && xlog_async_init(async) < 0) {
+      XLOGD_WARN("unable to start async mode. using synchronous output.");
+   }
 
-   if(obj == NULL) {
-      return(0);
+   // Load module name and level from config file.  The JSON file is only read and parsed when the cache is out of date.
+   pthread_mutex_lock(&g_xlog_module_mutex);
+   char file[128] = { '\0' };
+   if(xlog_config_cache_load(id, g_xlog_config_levels, file, sizeof(file), &g_xlog_config_production)) {
+      XLOGD_INFO("Read configuration from <%s> (cached)", file);
+   } else {
+      struct stat source;
+      json_t *obj = xlog_config_load(id, file, sizeof(file), &source);
+
+      if(obj != NULL) {
+         XLOGD_INFO("Read configuration from <%s>", file);
+
+         xlog_config_levels_get(obj, g_xlog_config_levels, true);
+         xlog_config_cache_store(id, file, &source, obj, g_xlog_config_production);
+         json_decref(obj);
+      }
+   }
+   for(uint32_t index = 0; index < XLOG_MODULE_SLOT_QTY; index++) {
+      if(xlog_module_valid(index)) {
+         xlog_level_update(index, g_xlog_config_levels[index]);
+      }
    }
+   pthread_mutex_unlock(&g_xlog_module_mutex);
+
+   return(0);
+}
+
+void xlog_config_levels_get(json_t *obj, xlog_level_t *levels, bool verbose) {
    if(!json_is_object(obj)) {
       XLOGD_ERROR("unable to load config file - not a json object");
-      return(0);
+      return;
    }
 
    const char *module;
@@ -170,7 +373,7 @@ int xlog_init_int(xlog_module_id_t id, const char *filename, uint32_t file_size_
           continue;
        }
        xlog_module_id_t id = xlog_module_to_id(module);
-       if(((uint32_t)id) >= XLOG_MODULE_QTY_MAX) {
+       if(!xlog_module_valid(id)) {
           XLOGD_WARN("module <%s> not found", module);
           continue;
        }
@@ -180,16 +383,83 @@ int xlog_init_int(xlog_module_id_t id, const char *filename, uint32_t file_size_
           continue;
        }
 
-       g_xlog_modules[id] = level;
-       XLOGD_INFO("module <%s> level <%s>", module, level_str);
+       levels[id] = level;
+       if(verbose) {
+          XLOGD_INFO("module <%s> level <%s>", module, level_str);
+       }
    }
+}
 
-   json_decref(obj);
+int xlog_config_reload(void) {
+   static const char *names[] = { "ALL", "DEBUG", "INFO", "WARN", "ERROR", "FATAL" };
+   xlog_level_t levels[XLOG_MODULE_SLOT_QTY];
 
-   return(0);
+   if(!g_xlog_init) {
+      return(-1);
+   }
+   for(uint32_t index = 0; index < XLOG_MODULE_SLOT_QTY; index++) {
+      levels[index] = XLOG_LEVEL_INFO;
+   }
+
+   // A module registered during the reload would otherwise be reverted to the default level
+   pthread_mutex_lock(&g_xlog_module_mutex);
+
+   // A missing file reverts the modules to the default level.  A file which can't be parsed (ie. partially written) is ignored.
+   char file[128] = { '\0' };
+   json_t *obj = xlog_config_load(g_xlog_config_id, file, sizeof(file), NULL);
+
+   if(obj != NULL) {
+      if(!json_is_object(obj)) {
+         XLOGD_ERROR("unable to reload config file <%s> - not a json object", file);
+         json_decref(obj);
+         pthread_mutex_unlock(&g_xlog_module_mutex);
+         return(-1);
+      }
+      xlog_config_levels_get(obj, levels, false);
+      json_decref(obj);
+   } else if(file[0] != '\0') {
+      XLOGD_WARN("unable to reload config file <%s>, levels unchanged", file);
+      pthread_mutex_unlock(&g_xlog_module_mutex);
+      return(-1);
+   }
+
+   // Only modules whose configured level changed are updated so levels set at run time for other modules are preserved
+   char     summary[512];
+   size_t   used    = 0;
+   uint32_t changes = 0;
+
+   summary[0] = '\0';
+   for(uint32_t index = 0; index < XLOG_MODULE_SLOT_QTY; index++) {
+      if(!xlog_module_valid(index) || levels[index] == g_xlog_config_levels[index]) {
+         continue;
+      }
+      if(used < sizeof(summary)) {
+         int rc = snprintf(&summary[used], sizeof(summary) - used, " %s <%s -> %s>", xlog_module_name_get(index, NULL),
+                           names[g_xlog_config_levels[index]], names[levels[index]]);
+         if(rc > 0) {
+            used += rc;
+         }
+      }
+      g_xlog_config_levels[index] = levels[index];
+      xlog_level_update(index, levels[index]);
+      changes++;
+   }
+   pthread_mutex_unlock(&g_xlog_module_mutex);
+
+   XLOGD_INFO("configuration reloaded from <%s> modules changed <%u>%s", (file[0] != '\0') ? file : "defaults", changes, summary);
+   return(changes);
 }
 
 void xlog_term(void) {
+   xlog_config_watch_stop();
+   xlog_shm_detach();
+   xlog_shed_stop();
+   xlog_collapse_flush();
+   xlog_async_term();
+   xlog_zfile_close();
+   xlog_sink_remove_all();
+   xlog_binary_close();
+   xlog_recorder_close();
    #ifdef USE_CURTAIL
    if(g_crtl_init) {
       crtl_term();
@@ -198,44 +468,56 @@ void xlog_term(void) {
    #endif
 }
 
-json_t *xlog_config_load(xlog_module_id_t id) {
-   const char *config_fn_dev   = XLOG_CONFIG_FILE_DEV;
-   const char *config_fn_prd   = XLOG_CONFIG_FILE_PRD;
-   char config_fn_dev_mod[128] = { '\0' };
-   char config_fn_prd_mod[128] = { '\0' };
+uint32_t xlog_config_files(xlog_module_id_t id, bool production, char files[][XLOG_CONFIG_FILE_SIZE_MAX]) {
+   // The module's own files take priority and the development files are only used in non-production builds
+   uint32_t qty = 0;
+   if(!production && xlog_module_valid(id)) {
+      snprintf(files[qty++], XLOG_CONFIG_FILE_SIZE_MAX, "%s%s.json", XLOG_CONFIG_FILE_DEV_ROOT, xlog_module_name_get(id, NULL));
+   }
+   if(!production) {
+      snprintf(files[qty++], XLOG_CONFIG_FILE_SIZE_MAX, "%s", XLOG_CONFIG_FILE_DEV);
+   }
+   if(xlog_module_valid(id)) {
+      snprintf(files[qty++], XLOG_CONFIG_FILE_SIZE_MAX, "%s%s.json", XLOG_CONFIG_FILE_PRD_ROOT, xlog_module_name_get(id, NULL));
+   }
+   snprintf(files[qty++], XLOG_CONFIG_FILE_SIZE_MAX, "%s", XLOG_CONFIG_FILE_PRD);
+   return(qty);
+}
+
+json_t *xlog_config_load(xlog_module_id_t id, char *file, size_t size, struct stat *source) {
    char *contents = NULL;
 
-   #ifdef RDK_PLATFORM
    // Get production flag
-   rdk_version_info_t info;
-   memset(&info, 0, sizeof(info));
-   info.production_build = true;
-   rdk_version_parse_version(&info);
-   bool is_production = info.production_build;
-   rdk_version_object_free(&info);
-   #else
-   bool is_production = false;
-   #endif
+   if(g_xlog_config_production < 0) {
+      #ifdef RDK_PLATFORM
+      rdk_version_info_t info;
+      memset(&info, 0, sizeof(info));
+      info.production_build = true;
+      rdk_version_parse_version(&info);
+      g_xlog_config_production = info.production_build;
+      rdk_version_object_free(&info);
+      #else
+      g_xlog_config_production = false;
+      #endif
+   }
+   bool is_production = g_xlog_config_production;
 
-   // Get module string
-   bool module_valid = true;
-   if(((uint32_t)id) >= XLOG_MODULE_ID_INVALID) {
+   if(!xlog_module_valid(id)) {
       XLOGD_WARN("invalid module id <%d>", id);
-      module_valid = false;
-   } else {
-      snprintf(config_fn_dev_mod, sizeof(config_fn_dev_mod), "%s%s.json", XLOG_CONFIG_FILE_DEV_ROOT, g_xlog_module_id_to_str[id]);
-      snprintf(config_fn_prd_mod, sizeof(config_fn_prd_mod), "%s%s.json", XLOG_CONFIG_FILE_PRD_ROOT, g_xlog_module_id_to_str[id]);
-   }
-
-   if(!is_production && module_valid && (0 == access(config_fn_dev_mod, F_OK)) && xlog_file_get_contents(config_fn_dev_mod, &contents)) {
-      XLOGD_INFO("Read configuration from <%s>", config_fn_dev_mod);
-   } else if(!is_production && (0 == access(config_fn_dev, F_OK)) && xlog_file_get_contents(config_fn_dev, &contents)) {
-      XLOGD_INFO("Read configuration from <%s>", config_fn_dev);
-   } else if(module_valid && (0 == access(config_fn_prd_mod, F_OK)) && xlog_file_get_contents(config_fn_prd_mod, &contents)) {
-      XLOGD_INFO("Read configuration from <%s>", config_fn_prd_mod);
-   } else if((0 == access(config_fn_prd, F_OK)) && xlog_file_get_contents(config_fn_prd, &contents)) {
-      XLOGD_INFO("Read configuration from <%s>", config_fn_prd);
-   } else {
+   }
+
+   // Missing files are skipped by the open instead of probing each one first
+   char        files[XLOG_CONFIG_FILE_QTY_MAX][XLOG_CONFIG_FILE_SIZE_MAX];
+   uint32_t    qty   = xlog_config_files(id, is_production, files);
+   struct stat st;
+   uint32_t    index;
+   for(index = 0; index < qty; index++) {
+      if(xlog_file_get_contents(files[index], &contents, &st)) {
+         snprintf(file, size, "%s", files[index]);
+         break;
+      }
+   }
+   if(index >= qty) {
       XLOGD_WARN("Configuration error. Configuration file(s) missing, using defaults");
       return(NULL);
    }
@@ -244,6 +526,9 @@ json_t *xlog_config_load(xlog_module_id_t id) {
       XLOGD_WARN("Configuration error. Empty configuration file, using defaults");
       return(NULL);
    }
+   if(source != NULL) {
+      *source = st;
+   }
    json_error_t json_error;
    memset(&json_error, 0, sizeof(json_error));
    json_t *obj = json_loads(contents, JSON_REJECT_DUPLICATES, &json_error);
@@ -255,9 +540,9 @@ json_t *xlog_config_load(xlog_module_id_t id) {
    return(obj);
 }
 
-bool xlog_file_get_contents(const char *file, char **contents) {
+bool xlog_file_get_contents(const char *file, char **contents, struct stat *st) {
    int fd = -1;
-   if(file == NULL || contents == NULL) {
+   if(file == NULL || contents == NULL || st == NULL) {
       XLOGD_ERROR("invalid params");
       return(false);
    }
@@ -271,46 +556,27 @@ bool xlog_file_get_contents(const char *file, char **contents) {
             continue;
          }
          int errsv = errno;
-         XLOGD_ERROR("file open <%s>", strerror(errsv));
-         return(false);
-      }
-      break;
-   } while(1);
-
-   // Get size
-   off_t file_size = 0;
-   do {
-      file_size = lseek(fd, 0, SEEK_END);
-      if(file_size < 0) {
-         if(errno == EINTR) {
-            continue;
+         if(errsv != ENOENT) { // Missing files are expected while searching for the configuration file
+            XLOGD_ERROR("file open <%s>", strerror(errsv));
          }
-         int errsv = errno;
-         XLOGD_ERROR("unable to seek end of file <%s>", strerror(errsv));
-         close(fd);
-         return(false);
-      }
-      if(file_size == 0) {
-         XLOGD_ERROR("empty file");
-         close(fd);
          return(false);
       }
       break;
    } while(1);
 
-   // Seek to beginning of file
-   do {
-      if(lseek(fd, 0, SEEK_SET) < 0) {
-         if(errno == EINTR) {
-            continue;
-         }
-         int errsv = errno;
-         XLOGD_ERROR("unable to seek start of file <%s>", strerror(errsv));
-         close(fd);
-         return(false);
-      }
-      break;
-   } while(1);
+   // Get size.  The identity of the file is also returned for the configuration cache.
+   if(fstat(fd, st) < 0) {
+      int errsv = errno;
+      XLOGD_ERROR("unable to stat file <%s>", strerror(errsv));
+      close(fd);
+      return(false);
+   }
+   off_t file_size = st->st_size;
+   if(file_size == 0) {
+      XLOGD_ERROR("empty file");
+      close(fd);
+      return(false);
+   }
 
    // Allocate memory
    *contents = malloc(file_size + 1);
@@ -357,16 +623,16 @@ bool xlog_file_get_contents(const char *file, char **contents) {
 #ifdef MACRO_LEVEL_CHECK
 // NOTE: The level check has been removed from the macro for a small speedup as no adverse effects should occur.  If level is
 //       invalid, the result will be to print the message.
-#define xlog_level_enabled(id, level) ({          \
-   if(((uint32_t)id) >= XLOG_MODULE_ID_INVALID) { \
-      XLOGD_WARN("invalid module id <%d>", id);   \
-      return(false);                              \
-   }                                              \
-   (level >= g_xlog_modules[id]);                 \
+#define xlog_level_enabled(id, level) ({                                         \
+   if(((uint32_t)id) >= XLOG_MODULE_ID_INVALID && !xlog_module_valid(id)) { \
+      XLOGD_WARN("invalid module id <%d>", id);                                  \
+      return(false);                                                             \
+   }                                                                             \
+   (level >= g_xlog_modules[id]);                                                \
 })
 #else
 bool xlog_level_enabled(xlog_module_id_t id, xlog_level_t level) {
-   if(((uint32_t)id) >= XLOG_MODULE_ID_INVALID) {
+   if(!xlog_module_valid(id)) {
       XLOGD_WARN("invalid module id <%d>", id);
       return(false);
    }
@@ -379,6 +645,15 @@ bool xlog_level_enabled(xlog_module_id_t id, xlog_level_t level) {
 }
 #endif
 
+// Call sites from the registry can be enabled or disabled regardless of the module's level
+#define xlog_args_enabled(args) (((args)->options & XLOG_OPTS_SITE) ? xlog_site_enabled(args) : xlog_level_enabled((args)->id, (args)->level))
+
+// Enabled records below the print level are only written to the flight recorder (unless the call site is enabled).  The
+// same applies to records below the shed level while the output is too slow.
+#define xlog_args_below_print(args) ((args)->level < g_xlog_print_levels[(args)->id] && \
+                                     !(((args)->options & XLOG_OPTS_SITE) && (((const xlog_site_t *)(args))->flags & XLOG_SITE_FLAG_ON)))
+#define xlog_args_record_only(args) (xlog_args_below_print(args) || (args)->level < g_xlog_shed_level)
+
 xlog_level_t xlog_level_str_to_enum(const char *level) {
    rdkx_logger_level_t *mod = rdkx_logger_level_str_to_num(level, strlen(level));
 
@@ -390,24 +665,111 @@ xlog_level_t xlog_level_str_to_enum(const char *level) {
 }
 
 xlog_module_id_t xlog_module_to_id(const char *module) {
-   rdkx_logger_module_t *mod = rdkx_logger_module_str_to_index(module, strlen(module));
+   size_t                len = strlen(module);
+   rdkx_logger_module_t *mod = rdkx_logger_module_str_to_index(module, len);
+
+   if(mod != NULL) {
+      return(mod->id);
+   }
+   // Not a generated module so search the registered modules
+   uint32_t qty = __atomic_load_n(&g_xlog_module_dynamic_qty, __ATOMIC_ACQUIRE);
+   for(uint32_t index = 0; index < qty; index++) {
+      if(g_xlog_module_dynamic_strlen[index] == len && 0 == memcmp(g_xlog_module_dynamic_names[index], module, len)) {
+         return((xlog_module_id_t)(XLOG_MODULE_ID_DYNAMIC_FIRST + index));
+      }
+   }
+   return(XLOG_MODULE_QTY_MAX);
+}
+
+bool xlog_module_valid(xlog_module_id_t id) {
+   if(((uint32_t)id) < XLOG_MODULE_ID_INVALID) {
+      return(true);
+   }
+   return(((uint32_t)id) - XLOG_MODULE_ID_DYNAMIC_FIRST < __atomic_load_n(&g_xlog_module_dynamic_qty, __ATOMIC_ACQUIRE));
+}
+
+const char *xlog_module_name_get(xlog_module_id_t id, uint32_t *len) {
+   uint32_t    name_len = 0;
+   const char *name     = NULL;
+   if(((uint32_t)id) < XLOG_MODULE_ID_INVALID) {
+      name     = g_xlog_module_id_to_str[id];
+      name_len = g_xlog_module_id_to_strlen[id];
+   } else if(xlog_module_valid(id)) {
+      name     = g_xlog_module_dynamic_names[id - XLOG_MODULE_ID_DYNAMIC_FIRST];
+      name_len = g_xlog_module_dynamic_strlen[id - XLOG_MODULE_ID_DYNAMIC_FIRST];
+   } else {
+      name     = "?";
+      name_len = 1;
+   }
+   if(len != NULL) {
+      *len = name_len;
+   }
+   return(name);
+}
 
-   if(mod == NULL) {
-      return(XLOG_MODULE_QTY_MAX);
+const char *xlog_module_name(xlog_module_id_t id) {
+   return(xlog_module_valid(id) ? xlog_module_name_get(id, NULL) : NULL);
+}
+
+xlog_module_id_t xlog_module_register(const char *name) {
+   static const char *names[] = { "ALL", "DEBUG", "INFO", "WARN", "ERROR", "FATAL" };
+   size_t len = (name == NULL) ? 0 : strlen(name);
+   if(len == 0 || len >= XLOG_MODULE_NAME_SIZE_MAX) {
+      XLOGD_ERROR("invalid module name <%s>", (name == NULL) ? "NULL" : name);
+      return(XLOG_MODULE_ID_INVALID);
+   }
+   pthread_mutex_lock(&g_xlog_module_mutex);
+   xlog_module_id_t id = xlog_module_to_id(name);
+   if(xlog_module_valid(id)) { // Generated or already registered
+      pthread_mutex_unlock(&g_xlog_module_mutex);
+      return(id);
+   }
+   uint32_t qty = g_xlog_module_dynamic_qty;
+   if(qty >= XLOG_MODULE_DYNAMIC_QTY_MAX) {
+      pthread_mutex_unlock(&g_xlog_module_mutex);
+      XLOGD_ERROR("module table is full <%u>, unable to register <%s>", qty, name);
+      return(XLOG_MODULE_ID_INVALID);
+   }
+   id = (xlog_module_id_t)(XLOG_MODULE_ID_DYNAMIC_FIRST + qty);
+   memcpy(g_xlog_module_dynamic_names[qty], name, len + 1);
+   g_xlog_module_dynamic_strlen[qty] = len;
+
+   // The level from the configuration file is set before the module is published
+   xlog_level_t level = XLOG_LEVEL_INFO;
+   if(g_xlog_init && xlog_config_cache_level(g_xlog_config_id, name, &level) < 0) {
+      char    file[128] = { '\0' };
+      json_t *obj       = xlog_config_load(g_xlog_config_id, file, sizeof(file), NULL);
+      if(obj != NULL) {
+         json_t *value = json_is_object(obj) ? json_object_get(obj, name) : NULL;
+         if(json_is_string(value)) {
+            xlog_level_t config = xlog_level_str_to_enum(json_string_value(value));
+            if(((uint32_t)config) < XLOG_LEVEL_INVALID) {
+               level = config;
+            } else {
+               XLOGD_WARN("module <%s> level <%s> is invalid", name, json_string_value(value));
+            }
+         }
+         json_decref(obj);
+      }
    }
+   g_xlog_config_levels[id] = level;
+   xlog_level_update(id, level);
+   __atomic_store_n(&g_xlog_module_dynamic_qty, qty + 1, __ATOMIC_RELEASE);
+   pthread_mutex_unlock(&g_xlog_module_mutex);
 
-   return(mod->id);
+   XLOGD_INFO("module <%s> id <%d> level <%s>", name, id, names[level]);
+   return(id);
 }
 
 xlog_level_t xlog_level_get(xlog_module_id_t id) {
-   if(((uint32_t)id) >= XLOG_MODULE_ID_INVALID) {
+   if(!xlog_module_valid(id)) {
       return(XLOG_LEVEL_INVALID);
    }
 
-   if(((uint32_t)g_xlog_modules[id]) >= XLOG_LEVEL_INVALID) {
+   if(((uint32_t)g_xlog_print_levels[id]) >= XLOG_LEVEL_INVALID) {
       return(XLOG_LEVEL_INVALID);
    }
-   return(g_xlog_modules[id]);
+   return(g_xlog_print_levels[id]);
 }
 
 void xlog_level_set(xlog_module_id_t id, xlog_level_t level) {
@@ -416,12 +778,12 @@ void xlog_level_set(xlog_module_id_t id, xlog_level_t level) {
       return;
    }
 
-   if(((uint32_t)id) >= XLOG_MODULE_QTY_MAX) {
+   if(!xlog_module_valid(id)) {
       XLOGD_ERROR("invalid module id <%d>", id);
       return;
    }
 
-   g_xlog_modules[id] = level;
+   xlog_level_update(id, level);
 }
 
 void xlog_level_set_all(xlog_level_t level) {
@@ -429,8 +791,25 @@ void xlog_level_set_all(xlog_level_t level) {
       XLOGD_ERROR("invalid log level <%d>", level);
       return;
    }
-   for(uint32_t id = 0; id < XLOG_MODULE_QTY_MAX; id++) {
-      g_xlog_modules[id] = level;
+   for(uint32_t id = 0; id < XLOG_MODULE_SLOT_QTY; id++) {
+      if(xlog_module_valid(id)) {
+         xlog_level_update(id, level);
+      }
+   }
+}
+
+void xlog_level_update(uint32_t id, xlog_level_t level) {
+   // Each level is a single aligned store so the logging path reads either the old or new level without a lock
+   xlog_level_t record = __atomic_load_n(&g_xlog_recorder_level, __ATOMIC_RELAXED);
+   __atomic_store_n(&g_xlog_print_levels[id], level, __ATOMIC_RELAXED);
+   __atomic_store_n(&g_xlog_modules[id], (record < level) ? record : level, __ATOMIC_RELAXED);
+}
+
+void xlog_levels_refresh(void) {
+   for(uint32_t id = 0; id < XLOG_MODULE_SLOT_QTY; id++) {
+      if(xlog_module_valid(id)) {
+         xlog_level_update(id, g_xlog_print_levels[id]);
+      }
    }
 }
 
@@ -438,7 +817,7 @@ bool xlog_level_active(xlog_module_id_t id, xlog_level_t level) {
    return(xlog_level_enabled(id, level));
 }
 
-uint32_t xlog_date_time(const xlog_args_t *args, char *buffer) {
+uint32_t xlog_date_time(const xlog_args_t *args, const struct timeval *tv, char *buffer) {
    if(buffer == NULL) {
       return(0);
    }
@@ -446,148 +825,633 @@ uint32_t xlog_date_time(const xlog_args_t *args, char *buffer) {
       buffer[0] = '\n';
       return(0);
    }
+   uint32_t digits = (args->options & XLOG_OPTS_NSEC) ? 9 : (args->options & XLOG_OPTS_USEC) ? 6 : 3;
 
-   struct tm tm_val;
-   struct timeval tv;
-
-   uint16_t msecs;
-   gettimeofday(&tv, NULL);
-   if(args->options & XLOG_OPTS_GMT) {
-      gmtime_r(&tv.tv_sec, &tm_val);
+   struct timespec now;
+   if(tv != NULL) { // Wall clock time of a stored record (flight recorder, binary records)
+      now.tv_sec  = tv->tv_sec;
+      now.tv_nsec = tv->tv_usec * 1000;
+   } else if(args->options & (XLOG_OPTS_MONO | XLOG_OPTS_NSEC | XLOG_OPTS_COARSE)) {
+      xlog_time_get(args->options, &now);
+      if(args->options & XLOG_OPTS_MONO) {
+         return(xlog_time_mono(&now, digits, buffer));
+      }
    } else {
-      localtime_r(&tv.tv_sec, &tm_val);
+      struct timeval wall;
+      gettimeofday(&wall, NULL);
+      now.tv_sec  = wall.tv_sec;
+      now.tv_nsec = wall.tv_usec * 1000;
    }
-   msecs = (uint16_t)(tv.tv_usec/1000);
-   
-   size_t rc = 0;
+
+   // The date and time are only formatted once per second per thread.  Only the fraction is updated for each call.
+   xlog_time_cache_t *cache = &g_xlog_time_cache[(args->options & XLOG_OPTS_GMT) ? 1 : 0];
+   if(!cache->valid || cache->second != now.tv_sec) {
+      xlog_time_cache_update(cache, now.tv_sec, (args->options & XLOG_OPTS_GMT) ? true : false);
+   }
+
+   uint32_t rc = 0;
    if((args->options & (XLOG_OPTS_DATE | XLOG_OPTS_TIME)) == (XLOG_OPTS_DATE | XLOG_OPTS_TIME)) {
-      rc = strftime(buffer, 18, "%Y%m%d %T", &tm_val);
+      memcpy(buffer, cache->str, 17);
+      rc = 17;
    } else if(args->options & XLOG_OPTS_TIME) {
-      rc = strftime(buffer, 18, "%T", &tm_val);
-   } else if(args->options & XLOG_OPTS_DATE) {
-      rc = strftime(buffer, 18, "%Y%m%d", &tm_val);
+      memcpy(buffer, &cache->str[9], 8);
+      rc = 8;
+   } else {
+      memcpy(buffer, cache->str, 8);
+      buffer[8] = '\0';
+      return(8);
    }
-   
-   if(args->options & XLOG_OPTS_TIME && (rc + 5 <= XLOG_PREFIX_SIZE)) {
-      //printing milliseconds as ":XXX "
-      buffer[rc + 4] = '\0';                             //Null terminate milliseconds
-      buffer[rc + 3] = (msecs % 10) + '0'; msecs  /= 10; //get the 1's digit
-      buffer[rc + 2] = (msecs % 10) + '0'; msecs  /= 10; //get the 10's digit
-      buffer[rc + 1] = (msecs % 10) + '0';               //get the 100's digit
-      buffer[rc] = ':';
+   return(rc + xlog_time_fraction(now.tv_nsec, digits, ':', &buffer[rc]));
+}
+
+void xlog_time_get(uint32_t options, struct timespec *ts) {
+   if(!(options & XLOG_OPTS_MONO)) {
+      clock_gettime((options & XLOG_OPTS_COARSE) ? XLOG_CLOCK_REALTIME_COARSE : CLOCK_REALTIME, ts);
+      return;
+   }
+   clock_gettime((options & XLOG_OPTS_COARSE) ? XLOG_CLOCK_MONOTONIC_COARSE : CLOCK_MONOTONIC, ts);
+
+   if(options & XLOG_OPTS_MONO_START) {
+      // The coarse clock can be up to one tick behind the start time
+      uint64_t now   = ((uint64_t)ts->tv_sec * 1000000000) + ts->tv_nsec;
+      uint64_t start = g_xlog_time_start;
+      now         = (now > start) ? now - start : 0;
+      ts->tv_sec  = now / 1000000000;
+      ts->tv_nsec = now % 1000000000;
    }
-   return(rc + 4);
 }
 
-int xlog_prefix(const xlog_args_t *args, char *str, size_t size) {
-   int used = 0;
-   // Color Begin (copy direct to destination)
-   if((args->options & XLOG_OPTS_COLOR) && args->color != NULL && (size >= (sizeof(XLOG_COLOR_NRM) + 1))) {
-      size_t len = strlen(args->color);
-      if(len < 4 || len > 5) {
-         return(-1);
-      }
-      memcpy(&str[used], args->color, len + 1);
-      used += len;
+uint32_t xlog_time_mono(const struct timespec *ts, uint32_t digits, char *buffer) {
+   // Printed as seconds followed by the fraction (ie. "12345.678").  Ten digits cover more than 300 years.
+   char     str[10];
+   uint32_t len = 0;
+   uint64_t sec = ts->tv_sec;
+   do {
+      str[len++] = (sec % 10) + '0';
+      sec /= 10;
+   } while(sec != 0 && len < sizeof(str));
+
+   for(uint32_t index = 0; index < len; index++) {
+      buffer[index] = str[len - index - 1];
    }
-   // Date and Time
-   if(args->options & (XLOG_OPTS_DATE | XLOG_OPTS_TIME) && ((size - used) > XLOG_PREFIX_SIZE)) {
-      used += xlog_date_time(args, &str[used]);
-      str[used++] = ' ';
+   return(len + xlog_time_fraction(ts->tv_nsec, digits, '.', &buffer[len]));
+}
+
+uint32_t xlog_time_fraction(uint32_t nsec, uint32_t digits, char separator, char *buffer) {
+   // Printed as ":XXX", ":XXXXXX" or ":XXXXXXXXX" (the separator is '.' for the monotonic time)
+   uint32_t value = nsec / ((digits == 3) ? 1000000 : (digits == 6) ? 1000 : 1);
+   buffer[0]          = separator;
+   buffer[digits + 1] = '\0';
+   for(uint32_t index = digits; index > 0; index--) {
+      buffer[index] = (value % 10) + '0';
+      value /= 10;
    }
+   return(digits + 1);
+}
 
-   // Module Name
-   uint32_t name_len = strlen(g_xlog_module_id_to_str[args->id]); // TODO: create lookup table for this
-   if((args->options & XLOG_OPTS_MOD_NAME) && ((size - used) > name_len)) {
-      memcpy(&str[used], g_xlog_module_id_to_str[args->id], name_len);
-      used += name_len;
-      str[used++] = ' ';
+bool xlog_time_anchor_due(void) {
+   struct timespec ts;
+   clock_gettime(XLOG_CLOCK_MONOTONIC_COARSE, &ts);
+
+   uint64_t now  = ((uint64_t)ts.tv_sec * 1000000000) + ts.tv_nsec;
+   uint64_t next = __atomic_load_n(&g_xlog_time_anchor_next, __ATOMIC_RELAXED);
+   if(now < next) {
+      return(false);
    }
+   // Only the thread which moves the time of the next anchor writes this one
+   return(__atomic_compare_exchange_n(&g_xlog_time_anchor_next, &next, now + (XLOG_TIME_ANCHOR_PERIOD * 1000000000ULL), false, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
 
-   // Function
-   if(args->function != NULL) {
-      uint32_t func_len = strlen(args->function);
-      if(((size - used) > func_len)) {
-         memcpy(&str[used], args->function, func_len);
-         used += func_len;
-      }
+void xlog_time_anchor(const xlog_args_t *args, FILE *stream, int fd) {
+   // Both clocks are read together so the monotonic times of the following records can be converted to wall clock time
+   struct timespec mono, real;
+   clock_gettime(CLOCK_MONOTONIC, &mono);
+   clock_gettime(CLOCK_REALTIME, &real);
+
+   bool              gmt = (args->options & XLOG_OPTS_GMT) ? true : false;
+   xlog_time_cache_t wall;
+   xlog_time_cache_update(&wall, real.tv_sec, gmt);
+
+   uint64_t boot  = ((uint64_t)mono.tv_sec * 1000000000) + mono.tv_nsec;
+   uint64_t start = (boot > g_xlog_time_start) ? boot - g_xlog_time_start : 0;
+   char     body[160];
+   int      len = snprintf(body, sizeof(body), "time anchor boot <%llu.%09llu> start <%llu.%09llu> realtime <%lld.%09ld> %s <%s>",
+                           (unsigned long long)(boot / 1000000000), (unsigned long long)(boot % 1000000000), (unsigned long long)(start / 1000000000),
+                           (unsigned long long)(start % 1000000000), (long long)real.tv_sec, (long)real.tv_nsec, gmt ? "gmt" : "local", wall.str);
+   if(len <= 0 || (size_t)len >= sizeof(body)) {
+      return;
    }
+   // Written with the options of the record so it goes to the same outputs.  A FATAL record's side effects are not repeated.
+   xlog_args_t args_anchor = *args;
+   args_anchor.options &= ~XLOG_OPTS_SITE;
+   args_anchor.color    = XLOG_COLOR_NONE;
+   args_anchor.function = XLOG_FUNCTION_NONE;
+   args_anchor.line     = XLOG_LINE_NONE;
+   if(args_anchor.level == XLOG_LEVEL_FATAL) {
+      args_anchor.level = XLOG_LEVEL_ERROR;
+   }
+   char         prefix[XLOG_PREFIX_BUF_SIZE];
+   char         postfix[XLOG_POSTFIX_SIZE];
+   struct iovec iov[3];
+   iov[1].iov_base = body;
+   iov[1].iov_len  = len;
+   if(xlog_frame(&args_anchor, prefix, postfix, iov) == 0) {
+      xlog_emitv(&args_anchor, stream, fd, iov, 3);
+   }
+}
 
-   // Line Number
-   if(args->line >= 0){
-      int line = args->line;
-      str[used++] = '(';
+void xlog_time_start_set(void) {
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   g_xlog_time_start = ((uint64_t)ts.tv_sec * 1000000000) + ts.tv_nsec;
+}
 
-      uint8_t digit_qty = 10;
-      if(line < 10) {
-         digit_qty = 1;
-      } else if(line < 100) {
-         digit_qty = 2;
-      } else if(line < 1000) {
-         digit_qty = 3;
-      } else if(line < 10000) {
-         digit_qty = 4;
-      } else if(line < 100000) {
-         digit_qty = 5;
-      } else if(line < 1000000) {
-         digit_qty = 6;
-      } else if(line < 10000000) {
-         digit_qty = 7;
-      } else if(line < 100000000) {
-         digit_qty = 8;
-      } else if(line < 1000000000) {
-         digit_qty = 9;
-      }
+void xlog_time_cache_update(xlog_time_cache_t *cache, time_t second, bool gmt) {
+   int64_t value = second;
+
+   // Local time is converted using the cached UTC offset.  Both localtime_r and gmtime_r take the glibc time zone lock, so
+   // the conversion to a calendar date is done here instead.
+   if(!gmt) {
+      value += xlog_time_offset_get(second);
+   }
+   int64_t days = value / 86400;
+   int64_t secs = value % 86400;
+   if(secs < 0) {
+      secs += 86400;
+      days--;
+   }
+
+   // Convert days since the epoch to year, month and day of the proleptic Gregorian calendar
+   days += 719468;
+   int64_t  era  = (days >= 0 ? days : days - 146096) / 146097;
+   uint32_t doe  = (uint32_t)(days - era * 146097);
+   uint32_t yoe  = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+   uint32_t doy  = doe - (365 * yoe + yoe / 4 - yoe / 100);
+   uint32_t mp   = (5 * doy + 2) / 153;
+   uint32_t mday = doy - (153 * mp + 2) / 5 + 1;
+   uint32_t mon  = (mp < 10) ? mp + 3 : mp - 9;
+   uint32_t year = (uint32_t)((int64_t)yoe + era * 400 + (mon <= 2)) % 10000;
+   uint32_t hour = (uint32_t)(secs / 3600);
+   uint32_t min  = (uint32_t)(secs / 60 % 60);
+   uint32_t sec  = (uint32_t)(secs % 60);
+   char *   str  = cache->str;
+
+   str[0]  = (year / 1000)     + '0';
+   str[1]  = (year / 100 % 10) + '0';
+   str[2]  = (year / 10 % 10)  + '0';
+   str[3]  = (year % 10)       + '0';
+   str[4]  = (mon / 10)        + '0';
+   str[5]  = (mon % 10)        + '0';
+   str[6]  = (mday / 10)       + '0';
+   str[7]  = (mday % 10)       + '0';
+   str[8]  = ' ';
+   str[9]  = (hour / 10)       + '0';
+   str[10] = (hour % 10)       + '0';
+   str[11] = ':';
+   str[12] = (min / 10)        + '0';
+   str[13] = (min % 10)        + '0';
+   str[14] = ':';
+   str[15] = (sec / 10)        + '0';
+   str[16] = (sec % 10)        + '0';
+   str[17] = '\0';
+
+   cache->second = second;
+   cache->valid  = true;
+}
 
-      used += digit_qty;
-      for(uint8_t index = 1; index <= digit_qty; index++) {
-         str[used - index] = (line % 10) + '0';
-         line /= 10;
-      }
+int32_t xlog_time_offset_get(time_t second) {
+   // Time zone offsets only change on minute boundaries, so the offset is refreshed once per period by the first thread to need it
+   uint32_t period = (uint32_t)(second / XLOG_TIME_OFFSET_PERIOD);
+   uint64_t value  = __atomic_load_n(&g_xlog_time_offset, __ATOMIC_RELAXED);
 
-      str[used++] = ')';
+   if(value != 0 && (uint32_t)(value >> 32) == period) {
+      return((int32_t)(uint32_t)value);
    }
 
-   if((args->options & XLOG_OPTS_LEVEL) && args->level >= XLOG_LEVEL_WARN && (size - used) > 9) {
-      str[used++] = ' ';
-      str[used++] = ':';
-      if(args->level == XLOG_LEVEL_WARN) {
-         str[used++] = 'W';
-         str[used++] = 'A';
-         str[used++] = 'R';
-         str[used++] = 'N';
-      } else if(args->level == XLOG_LEVEL_ERROR) {
-         str[used++] = 'E';
-         str[used++] = 'R';
-         str[used++] = 'R';
-         str[used++] = 'O';
-         str[used++] = 'R';
-      } else if(args->level == XLOG_LEVEL_FATAL) {
-         str[used++] = 'F';
-         str[used++] = 'A';
-         str[used++] = 'T';
-         str[used++] = 'A';
-         str[used++] = 'L';
-      } else {
-         str[used++] = 'I';
-         str[used++] = 'N';
-         str[used++] = 'V';
-         str[used++] = 'A';
-         str[used++] = 'L';
-         str[used++] = 'I';
-         str[used++] = 'D';
-      }
-      str[used]   = '\0';
+   struct tm tm_val;
+   tzset(); // Reloads the time zone if the TZ variable or zone file has changed
+   localtime_r(&second, &tm_val);
+
+   int32_t offset = (int32_t)tm_val.tm_gmtoff;
+   __atomic_store_n(&g_xlog_time_offset, ((uint64_t)period << 32) | (uint32_t)offset, __ATOMIC_RELAXED);
+   return(offset);
+}
+
+int xlog_prefix(const xlog_args_t *args, const struct timeval *tv, char *str, size_t size) {
+   if(args->options & (XLOG_OPTS_TID | XLOG_OPTS_TNAME)) {
+      xlog_thread_check();
    }
+   xlog_prefix_cache_t *entry   = g_xlog_prefix_cache_enable ? xlog_prefix_cache_get(args) : NULL;
+   const xlog_context_t *context = &g_xlog_context;
 
-   if((size - used) > 3) {
-      str[used++] = ' ';
-      str[used++] = ':';
-      str[used++] = ' ';
-      str[used]   = '\0';
+   // Use the cached template if the buffer is large enough that all of the size checks in xlog_prefix_build would pass.  The
+   // function name needs XLOG_PREFIX_TAIL_SIZE after it and the date and time take up to XLOG_PREFIX_SIZE + 1.
+   if(entry == NULL || size <= (size_t)entry->len + context->len + XLOG_PREFIX_SIZE + 1 + XLOG_PREFIX_TAIL_SIZE) {
+      return(xlog_prefix_build(args, tv, str, size, context, false, NULL));
    }
+   uint32_t used = entry->color_len;
+   memcpy(str, entry->str, used);
 
-   return(used);
+   if(args->options & (XLOG_OPTS_DATE | XLOG_OPTS_TIME)) {
+      used += xlog_date_time(args, tv, &str[used]);
+      str[used++] = ' ';
+   }
+   if(context->len == 0) {
+      memcpy(&str[used], &entry->str[entry->color_len], entry->len - entry->color_len + 1);
+      used += entry->len - entry->color_len;
+      return(used);
+   }
+   // Templates always end with the separator since incomplete templates are not cached.  The context goes before it.
+   uint32_t len = entry->len - entry->color_len - 3;
+   memcpy(&str[used], &entry->str[entry->color_len], len);
+   used += len;
+   memcpy(&str[used], context->field, context->len);
+   used += context->len;
+   memcpy(&str[used], " : ", 4);
+   used += 3;
+
+   return(used);
+}
+
+xlog_prefix_cache_t *xlog_prefix_cache_get(const xlog_args_t *args) {
+   #if XLOG_PREFIX_CACHE_QTY > 0
+   xlog_prefix_cache_t **cache = g_xlog_prefix_cache;
+   if(cache == NULL) {
+      pthread_once(&g_xlog_prefix_cache_once, xlog_prefix_cache_key_create);
+      cache = (xlog_prefix_cache_t **)calloc(XLOG_PREFIX_CACHE_QTY, sizeof(xlog_prefix_cache_t *));
+      if(cache == NULL) {
+         return(NULL);
+      }
+      pthread_setspecific(g_xlog_prefix_cache_key, cache);
+      g_xlog_prefix_cache = cache;
+   }
+
+   uintptr_t hash = ((uintptr_t)args->function >> 3) ^ ((uintptr_t)args->line * 7) ^ ((uintptr_t)args->level << 4) ^ ((uintptr_t)args->id << 8) ^ args->options;
+   xlog_prefix_cache_t **slot  = &cache[(hash ^ (hash >> 12)) & (XLOG_PREFIX_CACHE_QTY - 1)];
+   xlog_prefix_cache_t * entry = *slot;
+
+   if(entry == NULL) { // The entries are only allocated for the slots which are used
+      entry = (xlog_prefix_cache_t *)malloc(sizeof(xlog_prefix_cache_t));
+      if(entry == NULL) {
+         return(NULL);
+      }
+      entry->len = 0;
+      *slot      = entry;
+   }
+   if(entry->len != 0                       &&
+      entry->args.function == args->function &&
+      entry->args.line     == args->line     &&
+      entry->args.level    == args->level    &&
+      entry->args.id       == args->id       &&
+      entry->args.options  == args->options  &&
+      entry->args.color    == args->color) {
+      return(entry);
+   }
+
+   // Build the template without the date and time.  The date and time are inserted after the color for each call.
+   xlog_args_t args_template = *args;
+   args_template.options &= ~(XLOG_OPTS_DATE | XLOG_OPTS_TIME);
+
+   entry->len = 0;
+   bool complete = false;
+   int  rc       = xlog_prefix_build(&args_template, NULL, entry->str, sizeof(entry->str), NULL, false, &complete);
+   if(rc <= 0 || !complete) { // Error or too long for a field to fit in the template
+      return(NULL);
+   }
+   entry->args      = *args;
+   entry->color_len = ((args->options & XLOG_OPTS_COLOR) && args->color != NULL) ? strlen(args->color) : 0;
+   entry->len       = rc;
+   return(entry);
+   #else
+   return(NULL);
+   #endif
+}
+
+void xlog_prefix_cache_key_create(void) {
+   pthread_key_create(&g_xlog_prefix_cache_key, xlog_prefix_cache_release);
+}
+
+void xlog_prefix_cache_clear(void) {
+   xlog_prefix_cache_t **cache = g_xlog_prefix_cache;
+   if(cache == NULL) {
+      return;
+   }
+   for(uint32_t index = 0; index < XLOG_PREFIX_CACHE_QTY; index++) {
+      if(cache[index] != NULL) {
+         cache[index]->len = 0;
+      }
+   }
+}
+
+void xlog_prefix_cache_release(void *data) {
+   // Called on thread exit
+   xlog_prefix_cache_t **cache = (xlog_prefix_cache_t **)data;
+   g_xlog_prefix_cache = NULL;
+   for(uint32_t index = 0; index < XLOG_PREFIX_CACHE_QTY; index++) {
+      free(cache[index]);
+   }
+   free(cache);
+}
+
+void xlog_thread_check(void) {
+   xlog_thread_cache_t *cache = &g_xlog_thread_cache;
+   if(!cache->valid) {
+      xlog_thread_refresh();
+      return;
+   }
+   // The name is read again periodically since the thread can be renamed without calling xlog_thread_name_set
+   if(++cache->records >= XLOG_THREAD_CHECK_RECORDS) {
+      char name[sizeof(cache->name)] = { '\0' };
+      cache->records = 0;
+      prctl(PR_GET_NAME, name, 0, 0, 0);
+      if(0 != strncmp(name, cache->name, sizeof(name))) {
+         xlog_thread_refresh();
+      }
+   }
+}
+
+void xlog_thread_refresh(void) {
+   xlog_thread_cache_t *cache = &g_xlog_thread_cache;
+   pthread_once(&g_xlog_thread_once, xlog_thread_atfork);
+
+   uint32_t tid = (uint32_t)syscall(SYS_gettid);
+   memset(cache->name, 0, sizeof(cache->name));
+   prctl(PR_GET_NAME, cache->name, 0, 0, 0);
+   cache->name[sizeof(cache->name) - 1] = '\0';
+
+   // The field fits in XLOG_THREAD_FIELD_SIZE since the name is at most 15 characters
+   cache->field_len[0] = snprintf(cache->field[0], XLOG_THREAD_FIELD_SIZE, "[%u] ", tid);
+   cache->field_len[1] = snprintf(cache->field[1], XLOG_THREAD_FIELD_SIZE, "[%s] ", cache->name);
+   cache->field_len[2] = snprintf(cache->field[2], XLOG_THREAD_FIELD_SIZE, "[%u:%s] ", tid, cache->name);
+
+   cache->records = 0;
+   cache->valid   = true;
+   xlog_prefix_cache_clear();
+}
+
+uint32_t xlog_thread_field_safe(uint32_t thread, char *str) {
+   // Only the id is printed since the name can't be read safely.  The field is left out when only the name was requested.
+   if(thread == 2) {
+      return(0);
+   }
+   char     digits[10];
+   uint32_t len = 0;
+   uint32_t tid = (uint32_t)syscall(SYS_gettid);
+   do {
+      digits[len++] = (tid % 10) + '0';
+      tid /= 10;
+   } while(tid != 0 && len < sizeof(digits));
+
+   str[0] = '[';
+   for(uint32_t index = 0; index < len; index++) {
+      str[index + 1] = digits[len - index - 1];
+   }
+   str[len + 1] = ']';
+   str[len + 2] = ' ';
+   return(len + 3);
+}
+
+void xlog_thread_atfork(void) {
+   pthread_atfork(NULL, NULL, xlog_thread_fork_child);
+}
+
+void xlog_thread_fork_child(void) {
+   // Only the thread which called fork exists in the child and its id has changed
+   g_xlog_thread_cache.valid = false;
+   xlog_prefix_cache_clear();
+}
+
+void xlog_thread_name_set(const char *name) {
+   if(name == NULL) {
+      XLOGD_ERROR("invalid params");
+      return;
+   }
+   if(prctl(PR_SET_NAME, name, 0, 0, 0) < 0) {
+      int errsv = errno;
+      XLOGD_ERROR("unable to set thread name <%s>", strerror(errsv));
+      return;
+   }
+   xlog_thread_refresh();
+}
+
+int xlog_context_push(const char *format, ...) {
+   xlog_context_t *context = &g_xlog_context;
+   if(format == NULL) {
+      XLOGD_ERROR("invalid params");
+      return(-1);
+   }
+   if(context->depth >= XLOG_CONTEXT_DEPTH_MAX) {
+      XLOGD_ERROR("context is full <%u>", context->depth);
+      return(-1);
+   }
+   // The tag is rendered after the current tags, replacing the closing bracket with a space
+   uint32_t len  = context->len;
+   uint32_t used = (len == 0) ? 2 : len;
+   char     tag[XLOG_CONTEXT_SIZE];
+   va_list  ap;
+
+   va_start(ap, format);
+   int rc = xlog_vformat(tag, sizeof(tag), format, ap);
+   va_end(ap);
+
+   if(rc <= 0 || (size_t)(used + rc + 1) >= sizeof(context->field)) {
+      XLOGD_ERROR("invalid or too long tag <%s>", format);
+      return(-1);
+   }
+   if(len == 0) {
+      context->field[0] = ' ';
+      context->field[1] = '[';
+   } else {
+      context->field[used - 1] = ' ';
+   }
+   memcpy(&context->field[used], tag, rc);
+   used += rc;
+   context->field[used++] = ']';
+   context->field[used]   = '\0';
+
+   context->marks[context->depth++] = len;
+   context->len = used;
+   return(0);
+}
+
+void xlog_context_pop(void) {
+   xlog_context_t *context = &g_xlog_context;
+   if(context->depth == 0) {
+      return;
+   }
+   uint32_t len = context->marks[--context->depth];
+   if(len != 0) {
+      context->field[len - 1] = ']';
+      context->field[len]     = '\0';
+   }
+   context->len = len;
+}
+
+void xlog_context_clear(void) {
+   g_xlog_context.depth = 0;
+   g_xlog_context.len   = 0;
+}
+
+int xlog_prefix_build(const xlog_args_t *args, const struct timeval *tv, char *str, size_t size, const xlog_context_t *context, bool safe, bool *complete) {
+   // complete is cleared when a field is left out because the buffer is too small.  The thread cache isn't refreshed when safe is
+   // set since it calls functions which are not async-signal-safe.
+   int  used    = 0;
+   bool omitted = false;
+   // Color Begin (copy direct to destination)
+   if((args->options & XLOG_OPTS_COLOR) && args->color != NULL && (size >= (sizeof(XLOG_COLOR_NRM) + 1))) {
+      size_t len = strlen(args->color);
+      if(len < 4 || len > 5) {
+         return(-1);
+      }
+      memcpy(&str[used], args->color, len + 1);
+      used += len;
+   } else if((args->options & XLOG_OPTS_COLOR) && args->color != NULL) {
+      omitted = true;
+   }
+   // Date and Time
+   if(args->options & (XLOG_OPTS_DATE | XLOG_OPTS_TIME) && ((size - used) > XLOG_PREFIX_SIZE)) {
+      used += xlog_date_time(args, tv, &str[used]);
+      str[used++] = ' ';
+   } else if(args->options & (XLOG_OPTS_DATE | XLOG_OPTS_TIME)) {
+      omitted = true;
+   }
+
+   // Thread (the field index is 0 for TID, 1 for TNAME and 2 for both)
+   uint32_t thread = (args->options & (XLOG_OPTS_TID | XLOG_OPTS_TNAME)) / XLOG_OPTS_TID;
+   if(thread != 0 && safe && !g_xlog_thread_cache.valid) {
+      if((size - used) > XLOG_THREAD_FIELD_SIZE + XLOG_PREFIX_TAIL_SIZE) {
+         used += xlog_thread_field_safe(thread, &str[used]);
+      } else {
+         omitted = true;
+      }
+   } else if(thread != 0) {
+      if(!g_xlog_thread_cache.valid) {
+         xlog_thread_refresh();
+      }
+      uint32_t len = g_xlog_thread_cache.field_len[thread - 1];
+      if((size - used) > len + XLOG_PREFIX_TAIL_SIZE) {
+         memcpy(&str[used], g_xlog_thread_cache.field[thread - 1], len);
+         used += len;
+      } else {
+         omitted = true;
+      }
+   }
+
+   // Module Name
+   uint32_t    name_len;
+   const char *name = xlog_module_name_get(args->id, &name_len);
+   if((args->options & XLOG_OPTS_MOD_NAME) && ((size - used) > name_len)) {
+      memcpy(&str[used], name, name_len);
+      used += name_len;
+      str[used++] = ' ';
+   } else if(args->options & XLOG_OPTS_MOD_NAME) {
+      omitted = true;
+   }
+
+   // Function
+   if(args->function != NULL) {
+      uint32_t func_len = strlen(args->function);
+      if((size - used) > func_len + XLOG_PREFIX_TAIL_SIZE) {
+         memcpy(&str[used], args->function, func_len);
+         used += func_len;
+      } else {
+         omitted = true;
+      }
+   }
+
+   // Line Number
+   if(args->line >= 0 && (size - used) <= 12) {
+      omitted = true;
+   } else if(args->line >= 0) {
+      int line = args->line;
+      str[used++] = '(';
+
+      uint8_t digit_qty = 10;
+      if(line < 10) {
+         digit_qty = 1;
+      } else if(line < 100) {
+         digit_qty = 2;
+      } else if(line < 1000) {
+         digit_qty = 3;
+      } else if(line < 10000) {
+         digit_qty = 4;
+      } else if(line < 100000) {
+         digit_qty = 5;
+      } else if(line < 1000000) {
+         digit_qty = 6;
+      } else if(line < 10000000) {
+         digit_qty = 7;
+      } else if(line < 100000000) {
+         digit_qty = 8;
+      } else if(line < 1000000000) {
+         digit_qty = 9;
+      }
+
+      used += digit_qty;
+      for(uint8_t index = 1; index <= digit_qty; index++) {
+         str[used - index] = (line % 10) + '0';
+         line /= 10;
+      }
+
+      str[used++] = ')';
+   }
+
+   if((args->options & XLOG_OPTS_LEVEL) && args->level >= XLOG_LEVEL_WARN && (size - used) <= 9) {
+      omitted = true;
+   } else if((args->options & XLOG_OPTS_LEVEL) && args->level >= XLOG_LEVEL_WARN) {
+      str[used++] = ' ';
+      str[used++] = ':';
+      if(args->level == XLOG_LEVEL_WARN) {
+         str[used++] = 'W';
+         str[used++] = 'A';
+         str[used++] = 'R';
+         str[used++] = 'N';
+      } else if(args->level == XLOG_LEVEL_ERROR) {
+         str[used++] = 'E';
+         str[used++] = 'R';
+         str[used++] = 'R';
+         str[used++] = 'O';
+         str[used++] = 'R';
+      } else if(args->level == XLOG_LEVEL_FATAL) {
+         str[used++] = 'F';
+         str[used++] = 'A';
+         str[used++] = 'T';
+         str[used++] = 'A';
+         str[used++] = 'L';
+      } else {
+         str[used++] = 'I';
+         str[used++] = 'N';
+         str[used++] = 'V';
+         str[used++] = 'A';
+         str[used++] = 'L';
+         str[used++] = 'I';
+         str[used++] = 'D';
+      }
+      str[used]   = '\0';
+   }
+
+   // Context of the thread
+   if(context != NULL && context->len != 0 && (size - used) > context->len + 3) {
+      memcpy(&str[used], context->field, context->len);
+      used += context->len;
+      str[used] = '\0';
+   } else if(context != NULL && context->len != 0) {
+      omitted = true;
+   }
+
+   if((size - used) > 3) {
+      str[used++] = ' ';
+      str[used++] = ':';
+      str[used++] = ' ';
+      str[used]   = '\0';
+   } else {
+      omitted = true;
+   }
+   if(complete != NULL) {
+      *complete = !omitted;
+   }
+
+   return(used);
 }
 
 int xlog_postfix(const xlog_args_t *args, char *str, size_t size) {
@@ -613,46 +1477,77 @@ int xlog_printf_safe(const xlog_args_t *args, const char *string) {
 int xlog_fprintf_safe(const xlog_args_t *args, FILE *stream, const char *string) {
    if(args == NULL) {
       args = &g_xlog_args_default;
-   } else if(!xlog_level_enabled(args->id, args->level)) {
+   } else if(!xlog_args_enabled(args)) {
+      xlog_stats_suppressed_int(args->id, args->level, true);
       return(0);
    }
    if(string == NULL) {
       return(-1);
    }
-   char buffer[XLOG_STACK_BUF_SIZE];
+   size_t len = strlen(string);
 
-   int rc = xlog_prefix(args, buffer, sizeof(buffer));
+   if(g_xlog_recorder_level < XLOG_LEVEL_INVALID && args != &g_xlog_args_default) {
+      xlog_recorder_write(args, string, len);
+      if(xlog_args_below_print(args)) {
+         xlog_stats_suppressed_int(args->id, args->level, true);
+         return(0);
+      }
+   }
+   return(xlog_safe_output(args, NULL, stream, -1, string, len));
+}
+
+int xlog_safe_output(const xlog_args_t *args, const struct timeval *tv, FILE *stream, int fd, const char *string, size_t len) {
+   char         prefix[XLOG_PREFIX_BUF_SIZE];
+   char         postfix[XLOG_POSTFIX_SIZE];
+   struct iovec iov[3];
+
+   // The prefix cache allocates memory so it can't be used here
+   int rc = xlog_prefix_build(args, tv, prefix, sizeof(prefix), &g_xlog_context, true, NULL);
 
    if(rc < 0) {
       return(rc);
    }
-   size_t size = sizeof(buffer);
-   size_t used = rc;
+   iov[0].iov_base = prefix;
+   iov[0].iov_len  = rc;
+   iov[1].iov_base = (void *)string; // The string is not copied
+   iov[1].iov_len  = len;
 
-   uint32_t str_len = strlen(string);
-   if(((size - used) > str_len)) {
-      memcpy(&buffer[used], string, str_len);
-      used += str_len;
-   }
-
-   rc = xlog_postfix(args, &buffer[used], sizeof(buffer) - used);
+   rc = xlog_postfix(args, postfix, sizeof(postfix));
 
    if(rc < 0) {
       return(rc);
    }
-   used += rc;
+   iov[2].iov_base = postfix;
+   iov[2].iov_len  = rc;
 
-   if(g_xlog_print_safe != NULL) {
-      return(g_xlog_print_safe(args->level, buffer, ((size_t)used > sizeof(buffer)) ? sizeof(buffer) : used));
+   if(g_xlog_printv_safe != NULL) {
+      rc = g_xlog_printv_safe(args->level, iov, 3);
+   } else if(g_xlog_print_safe != NULL) {
+      if(iov[0].iov_len + len + iov[2].iov_len > XLOG_STACK_BUF_SIZE) {
+         xlog_stats_truncated(args->id, true);
+      }
+      rc = xlog_output_join(g_xlog_print_safe, args->level, iov, 3, true);
+   } else if(stream == NULL) {
+      rc = writev(fd, iov, 3);
+   } else {
+      // Locked like xlog_outputv so the record isn't split by another thread's record.  fwrite takes the same lock.
+      size_t size = 0;
+      flockfile(stream);
+      for(uint32_t index = 0; index < 3; index++) {
+         size += fwrite(iov[index].iov_base, 1, iov[index].iov_len, stream);
+      }
+      funlockfile(stream);
+      rc = (size == iov[0].iov_len + len + iov[2].iov_len) ? (int)size : -1;
    }
-
-   return(fwrite(buffer, 1, ((size_t)used > sizeof(buffer)) ? sizeof(buffer) : used, stream));
+   xlog_stats_output(args, rc, true);
+   return(rc);
 }
 
 int xlog_printf(const xlog_args_t *args, const char *format, ...) {
    if(args == NULL) {
       args = &g_xlog_args_default;
-   } else if(!xlog_level_enabled(args->id, args->level)) {
+   } else if(!xlog_args_enabled(args)) {
+      xlog_stats_suppressed(args->id, args->level);
       return(0);
    }
    if(format == NULL) {
@@ -669,7 +1564,8 @@ int xlog_printf(const xlog_args_t *args, const char *format, ...) {
 int xlog_fprintf(const xlog_args_t *args, FILE *stream, const char *format, ...) {
    if(args == NULL) {
       args = &g_xlog_args_default;
-   } else if(!xlog_level_enabled(args->id, args->level)) {
+   } else if(!xlog_args_enabled(args)) {
+      xlog_stats_suppressed(args->id, args->level);
       return(0);
    }
    if(format == NULL) {
@@ -691,7 +1587,8 @@ int xlog_fprintf(const xlog_args_t *args, FILE *stream, const char *format, ...)
 int xlog_dprintf(const xlog_args_t *args, int fd, const char *format, ...) {
    if(args == NULL) {
       args = &g_xlog_args_default;
-   } else if(!xlog_level_enabled(args->id, args->level)) {
+   } else if(!xlog_args_enabled(args)) {
+      xlog_stats_suppressed(args->id, args->level);
       return(0);
    }
    if(format == NULL) {
@@ -714,7 +1611,8 @@ int xlog_dprintf(const xlog_args_t *args, int fd, const char *format, ...) {
 int xlog_snprintf(const xlog_args_t *args, char *str, size_t size, const char *format, ...) {
    if(args == NULL) {
       args = &g_xlog_args_default;
-   } else if(!xlog_level_enabled(args->id, args->level)) {
+   } else if(!xlog_args_enabled(args)) {
+      xlog_stats_suppressed(args->id, args->level);
       return(0);
    }
    if(format == NULL) {
@@ -737,7 +1635,8 @@ int xlog_snprintf(const xlog_args_t *args, char *str, size_t size, const char *f
 int xlog_vfprintf(const xlog_args_t *args, FILE *stream, const char *format, va_list ap) {
    if(args == NULL) {
       args = &g_xlog_args_default;
-   } else if(!xlog_level_enabled(args->id, args->level)) {
+   } else if(!xlog_args_enabled(args)) {
+      xlog_stats_suppressed(args->id, args->level);
       return(0);
    }
    if(format == NULL) {
@@ -753,53 +1652,14 @@ int xlog_vfprintf(const xlog_args_t *args, FILE *stream, const char *format, va_
 }
 
 int xlog_vfprintf_dvi(const xlog_args_t *args, FILE *stream, const char *format, va_list ap) {
-   char buffer[XLOG_STACK_BUF_SIZE];
-   
-   int rc = xlog_prefix(args, buffer, sizeof(buffer));
-
-   if(rc < 0) {
-      return(rc);
-   }
-   size_t used = rc;
-
-   do {
-      if(used >= sizeof(buffer)) {
-         break;
-      }
-   
-      rc = vsnprintf(&buffer[used], sizeof(buffer) - used, format, ap);
-   
-      if(rc < 0) {
-         break;
-      }
-      used += rc;
-   
-      if(used >= sizeof(buffer)) {
-         break;
-      }
-      rc = xlog_postfix(args, &buffer[used], sizeof(buffer) - used);
-   
-      if(rc < 0) {
-         break;
-      }
-      used += rc;
-   } while(0);
-   
-   if(rc < 0) {
-      return(rc);
-   }
-
-   if(g_xlog_print != NULL) {
-      return(g_xlog_print(args->level, buffer, ((size_t)used > sizeof(buffer)) ? sizeof(buffer) : used));
-   }
-
-   return(fwrite(buffer, 1, ((size_t)used > sizeof(buffer)) ? sizeof(buffer) : used, stream));
+   return(xlog_vwrite_dvi(args, stream, -1, format, ap));
 }
 
 int xlog_vdprintf(const xlog_args_t *args, int fd, const char *format, va_list ap) {
    if(args == NULL) {
       args = &g_xlog_args_default;
-   } else if(!xlog_level_enabled(args->id, args->level)) {
+   } else if(!xlog_args_enabled(args)) {
+      xlog_stats_suppressed(args->id, args->level);
       return(0);
    }
    if(format == NULL) {
@@ -815,49 +1675,184 @@ int xlog_vdprintf(const xlog_args_t *args, int fd, const char *format, va_list a
 }
 
 int xlog_vdprintf_dvi(const xlog_args_t *args, int fd, const char *format, va_list ap) {
-   char buffer[XLOG_STACK_BUF_SIZE];
+   return(xlog_vwrite_dvi(args, NULL, fd, format, ap));
+}
 
-   int rc = xlog_prefix(args, buffer, sizeof(buffer));
+int xlog_vwrite_dvi(const xlog_args_t *args, FILE *stream, int fd, const char *format, va_list ap) {
+   if(args != &g_xlog_args_default && xlog_args_record_only(args)) {
+      xlog_args_skipped(args);
+      return(xlog_recorder_vwrite(args, format, ap));
+   }
+   if(g_xlog_binary_modules[args->id]) {
+      int rc = xlog_binary(args, format, ap);
+      if(rc >= 0) {
+         return(rc);
+      }
+   }
+   // The prefix, body and postfix are kept in separate buffers and written with one call
+   char             prefix[XLOG_PREFIX_BUF_SIZE];
+   char             body[XLOG_BODY_BUF_SIZE];
+   xlog_body_buf_t *buf   = &g_xlog_body_buf;
+   bool             own   = (!buf->busy && buf->str != NULL);
+   char *           str   = own ? buf->str  : body;
+   size_t           size  = own ? buf->size : sizeof(body);
+   char *           large = NULL;
+   struct iovec     iov[3];
+   va_list          aq;
+
+   int rc = xlog_prefix(args, NULL, prefix, sizeof(prefix));
 
    if(rc < 0) {
       return(rc);
    }
-   size_t used = rc;
-   
-   do {
-      if(used >= sizeof(buffer)) {
-         break;
-      }
-   
-      rc = vsnprintf(&buffer[used], sizeof(buffer) - used, format, ap);
-   
-      if(rc < 0) {
-         break;
-      }
-      used += rc;
-   
-      if((size_t)used >= sizeof(buffer)) {
-         break;
+   iov[0].iov_base = prefix;
+   iov[0].iov_len  = rc;
+
+   va_copy(aq, ap); // Kept to format a body which does not fit in the buffer
+   rc = xlog_vformat(str, size, format, ap);
+
+   if(rc < 0) {
+      va_end(aq);
+      return(rc);
+   }
+   if((size_t)rc >= size) {
+      char *retry = buf->busy ? NULL : xlog_body_buf_grow(rc + 1);
+      if(retry == NULL) { // Too long to keep or a record written while the thread's buffer is in use
+         retry = large = (char *)malloc(rc + 1);
       }
-      rc = xlog_postfix(args, &buffer[used], sizeof(buffer) - used);
-   
-      if(rc < 0) {
-         break;
+      if(retry != NULL) {
+         // The thread's buffer may have moved so the body is always taken from retry.  The length is limited to its size
+         // in case the second pass is longer (ie. an argument changed).
+         int len = xlog_vformat(retry, rc + 1, format, aq);
+         str = retry;
+         if(len < 0 || len > rc) { // Truncated
+            xlog_stats_truncated(args->id, false);
+            rc = (len < 0) ? 0 : rc;
+         } else {
+            rc = len;
+         }
+      } else { // Truncated
+         rc = size - 1;
+         xlog_stats_truncated(args->id, false);
       }
-      used += rc;
-   } while(0);
-   
+   }
+   va_end(aq);
+
+   iov[1].iov_base = str;
+   iov[1].iov_len  = rc;
+
+   bool busy = (str == buf->str);
+   if(busy) {
+      buf->busy = true;
+   }
+   rc = xlog_write_iov(args, stream, fd, iov);
+   if(busy) {
+      buf->busy = false;
+   }
+   free(large);
+   return(rc);
+}
+
+char *xlog_body_buf_grow(size_t size) {
+   xlog_body_buf_t *buf = &g_xlog_body_buf;
+   if(size > XLOG_BODY_KEEP_SIZE_MAX) {
+      return(NULL);
+   }
+   if(buf->str == NULL) {
+      pthread_once(&g_xlog_body_buf_once, xlog_body_buf_key_create);
+   }
+   size = (size + 1023) & ~(size_t)1023;
+   char *str = (char *)realloc(buf->str, size);
+   if(str == NULL) {
+      return(NULL);
+   }
+   pthread_setspecific(g_xlog_body_buf_key, str);
+   buf->str  = str;
+   buf->size = size;
+   return(str);
+}
+
+void xlog_body_buf_key_create(void) {
+   pthread_key_create(&g_xlog_body_buf_key, free);
+}
+
+int xlog_write_iov(const xlog_args_t *args, FILE *stream, int fd, struct iovec *iov) {
+   // The prefix (iov[0]) and body (iov[1]) are formatted.  The postfix is added to iov[2].
+   char postfix[XLOG_POSTFIX_SIZE];
+
+   if(g_xlog_recorder_level < XLOG_LEVEL_INVALID) {
+      xlog_recorder_write(args, iov[1].iov_base, iov[1].iov_len);
+   }
+   if(g_xlog_collapse && xlog_collapse_check(args, stream, fd, iov[1].iov_base, iov[1].iov_len)) {
+      return(0);
+   }
+
+   int rc = xlog_postfix(args, postfix, sizeof(postfix));
+
    if(rc < 0) {
       return(rc);
    }
-   
-   return(write(fd, buffer, (used > sizeof(buffer)) ? sizeof(buffer) : used));
+   iov[2].iov_base = postfix;
+   iov[2].iov_len  = rc;
+
+   return(xlog_emitv(args, stream, fd, iov, 3));
+}
+
+int xlog_write_args(const xlog_args_t *args, FILE *stream, const char *format, const xlog_arg_t *argv, uint32_t argc) {
+   if(args == NULL) {
+      args = &g_xlog_args_default;
+   } else if(!xlog_args_enabled(args)) {
+      xlog_stats_suppressed(args->id, args->level);
+      return(0);
+   }
+   if(format == NULL || (argv == NULL && argc > 0)) {
+      XLOGD_WARN("invalid params");
+      return(-1);
+   }
+   if(stream == NULL) {
+      XLOGD_WARN("NULL stream");
+      return(-1);
+   }
+   char         prefix[XLOG_PREFIX_BUF_SIZE];
+   char         body[XLOG_STACK_BUF_SIZE];
+   struct iovec iov[3];
+
+   int rc = xlog_format_args(body, sizeof(body), format, argv, argc);
+
+   if(rc < 0) {
+      XLOGD_WARN("invalid format <%s>", format);
+      return(-1);
+   }
+   size_t len = rc;
+   if(len >= sizeof(body)) {
+      len = sizeof(body) - 1;
+      xlog_stats_truncated(args->id, false);
+   }
+
+   if(args != &g_xlog_args_default && xlog_args_record_only(args)) {
+      xlog_recorder_write(args, body, len);
+      xlog_args_skipped(args);
+      return(0);
+   }
+
+   rc = xlog_prefix(args, NULL, prefix, sizeof(prefix));
+
+   if(rc < 0) {
+      return(rc);
+   }
+   iov[0].iov_base = prefix;
+   iov[0].iov_len  = rc;
+   iov[1].iov_base = body;
+   iov[1].iov_len  = len;
+
+   return(xlog_write_iov(args, stream, -1, iov));
 }
 
 int xlog_vsnprintf(const xlog_args_t *args, char *str, size_t size, const char *format, va_list ap) {
    if(args == NULL) {
       args = &g_xlog_args_default;
-   } else if(!xlog_level_enabled(args->id, args->level)) {
+   } else if(!xlog_args_enabled(args)) {
+      xlog_stats_suppressed(args->id, args->level);
       return(0);
    }
    if(format == NULL) {
@@ -873,7 +1868,12 @@ int xlog_vsnprintf(const xlog_args_t *args, char *str, size_t size, const char *
 }
 
 int xlog_vsnprintf_dvi(const xlog_args_t *args, char *str, size_t size, const char *format, va_list ap) {
-   int used = xlog_prefix(args, str, size);
+   // Not shed since the record is only formatted into the caller's buffer
+   if(args != &g_xlog_args_default && xlog_args_below_print(args)) {
+      xlog_stats_suppressed(args->id, args->level);
+      return(0);
+   }
+   int used = xlog_prefix(args, NULL, str, size);
 
    if(used < 0) {
       return(used);
@@ -883,7 +1883,7 @@ int xlog_vsnprintf_dvi(const xlog_args_t *args, char *str, size_t size, const ch
       return(used);
    }
 
-   int rc = vsnprintf(&str[used], size - used, format, ap);
+   int rc = xlog_vformat(&str[used], size - used, format, ap);
 
    if(rc < 0) {
       return(rc);
@@ -902,3 +1902,366 @@ int xlog_vsnprintf_dvi(const xlog_args_t *args, char *str, size_t size, const ch
 
    return(used);
 }
+
+int xlog_kv_write(const xlog_args_t *args, FILE *stream, const char *event, const xlog_kv_t *kvs, uint32_t kv_qty) {
+   if(args == NULL) {
+      args = &g_xlog_args_default;
+   } else if(!xlog_args_enabled(args)) {
+      xlog_stats_suppressed(args->id, args->level);
+      return(0);
+   }
+   if(event == NULL || (kvs == NULL && kv_qty > 0)) {
+      XLOGD_WARN("invalid params");
+      return(-1);
+   }
+   if(stream == NULL) {
+      XLOGD_WARN("NULL stream");
+      return(-1);
+   }
+   char             buffer[XLOG_STACK_BUF_SIZE];
+   bool             truncated = false;
+   xlog_kv_record_t kv        = { .iovcnt = { 0 } };
+
+   if(args != &g_xlog_args_default && xlog_args_record_only(args)) {
+      size_t used = xlog_kv_text(buffer, sizeof(buffer), event, kvs, kv_qty, &truncated);
+      xlog_recorder_write(args, buffer, used);
+      xlog_args_skipped(args);
+      return(0);
+   }
+
+   // The record is encoded in the format of the output stream first.  The other formats used by sinks follow it in the
+   // buffer so each format is only encoded once.
+   xlog_kv_format_t format  = g_xlog_kv_format;
+   uint32_t         formats = (g_xlog_sink_qty > 0) ? xlog_sink_kv_formats(args) : 0;
+   int              iovcnt  = xlog_kv_encode(args, format, buffer, sizeof(buffer), event, kvs, kv_qty, kv.iov[format], &truncated);
+
+   if(iovcnt <= 0) {
+      return(iovcnt);
+   }
+   kv.iovcnt[format] = iovcnt;
+   if(g_xlog_recorder_level < XLOG_LEVEL_INVALID) { // The body or the JSON object without the newline
+      const struct iovec *body = &kv.iov[format][(iovcnt == 3) ? 1 : 0];
+      xlog_recorder_write(args, body->iov_base, body->iov_len - ((iovcnt == 3) ? 0 : 1));
+   }
+   size_t used = 0;
+   for(int index = 0; index < iovcnt; index++) {
+      used += kv.iov[format][index].iov_len;
+   }
+   for(uint32_t other = XLOG_KV_FORMAT_TEXT; other < XLOG_KV_FORMAT_QTY; other++) {
+      if(other == (uint32_t)format || !(formats & (1u << other)) || sizeof(buffer) - used <= XLOG_PREFIX_BUF_SIZE + XLOG_POSTFIX_SIZE) {
+         continue;
+      }
+      int rc = xlog_kv_encode(args, (xlog_kv_format_t)other, &buffer[used], sizeof(buffer) - used, event, kvs, kv_qty, kv.iov[other], &truncated);
+      if(rc > 0) {
+         kv.iovcnt[other] = rc;
+         for(int index = 0; index < rc; index++) {
+            used += kv.iov[other][index].iov_len;
+         }
+      }
+   }
+   if(truncated) {
+      xlog_stats_truncated(args->id, false);
+   }
+   return(xlog_emitv_kv(args, stream, -1, kv.iov[format], iovcnt, (formats != 0) ? &kv : NULL));
+}
+
+int xlog_kv_encode(const xlog_args_t *args, xlog_kv_format_t format, char *buffer, size_t size, const char *event, const xlog_kv_t *kvs, uint32_t kv_qty, struct iovec *iov, bool *truncated) {
+   // Returns the quantity of vectors (0 for an empty record)
+   bool   full = false;
+   size_t used;
+   if(format == XLOG_KV_FORMAT_JSON) {
+      used = xlog_kv_json(args, NULL, buffer, size, event, kvs, kv_qty, &full);
+      iov[0].iov_base = buffer;
+      iov[0].iov_len  = used;
+      *truncated     |= full;
+      return((used == 0) ? 0 : 1);
+   }
+   // The prefix cache allocates memory so it isn't used here
+   int rc = xlog_prefix_build(args, NULL, buffer, size, &g_xlog_context, false, NULL);
+   if(rc < 0) {
+      return(rc);
+   }
+   size_t body = rc;
+   used = body + xlog_kv_text(&buffer[body], size - body - 1, event, kvs, kv_qty, &full);
+   *truncated |= full;
+
+   rc = xlog_postfix(args, &buffer[used], size - used);
+   if(rc < 0) {
+      return(rc);
+   }
+   // Keep the prefix and postfix apart so that sinks can change the options
+   iov[0].iov_base = buffer;
+   iov[0].iov_len  = body;
+   iov[1].iov_base = &buffer[body];
+   iov[1].iov_len  = used - body;
+   iov[2].iov_base = &buffer[used];
+   iov[2].iov_len  = rc;
+   return(3);
+}
+
+int xlog_hexdump_write(const xlog_args_t *args, FILE *stream, const void *buf, size_t len, uint32_t flags) {
+   if(args == NULL) {
+      args = &g_xlog_args_default;
+   } else if(!xlog_args_enabled(args)) {
+      xlog_stats_suppressed(args->id, args->level);
+      return(0);
+   }
+   if(buf == NULL && len > 0) {
+      XLOGD_WARN("invalid params");
+      return(-1);
+   }
+   if(stream == NULL) {
+      XLOGD_WARN("NULL stream");
+      return(-1);
+   }
+   const uint8_t *data        = (const uint8_t *)buf;
+   uint32_t       width       = xlog_hexdump_width(flags);
+   bool           record_only = (args != &g_xlog_args_default && xlog_args_record_only(args));
+   char           prefix[XLOG_PREFIX_BUF_SIZE];
+   char           line[XLOG_HEXDUMP_LINE_SIZE_MAX];
+   char           postfix[XLOG_POSTFIX_SIZE];
+   struct iovec   iov[3];
+   int            total = 0;
+
+   if(record_only) {
+      xlog_args_skipped(args);
+   } else {
+      // The prefix and postfix are built once and shared by all of the lines
+      int rc = xlog_prefix(args, NULL, prefix, sizeof(prefix));
+      if(rc < 0) {
+         return(rc);
+      }
+      iov[0].iov_base = prefix;
+      iov[0].iov_len  = rc;
+
+      rc = xlog_postfix(args, postfix, sizeof(postfix));
+      if(rc < 0) {
+         return(rc);
+      }
+      iov[2].iov_base = postfix;
+      iov[2].iov_len  = rc;
+   }
+   iov[1].iov_base = line;
+
+   for(size_t offset = 0; offset < len; offset += width) {
+      size_t qty  = (len - offset < width) ? len - offset : width;
+      size_t used = xlog_hexdump_line(line, &data[offset], qty, offset, width, flags);
+
+      if(g_xlog_recorder_level < XLOG_LEVEL_INVALID && args != &g_xlog_args_default) {
+         xlog_recorder_write(args, line, used);
+      }
+      if(record_only) {
+         continue;
+      }
+      iov[1].iov_len = used;
+
+      int rc = xlog_emitv(args, stream, -1, iov, 3);
+      if(rc < 0) {
+         return(rc);
+      }
+      total += rc;
+   }
+   return(total);
+}
+
+int xlog_binary(const xlog_args_t *args, const char *format, va_list ap) {
+   // Use a copy of the arguments so the text output can still be used if the record can't be written in binary
+   va_list aq;
+   va_copy(aq, ap);
+   int rc = xlog_binary_write(args, format, aq);
+   va_end(aq);
+   return(rc);
+}
+
+int xlog_emitv(const xlog_args_t *args, FILE *stream, int fd, const struct iovec *iov, int iovcnt) {
+   return(xlog_emitv_kv(args, stream, fd, iov, iovcnt, NULL));
+}
+
+int xlog_emitv_kv(const xlog_args_t *args, FILE *stream, int fd, const struct iovec *iov, int iovcnt, const xlog_kv_record_t *kv) {
+   // kv holds the other encodings of a key/value record for the sinks which use a different format
+   if(g_xlog_shed_pending) { // Shedding started or stopped during a previous write
+      xlog_shed_report();
+   }
+   if((args->options & XLOG_OPTS_MONO) && xlog_time_anchor_due()) {
+      xlog_time_anchor(args, stream, fd);
+   }
+   // The compressed file replaces the output stream unless tee is set.  The other sinks are still written.
+   bool output = true;
+   int  rc     = 0;
+   if(g_xlog_zfile && !g_xlog_zfile_compressor_thread) {
+      rc = xlog_zfile_write(iov, iovcnt);
+      if(args->level == XLOG_LEVEL_FATAL) {
+         xlog_zfile_flush();
+      }
+      output = g_xlog_zfile_tee;
+   }
+   if(g_xlog_async && args->level == XLOG_LEVEL_FATAL) {
+      // FATAL bypasses the rings.  Let the writer drain them first so the preceding records are not lost.
+      xlog_async_flush();
+   }
+   if(g_xlog_sink_qty > 0) {
+      int rc_sinks = xlog_sink_emitv(args, stream, fd, iov, iovcnt, output, kv);
+      if(output || rc_sinks < 0) {
+         rc = rc_sinks;
+      }
+   } else if(output) {
+      rc = xlog_deliverv(args, stream, fd, iov, iovcnt);
+   }
+   xlog_stats_output(args, rc, false);
+
+   if(args->level == XLOG_LEVEL_FATAL && g_xlog_recorder_level < XLOG_LEVEL_INVALID) {
+      xlog_recorder_dump_output(stream, fd);
+   }
+   return(rc);
+}
+
+int xlog_deliverv(const xlog_args_t *args, FILE *stream, int fd, const struct iovec *iov, int iovcnt) {
+   if(g_xlog_async && args->level < XLOG_LEVEL_FATAL) {
+      return(xlog_async_enqueue(args, stream, fd, iov, iovcnt));
+   }
+   if(!g_xlog_shed) {
+      return(xlog_outputv(args->level, stream, fd, iov, iovcnt));
+   }
+   uint64_t begin = xlog_shed_write_begin();
+   int      rc    = xlog_outputv(args->level, stream, fd, iov, iovcnt);
+   xlog_shed_write_end(begin);
+   return(rc);
+}
+
+void xlog_args_skipped(const xlog_args_t *args) {
+   // Records at or above the print level were shed
+   if(xlog_args_below_print(args)) {
+      xlog_stats_suppressed(args->id, args->level);
+   } else {
+      xlog_shed_record(args->id);
+   }
+}
+
+int xlog_frame(const xlog_args_t *args, char *prefix, char *postfix, struct iovec *iov) {
+   // Builds the prefix (iov[0]) and postfix (iov[2]) around a body in iov[1]
+   int rc = xlog_prefix(args, NULL, prefix, XLOG_PREFIX_BUF_SIZE);
+
+   if(rc < 0) {
+      return(rc);
+   }
+   iov[0].iov_base = prefix;
+   iov[0].iov_len  = rc;
+
+   rc = xlog_postfix(args, postfix, XLOG_POSTFIX_SIZE);
+
+   if(rc < 0) {
+      return(rc);
+   }
+   iov[2].iov_base = postfix;
+   iov[2].iov_len  = rc;
+   return(0);
+}
+
+bool xlog_output_user(void) {
+   return(g_xlog_printv != NULL || g_xlog_print != NULL);
+}
+
+int xlog_output(xlog_level_t level, FILE *stream, int fd, const char *buffer, size_t size) {
+   if(stream == NULL) {
+      return(write(fd, buffer, size));
+   }
+   if(g_xlog_printv != NULL) {
+      struct iovec iov = { .iov_base = (void *)buffer, .iov_len = size };
+      return(g_xlog_printv(level, &iov, 1));
+   }
+   if(g_xlog_print != NULL) {
+      return(g_xlog_print(level, buffer, size));
+   }
+   if(fwrite(buffer, 1, size, stream) != size) {
+      return(-1);
+   }
+   return(size);
+}
+
+int xlog_outputv(xlog_level_t level, FILE *stream, int fd, const struct iovec *iov, int iovcnt) {
+   if(stream == NULL) {
+      return(writev(fd, iov, iovcnt));
+   }
+   if(g_xlog_printv != NULL) {
+      return(g_xlog_printv(level, iov, iovcnt));
+   }
+   if(g_xlog_print != NULL) {
+      return(xlog_output_join(g_xlog_print, level, iov, iovcnt, false));
+   }
+   size_t size  = 0;
+   bool   error = false;
+   flockfile(stream);
+   for(int index = 0; index < iovcnt && !error; index++) {
+      size_t len = fwrite(iov[index].iov_base, 1, iov[index].iov_len, stream);
+      size += len;
+      error = (len != iov[index].iov_len);
+   }
+   funlockfile(stream);
+   return(error ? -1 : (int)size);
+}
+
+int xlog_output_join(xlog_print_t print, xlog_level_t level, const struct iovec *iov, int iovcnt, bool safe) {
+   // Callbacks which take a single buffer need the record to be copied.  Not inlined so that the buffer is only on the
+   // stack when one of these callbacks is used.  The copy is NUL terminated like the records of the previous versions so
+   // callbacks can use it as a string.
+   char   buffer[XLOG_STACK_BUF_SIZE + 1];
+   char * str  = buffer;
+   size_t size = 0;
+   size_t used = 0;
+
+   for(int index = 0; index < iovcnt; index++) {
+      size += iov[index].iov_len;
+   }
+   if(size >= sizeof(buffer)) {
+      str = safe ? NULL : (char *)malloc(size + 1);
+      if(str == NULL) { // Truncated
+         str  = buffer;
+         size = sizeof(buffer) - 1;
+      }
+   }
+   for(int index = 0; index < iovcnt && used < size; index++) {
+      size_t len = (iov[index].iov_len < size - used) ? iov[index].iov_len : size - used;
+      memcpy(&str[used], iov[index].iov_base, len);
+      used += len;
+   }
+   str[used] = '\0';
+
+   int rc = print(level, str, used);
+
+   if(str != buffer) {
+      free(str);
+   }
+   return(rc);
+}
+
+int xlog_format_record(const xlog_args_t *args, const struct timeval *tv, char *str, size_t size, const char *body, size_t body_len) {
+   // Produces the same output as xlog_vfprintf_dvi for a body which has already been formatted
+   int rc = xlog_prefix(args, tv, str, size);
+
+   if(rc < 0) {
+      return(rc);
+   }
+   size_t used = rc;
+
+   if(used >= size) {
+      return(size);
+   }
+   rc = snprintf(&str[used], size - used, "%.*s", (int)body_len, body);
+
+   if(rc < 0) {
+      return(rc);
+   }
+   used += rc;
+
+   if(used >= size) {
+      return(size);
+   }
+   rc = xlog_postfix(args, &str[used], size - used);
+
+   if(rc < 0) {
+      return(rc);
+   }
+   used += rc;
+
+   return((used > size) ? size : used);
+}
@@ -25,6 +25,7 @@
 #include <stdarg.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <sys/uio.h>
 #include "rdkx_logger_modules.h"
 
 // Value to disable each parameter in the output
@@ -47,6 +48,19 @@
 #error Please define XLOG_MODULE_ID with the appropriate definition from rdkx_logger_modules.h and add name to rdkx_logger.json as needed.
 #endif
 
+// Modules which are not in rdkx_logger.json (ie. plugins loaded at run-time) get an id from xlog_module_register().  Define
+// XLOG_MODULE_DYNAMIC and define XLOG_MODULE_ID as the variable holding the id.  The arguments of the macros can't be
+// static in this case so XLOG_OPTIMIZE_SPEED has no effect and the call site registry is not supported.
+#if defined(XLOG_MODULE_DYNAMIC) && defined(XLOG_SITE_REGISTRY)
+#error XLOG_SITE_REGISTRY is not supported with XLOG_MODULE_DYNAMIC
+#endif
+
+// Dynamic module ids follow XLOG_MODULE_ID_INVALID so their levels are in the same array as the generated modules
+#define XLOG_MODULE_DYNAMIC_QTY_MAX  (32)
+#define XLOG_MODULE_ID_DYNAMIC_FIRST (XLOG_MODULE_QTY_MAX + 1)
+#define XLOG_MODULE_SLOT_QTY         (XLOG_MODULE_ID_DYNAMIC_FIRST + XLOG_MODULE_DYNAMIC_QTY_MAX)
+#define XLOG_MODULE_NAME_SIZE_MAX    (32)
+
 // Default static log level setting
 #ifndef XLOG_LEVEL
 #define XLOG_LEVEL XLOG_PP_LEVEL_INFO
@@ -74,14 +88,26 @@
 #endif
 
 // XLOG options
-#define XLOG_OPTS_NONE      (0)
-#define XLOG_OPTS_GMT       (1)
-#define XLOG_OPTS_DATE      (1 << 1)
-#define XLOG_OPTS_TIME      (1 << 2)
-#define XLOG_OPTS_LF        (1 << 3)
-#define XLOG_OPTS_MOD_NAME  (1 << 4)
-#define XLOG_OPTS_LEVEL     (1 << 5)
-#define XLOG_OPTS_COLOR     (1 << 6)
+#define XLOG_OPTS_NONE       (0)
+#define XLOG_OPTS_GMT        (1)
+#define XLOG_OPTS_DATE       (1 << 1)
+#define XLOG_OPTS_TIME       (1 << 2)
+#define XLOG_OPTS_LF         (1 << 3)
+#define XLOG_OPTS_MOD_NAME   (1 << 4)
+#define XLOG_OPTS_LEVEL      (1 << 5)
+#define XLOG_OPTS_COLOR      (1 << 6)
+#define XLOG_OPTS_TID        (1 << 7)   // Thread id (ie. [1234])
+#define XLOG_OPTS_TNAME      (1 << 8)   // Thread name (ie. [worker] or [1234:worker] with XLOG_OPTS_TID)
+#define XLOG_OPTS_MONO       (1 << 9)   // Monotonic seconds since boot instead of the date and time (ie. 12345.678)
+#define XLOG_OPTS_MONO_START (1 << 10)  // With XLOG_OPTS_MONO, seconds since the library was loaded instead of since boot
+#define XLOG_OPTS_USEC       (1 << 11)  // Microsecond resolution
+#define XLOG_OPTS_NSEC       (1 << 12)  // Nanosecond resolution
+#define XLOG_OPTS_COARSE     (1 << 13)  // Read the time from the coarse clock (resolution of the scheduler tick at a lower cost)
+#define XLOG_OPTS_SITE       (1u << 31) // Internal use only.  The arguments are part of an xlog_site_t.
+
+// The time options change the date and time field, which is printed when XLOG_OPTS_DATE or XLOG_OPTS_TIME is set.  Records
+// with XLOG_OPTS_MONO are preceded periodically by a "time anchor" record holding the monotonic and wall clock time read
+// together, so the monotonic times can be converted to wall clock time offline.
 
 // define XLOG_OPTS_DEFAULT to control the default options
 #ifndef XLOG_OPTS_DEFAULT
@@ -89,12 +115,19 @@
 #endif
 
 // Log arguments can be made static for a run-time speedup, but this increases the size...
-#ifdef XLOG_OPTIMIZE_SPEED
+#if defined(XLOG_OPTIMIZE_SPEED) && !defined(XLOG_MODULE_DYNAMIC)
 #define XLOG_STATIC_ARGS static
 #else
 #define XLOG_STATIC_ARGS
 #endif
 
+// The arguments of the rate limited macros are static unless the module id is dynamic
+#ifdef XLOG_MODULE_DYNAMIC
+#define XLOG_RL_STATIC_ARGS
+#else
+#define XLOG_RL_STATIC_ARGS static
+#endif
+
 // Definitions to allow the preprocessor comparisons below
 #define XLOG_PP_LEVEL_ALL     0
 #define XLOG_PP_LEVEL_DEBUG   1
@@ -124,6 +157,188 @@ typedef struct {
 } xlog_args_t;
 
 typedef int (*xlog_print_t)(xlog_level_t level, const char *buffer, uint32_t size);
+typedef int (*xlog_printv_t)(xlog_level_t level, const struct iovec *iov, int iovcnt); // Prefix, body and postfix of one record
+
+typedef enum {
+   XLOG_ASYNC_FULL_DROP  = 0, // Drop the record when the calling thread's ring is full
+   XLOG_ASYNC_FULL_BLOCK = 1  // Block the calling thread until the writer frees space in the ring
+} xlog_async_full_t;
+
+typedef struct {
+   uint32_t          ring_size; // Size in bytes of each thread's ring (rounded up to a power of 2, 0 for default)
+   xlog_async_full_t full;      // Action to take when a thread's ring is full
+} xlog_async_params_t;
+
+typedef struct {
+   uint64_t records; // Records written by the writer thread
+   uint64_t dropped; // Records dropped due to a full ring
+   uint64_t blocked; // Records which blocked the caller due to a full ring
+   uint32_t rings;   // Quantity of thread rings currently registered
+} xlog_async_stats_t;
+
+// Per call site token bucket used by the XLOG_RL macros.  Up to burst records are printed, after which tokens are returned
+// to the bucket at a rate of burst per period.
+typedef struct {
+   uint32_t          burst;      // Maximum quantity of records printed back to back
+   uint32_t          period;     // Time in ms to refill the bucket completely
+   volatile int32_t  tokens;     // Tokens remaining.  Negative values count the records suppressed since the bucket emptied.
+   volatile uint32_t suppressed; // Records suppressed which have not been reported yet
+   volatile uint32_t refill;     // Time in ms of the last refill (coarse monotonic clock)
+} xlog_rate_limit_t;
+
+// Call site descriptor placed in the xlog_sites section when XLOG_SITE_REGISTRY is defined.  The size is a multiple of 8
+// so the section can be walked as an array.
+typedef struct {
+   xlog_args_t       args;     // Arguments passed to the library (must be first)
+   const char *      file;     // Source file name
+   const char *      function; // Function name (even if it is not printed)
+   uint32_t          line;     // Line number (even if it is not printed)
+   volatile uint32_t flags;    // XLOG_SITE_FLAG_ values set by xlog_site_set
+} xlog_site_t;
+
+#define XLOG_SITE_FLAG_ON  (1) // Printed regardless of the module's level
+#define XLOG_SITE_FLAG_OFF (2) // Never printed
+
+typedef enum {
+   XLOG_SITE_DEFAULT = 0, // Follow the module's level
+   XLOG_SITE_ENABLE  = XLOG_SITE_FLAG_ON,
+   XLOG_SITE_DISABLE = XLOG_SITE_FLAG_OFF
+} xlog_site_state_t;
+
+// Selects call sites.  All of the members which are set must match.
+typedef struct {
+   const char *module;   // Module name glob or NULL for any
+   const char *function; // Function name glob or NULL for any
+   const char *file;     // File name glob (matched against the base name unless it contains '/') or NULL for any
+   uint32_t    line_min; // First line or 0 for any
+   uint32_t    line_max; // Last line or 0 for any
+} xlog_site_filter_t;
+
+typedef void (*xlog_site_callback_t)(const xlog_site_t *site, void *data);
+
+typedef enum {
+   XLOG_KV_FORMAT_DEFAULT = 0, // Format set by xlog_kv_format_set (only for sinks)
+   XLOG_KV_FORMAT_TEXT    = 1, // Same prefix as the other records followed by "event key=value key=value"
+   XLOG_KV_FORMAT_JSON    = 2  // One JSON object per line with the module, level, function and line as fields
+} xlog_kv_format_t;
+
+typedef enum {
+   XLOG_KV_TYPE_INT  = 0,
+   XLOG_KV_TYPE_UINT = 1,
+   XLOG_KV_TYPE_HEX  = 2,
+   XLOG_KV_TYPE_BOOL = 3,
+   XLOG_KV_TYPE_STR  = 4
+} xlog_kv_type_t;
+
+typedef struct {
+   const char *   key;
+   xlog_kv_type_t type;
+   union {
+      int64_t      i;
+      uint64_t     u;
+      const char * s;
+   } value;
+} xlog_kv_t;
+
+#define XLOG_KV_I32(KEY, VALUE)  { .key = KEY, .type = XLOG_KV_TYPE_INT,  .value = { .i = (int32_t)(VALUE) } }
+#define XLOG_KV_I64(KEY, VALUE)  { .key = KEY, .type = XLOG_KV_TYPE_INT,  .value = { .i = (int64_t)(VALUE) } }
+#define XLOG_KV_U32(KEY, VALUE)  { .key = KEY, .type = XLOG_KV_TYPE_UINT, .value = { .u = (uint32_t)(VALUE) } }
+#define XLOG_KV_U64(KEY, VALUE)  { .key = KEY, .type = XLOG_KV_TYPE_UINT, .value = { .u = (uint64_t)(VALUE) } }
+#define XLOG_KV_HEX(KEY, VALUE)  { .key = KEY, .type = XLOG_KV_TYPE_HEX,  .value = { .u = (uint64_t)(VALUE) } }
+#define XLOG_KV_BOOL(KEY, VALUE) { .key = KEY, .type = XLOG_KV_TYPE_BOOL, .value = { .u = (VALUE) ? 1 : 0 } }
+#define XLOG_KV_STR(KEY, VALUE)  { .key = KEY, .type = XLOG_KV_TYPE_STR,  .value = { .s = (VALUE) } }
+
+// Typed arguments of xlog_write_args (built by rdkx_logger.hpp)
+typedef enum {
+   XLOG_ARG_TYPE_INT    = 0, // Signed integer, character or enumeration (%d %i %u %x %X %c and * width or precision)
+   XLOG_ARG_TYPE_UINT   = 1, // Unsigned integer or bool (same conversions as XLOG_ARG_TYPE_INT)
+   XLOG_ARG_TYPE_DOUBLE = 2, // Floating point (%f %F %e %E %g %G %a %A)
+   XLOG_ARG_TYPE_STR    = 3, // String (%s)
+   XLOG_ARG_TYPE_PTR    = 4  // Pointer (%p)
+} xlog_arg_type_t;
+
+typedef struct {
+   uint8_t type;    // xlog_arg_type_t
+   uint8_t size;    // Size in bytes of the integer's type
+   union {
+      uint64_t     u; // Integers are stored sign extended
+      double       d;
+      const char * s;
+      const void * p;
+   } value;
+} xlog_arg_t;
+
+// Hex dump flags
+#define XLOG_HEXDUMP_OFFSET (1)      // Print the offset of the first byte at the start of each line
+#define XLOG_HEXDUMP_ASCII  (1 << 1) // Print the printable characters after the bytes
+#define XLOG_HEXDUMP_LOWER  (1 << 2) // Use lower case hex digits
+#define XLOG_HEXDUMP_WIDTH(BYTES) (((uint32_t)(BYTES) & 0xFF) << 8) // Bytes per line (default 16, maximum 32)
+
+#define XLOG_HEXDUMP_DEFAULT (XLOG_HEXDUMP_OFFSET | XLOG_HEXDUMP_ASCII)
+
+typedef enum {
+   XLOG_ZFILE_CODEC_DEFAULT = 0, // zlib if the library is built with --enable-zlib, otherwise LZ
+   XLOG_ZFILE_CODEC_LZ      = 1, // Fast LZ4 block format compressor built into the library
+   XLOG_ZFILE_CODEC_ZLIB    = 2  // Higher ratio but slower (requires --enable-zlib)
+} xlog_zfile_codec_t;
+
+typedef struct {
+   const char *       filename;      // Path of the compressed log file
+   uint32_t           file_size_max; // Size in bytes at which the file is rotated (0 for no limit)
+   uint32_t           file_qty;      // Quantity of rotated files kept as FILE.1 to FILE.n (0 for default of 1)
+   uint32_t           block_size;    // Uncompressed size of each block (0 for default of 64 KB)
+   uint32_t           flush_period;  // Time in ms after which a partial block is written (0 for default of 10 s)
+   xlog_zfile_codec_t codec;
+   bool               tee;           // Also write the records to the output stream
+} xlog_zfile_params_t;
+
+#define XLOG_LEVEL_MASK(LEVEL)     (1u << (LEVEL))
+#define XLOG_LEVEL_MASK_MIN(LEVEL) (XLOG_LEVEL_MASK(XLOG_LEVEL_FATAL + 1) - XLOG_LEVEL_MASK(LEVEL)) // LEVEL to FATAL
+#define XLOG_LEVEL_MASK_ALL        (0xFFFFFFFF)
+
+#define XLOG_SINK_QTY_MAX (8)
+
+typedef enum {
+   XLOG_SINK_TYPE_DEFAULT = 0, // Stream or fd passed by the caller (ie. XLOGD_OUTPUT) or the user print callback
+   XLOG_SINK_TYPE_FD      = 1, // File descriptor owned by the caller (ie. STDERR_FILENO)
+   XLOG_SINK_TYPE_FILE    = 2, // File opened for appending by the library
+   XLOG_SINK_TYPE_SOCKET  = 3  // Unix domain socket of a log collector.  Records are sent in batches by a dedicated thread.
+} xlog_sink_type_t;
+
+typedef struct {
+   xlog_sink_type_t type;
+   int              fd;            // XLOG_SINK_TYPE_FD
+   const char *     filename;      // XLOG_SINK_TYPE_FILE or the path of the XLOG_SINK_TYPE_SOCKET
+   xlog_module_id_t id;            // Module routed to the sink (XLOG_MODULE_ID_INVALID for all modules)
+   uint32_t         level_mask;    // Levels routed to the sink (XLOG_LEVEL_MASK_ macros, 0 for all levels)
+   uint32_t         options_clear; // XLOG_OPTS_ options removed from the records (ie. XLOG_OPTS_COLOR for a file)
+   uint32_t         options_set;   // XLOG_OPTS_ options added to the records
+   xlog_kv_format_t kv_format;     // Format of the xlog_kv records (XLOG_KV_FORMAT_DEFAULT for the format set by xlog_kv_format_set)
+   // XLOG_SINK_TYPE_SOCKET
+   bool             datagram;      // Use SOCK_DGRAM instead of SOCK_SEQPACKET
+   uint32_t         batch_size;    // Maximum size of each message (0 for default of 16 KB)
+   uint32_t         flush_period;  // Time in ms after which a partial batch is sent (0 for default of 100 ms)
+   uint32_t         buffer_size;   // Bytes buffered while the collector is unavailable (0 for default of 256 KB)
+} xlog_sink_params_t;
+
+// Logging statistics for one module (or all modules).  The arrays are indexed by level.
+typedef struct {
+   uint64_t emitted[XLOG_LEVEL_INVALID + 1];    // Records written (or queued in asynchronous mode)
+   uint64_t suppressed[XLOG_LEVEL_INVALID + 1]; // Records not written due to the level (see XLOG_STATS_SUPPRESSED)
+   uint64_t bytes[XLOG_LEVEL_INVALID + 1];      // Bytes written including the prefix and postfix
+   uint64_t truncated;                          // Records which were truncated
+   uint64_t errors;                             // Records which could not be written to the output
+   uint64_t shed;                               // Records not printed due to the write latency (see xlog_shed_start)
+} xlog_stats_t;
+
+typedef struct {
+   uint32_t     budget;  // Average write latency in us at which records are shed
+   uint32_t     recover; // Write latency in us under which the output is considered recovered (0 for half of the budget)
+   uint32_t     hold;    // Time in ms without a write over the recovery latency before records are printed again (0 for 1000 ms)
+   xlog_level_t level;   // Records below this level are shed (ie. XLOG_LEVEL_WARN keeps WARN, ERROR and FATAL)
+} xlog_shed_params_t;
+
+#define XLOG_RATE_LIMIT_INIT(BURST, PERIOD) { .burst = BURST, .period = PERIOD, .tokens = BURST, .suppressed = 0, .refill = 0 }
 
 // Internal use only.  This is required to avoid parameter expansion when using XLOGD macros below.
 extern xlog_level_t  g_xlog_modules[];
@@ -134,12 +349,30 @@ extern "C" {
 
 int          xlog_init(xlog_module_id_t id, const char *filename, uint32_t file_size_max);
 int          xlog_init_user_print(xlog_module_id_t id, xlog_print_t print, xlog_print_t print_safe);
+int          xlog_init_user_printv(xlog_module_id_t id, xlog_printv_t printv, xlog_printv_t printv_safe);
+int          xlog_init_async(xlog_module_id_t id, const char *filename, uint32_t file_size_max, const xlog_async_params_t *params);
 void         xlog_term(void);
 xlog_level_t xlog_level_get(xlog_module_id_t id);
 void         xlog_level_set(xlog_module_id_t id, xlog_level_t level);
 void         xlog_level_set_all(xlog_level_t level);
 bool         xlog_level_active(xlog_module_id_t id, xlog_level_t level);
 
+// Renames the calling thread and updates the name printed by XLOG_OPTS_TNAME.  A thread renamed by other means is
+// detected after a few hundred of its records.
+void xlog_thread_name_set(const char *name);
+
+// Context tags - a tag pushed by a thread (ie. xlog_context_push("sess=%u", id)) is printed in the prefix of each of the
+// thread's records before the separator (ie. "XRSR func(12) [sess=1234] : ").  Pushed tags are printed together.  The
+// tag is formatted once when pushed.  Returns -1 if the tag is too long or too many tags are pushed.
+int  xlog_context_push(const char *format, ...) __attribute__((format(printf, 1, 2)));
+void xlog_context_pop(void);
+void xlog_context_clear(void);
+
+// Dynamic modules - returns the id of the module, registering it if needed, or XLOG_MODULE_ID_INVALID when the table is
+// full.  The level is set from the configuration file like the generated modules.  Ids stay valid until the process exits.
+xlog_module_id_t xlog_module_register(const char *name);
+const char *     xlog_module_name(xlog_module_id_t id);
+
 // Asynchronous safe - can be used in signal handlers
 int xlog_printf_safe(const xlog_args_t *args, const char *string);
 int xlog_fprintf_safe(const xlog_args_t *args, FILE *stream, const char *string);
@@ -149,20 +382,135 @@ int xlog_fprintf(const xlog_args_t *args, FILE *stream, const char *format, ...)
 int xlog_dprintf(const xlog_args_t *args, int fd, const char *format, ...);
 int xlog_snprintf(const xlog_args_t *args, char *str, size_t size, const char *format, ...);
 
+// Typed arguments - the arguments are read from an array instead of a va_list and formatted without vsnprintf or memory
+// allocation (floating point values use snprintf).  Returns -1 if a conversion is not supported or does not match its
+// argument.  Records longer than the stack buffer are truncated.  Binary mode is not used for these records.
+int xlog_write_args(const xlog_args_t *args, FILE *stream, const char *format, const xlog_arg_t *argv, uint32_t argc);
+
+// Structured logging - the key/value pairs are encoded without allocating memory or calling vsnprintf.  String values are
+// escaped in JSON format.  Use the xlog_kv macro to pass the pairs (ie. xlog_kv(&args, "event", XLOG_KV_U32("rssi", rssi))).
+int  xlog_kv_write(const xlog_args_t *args, FILE *stream, const char *event, const xlog_kv_t *kvs, uint32_t kv_qty);
+void xlog_kv_format_set(xlog_kv_format_t format);
+
+// Compressed file - records are compressed in blocks by a dedicated thread and written to the file instead of the output
+// stream (unless tee is set).  Sinks other than XLOG_SINK_TYPE_DEFAULT are still written.  Any existing file is rotated
+// when opened.  Use xlog-zcat to read the files.
+int  xlog_zfile_open(const xlog_zfile_params_t *params);
+void xlog_zfile_close(void);
+void xlog_zfile_flush(void);
+
+// Sinks - once a sink is added, each record is formatted once and written to every sink which matches its module and
+// level instead of the output stream.  Add a XLOG_SINK_TYPE_DEFAULT sink to keep writing to the output stream.  Records
+// written by the asynchronous safe functions only go to the output stream.
+int  xlog_sink_add(const xlog_sink_params_t *params);
+void xlog_sink_remove(int sink);
+void xlog_sink_remove_all(void);
+
+// Statistics - counted per thread and summed when read.  Use XLOG_MODULE_ID_INVALID to get the totals of all modules.
+// The summary prints the activity of each period at INFO level of the XLOG module.
+int  xlog_stats_get(xlog_module_id_t id, xlog_stats_t *stats);
+int  xlog_stats_summary_start(uint32_t period);
+void xlog_stats_summary_stop(void);
+void xlog_stats_suppressed(xlog_module_id_t id, xlog_level_t level);
+
+// Hex dump - each line of the dump is a record with the same prefix.  Use XLOG_HEXDUMP_ flags to select the layout.
+int  xlog_hexdump_write(const xlog_args_t *args, FILE *stream, const void *buf, size_t len, uint32_t flags);
+
 #define xlog_vprintf(args, format, ap) xlog_vfprintf(args, stdout, format, ap)
 int xlog_vfprintf(const xlog_args_t *args, FILE *stream, const char *format, va_list ap);
 int xlog_vdprintf(const xlog_args_t *args, int fd, const char *format, va_list ap);
 int xlog_vsnprintf(const xlog_args_t *args, char *str, size_t size, const char *format, va_list ap);
 
+// Asynchronous mode - records are queued per thread and written by a dedicated writer thread (FATAL is always written synchronously)
+void xlog_async_flush(void);
+void xlog_async_stats_get(xlog_async_stats_t *stats);
+
+// Binary mode - records for the selected generated modules are written to a binary file without formatting (use xlog-decode to read)
+int  xlog_binary_open(const char *filename);
+void xlog_binary_close(void);
+void xlog_binary_module_set(xlog_module_id_t id, bool enable);
+
+// Configuration watcher - reloads the levels when the rdkx_logger json configuration files are changed
+int  xlog_config_watch_start(void);
+void xlog_config_watch_stop(void);
+
+// Shared memory levels - levels set in the shared memory segment (ie. xlog-level set MODULE LEVEL) are applied to this process
+int  xlog_shm_attach(void);
+void xlog_shm_detach(void);
+
+// Flight recorder - records down to the record level (even those below the print level) are kept in a ring of fixed size
+// slots in a memory mapped file.  The ring is dumped on FATAL and can be dumped from a signal handler with
+// xlog_recorder_dump.  An existing file is renamed to FILE.prev when opened.  Use xlog-recorder to read the file post-mortem.
+int  xlog_recorder_open(const char *filename, uint32_t size, xlog_level_t level);
+void xlog_recorder_close(void);
+int  xlog_recorder_dump(FILE *stream);
+
+// Call site registry - sites compiled with XLOG_SITE_REGISTRY defined can be enabled or disabled individually
+int  xlog_site_set(const xlog_site_filter_t *filter, xlog_site_state_t state);
+int  xlog_site_foreach(const xlog_site_filter_t *filter, xlog_site_callback_t callback, void *data);
+
+// Collapse mode - identical consecutive records from the same call site are printed once, followed by a "last message
+// repeated N times" record when a different record is printed (or the mode is disabled)
+void xlog_collapse_set(bool enable);
+
+// Shedding - the latency of the synchronous writes to the output is measured.  When the average reaches the budget, the
+// records of every module below the shed level are no longer printed until the writes recover.  The module levels are not
+// changed.  Records shed are counted in the statistics and the total is reported when printing resumes.
+int  xlog_shed_start(const xlog_shed_params_t *params);
+void xlog_shed_stop(void);
+
+// Internal use only.  Called by the XLOG_SITE_REGISTRY constructor and by the XLOG_RL macros.
+void xlog_site_register(xlog_site_t *start, xlog_site_t *stop);
+void xlog_site_unregister(xlog_site_t *start);
+bool xlog_rate_limit_refill(xlog_rate_limit_t *rl);
+void xlog_rate_limit_report(const xlog_args_t *args, xlog_rate_limit_t *rl, FILE *stream);
+
 #ifdef __cplusplus
 }
 #endif
 
+// The suppressed path costs the level check, one atomic decrement and a read of the coarse monotonic clock (no system call).
+// Nothing is formatted.
+static __inline bool xlog_rate_limit_pass(xlog_rate_limit_t *rl) {
+   if(__atomic_sub_fetch(&rl->tokens, 1, __ATOMIC_RELAXED) >= 0) {
+      return(true);
+   }
+   return(xlog_rate_limit_refill(rl));
+}
+
 // Unformatted logging
 #define XLOG_RAW(...)            fprintf(XLOGD_OUTPUT, __VA_ARGS__)
 
+// define XLOG_STATS_SUPPRESSED to count the records suppressed by the level check in the macros.  This adds a call to
+// each disabled call site.  Otherwise only the records suppressed by the library are counted.
+#ifdef XLOG_STATS_SUPPRESSED
+#define XLOG_SUPPRESSED(LEVEL) xlog_stats_suppressed(XLOG_MODULE_ID, LEVEL)
+#else
+#define XLOG_SUPPRESSED(LEVEL)
+#endif
+
+// Formats and writes the record of the XLOG and XLOG_RL macros.  rdkx_logger.hpp replaces it to check the format at compile time.
+#define XLOG_FPRINTF(LEVEL, ARGS, FORMAT, ...) xlog_fprintf(ARGS, XLOGD_OUTPUT, FORMAT, ##__VA_ARGS__)
+
 // Formatted logging to FILE *
-#define XLOG(LEVEL, OPTS, COLOR, FORMAT, ...) do { if(LEVEL < g_xlog_modules[XLOG_MODULE_ID]) { break; } XLOG_STATIC_ARGS const xlog_args_t xlog_args__ = {.options = OPTS, .color = COLOR, .function = XLOG_PARAM_FUNCTION, .line = XLOG_PARAM_LINE, .level = LEVEL, .id = XLOG_MODULE_ID}; xlog_fprintf(&xlog_args__, XLOGD_OUTPUT, FORMAT, ##__VA_ARGS__);} while(0)
+#ifndef XLOG_SITE_REGISTRY
+#define XLOG(LEVEL, OPTS, COLOR, FORMAT, ...) do { if(LEVEL < g_xlog_modules[XLOG_MODULE_ID]) { XLOG_SUPPRESSED(LEVEL); break; } XLOG_STATIC_ARGS const xlog_args_t xlog_args__ = {.options = OPTS, .color = COLOR, .function = XLOG_PARAM_FUNCTION, .line = XLOG_PARAM_LINE, .level = LEVEL, .id = XLOG_MODULE_ID}; XLOG_FPRINTF(LEVEL, &xlog_args__, FORMAT, ##__VA_ARGS__);} while(0)
+#else
+// Each call site's descriptor is placed in the xlog_sites section.  Sites which have not been set (flags are zero) cost one
+// more load than the module level check, from the descriptor which is also passed to the library.
+#define XLOG(LEVEL, OPTS, COLOR, FORMAT, ...) do { static xlog_site_t xlog_site__ __attribute__((section("xlog_sites"), used, aligned(8))) = {.args = {.options = (OPTS) | XLOG_OPTS_SITE, .color = COLOR, .function = XLOG_PARAM_FUNCTION, .line = XLOG_PARAM_LINE, .level = LEVEL, .id = XLOG_MODULE_ID}, .file = __FILE__, .function = __FUNCTION__, .line = __LINE__, .flags = 0}; if((xlog_site__.flags == 0) ? (LEVEL < g_xlog_modules[XLOG_MODULE_ID]) : !(xlog_site__.flags & XLOG_SITE_FLAG_ON)) { XLOG_SUPPRESSED(LEVEL); break; } XLOG_FPRINTF(LEVEL, &xlog_site__.args, FORMAT, ##__VA_ARGS__);} while(0)
+
+// The linker provides the bounds of the section in each executable and shared object
+extern xlog_site_t __start_xlog_sites[] __attribute__((weak, visibility("hidden")));
+extern xlog_site_t __stop_xlog_sites[]  __attribute__((weak, visibility("hidden")));
+
+__attribute__((constructor, unused)) static void xlog_sites_register__(void) {
+   xlog_site_register(__start_xlog_sites, __stop_xlog_sites);
+}
+__attribute__((destructor, unused)) static void xlog_sites_unregister__(void) {
+   xlog_site_unregister(__start_xlog_sites);
+}
+#endif
 #define XLOG_NO_LF(FORMAT, ...)        XLOG(XLOG_LEVEL_INVALID, (XLOG_OPTS_DEFAULT & ~XLOG_OPTS_LF), XLOG_COLOR_NONE, FORMAT, ##__VA_ARGS__)
 
 // Dynamic log macros
@@ -187,7 +535,44 @@ int xlog_vsnprintf(const xlog_args_t *args, char *str, size_t size, const char *
 #define XLOGD_ERROR_OPTS(OPTS, ...)  XLOGD(XLOG_LEVEL_ERROR,  OPTS, XLOG_COLOR_RED,  __VA_ARGS__)
 #define XLOGD_FATAL_OPTS(OPTS, ...)  do { XLOGD(XLOG_LEVEL_FATAL,  OPTS, XLOG_COLOR_RED, __VA_ARGS__); XLOG_FLUSH(); } while(0)
 
-#define XLOGD_SAFE(LEVEL, OPTS, COLOR, STRING) do { if(LEVEL < g_xlog_modules[XLOG_MODULE_ID]) { break; } XLOG_STATIC_ARGS const xlog_args_t xlog_args__ = {.options = OPTS, .color = COLOR, .function = XLOG_PARAM_FUNCTION, .line = XLOG_PARAM_LINE, .level = LEVEL, .id = XLOG_MODULE_ID}; xlog_fprintf_safe(&xlog_args__, XLOGD_OUTPUT, STRING);} while(0)
+// Structured logging.  At least one key/value pair must be passed.
+#define xlog_kv(ARGS, EVENT, ...) xlog_kv_write(ARGS, XLOGD_OUTPUT, EVENT, (const xlog_kv_t []){ __VA_ARGS__ }, sizeof((const xlog_kv_t []){ __VA_ARGS__ }) / sizeof(xlog_kv_t))
+
+#define XLOGD_KV(LEVEL, COLOR, EVENT, ...) do { if(LEVEL < g_xlog_modules[XLOG_MODULE_ID]) { XLOG_SUPPRESSED(LEVEL); break; } XLOG_STATIC_ARGS const xlog_args_t xlog_args__ = {.options = XLOG_OPTS_DEFAULT, .color = COLOR, .function = XLOG_PARAM_FUNCTION, .line = XLOG_PARAM_LINE, .level = LEVEL, .id = XLOG_MODULE_ID}; xlog_kv(&xlog_args__, EVENT, __VA_ARGS__);} while(0)
+
+#define XLOGD_DEBUG_KV(EVENT, ...) XLOGD_KV(XLOG_LEVEL_DEBUG, XLOG_COLOR_GRN,  EVENT, __VA_ARGS__)
+#define XLOGD_INFO_KV(EVENT, ...)  XLOGD_KV(XLOG_LEVEL_INFO,  XLOG_COLOR_NONE, EVENT, __VA_ARGS__)
+#define XLOGD_WARN_KV(EVENT, ...)  XLOGD_KV(XLOG_LEVEL_WARN,  XLOG_COLOR_YEL,  EVENT, __VA_ARGS__)
+#define XLOGD_ERROR_KV(EVENT, ...) XLOGD_KV(XLOG_LEVEL_ERROR, XLOG_COLOR_RED,  EVENT, __VA_ARGS__)
+
+// Hex dump.  The buffer and length are not evaluated when the level is disabled.
+#define xlog_hexdump(ARGS, BUF, LEN, FLAGS) xlog_hexdump_write(ARGS, XLOGD_OUTPUT, BUF, LEN, FLAGS)
+
+#define XLOGD_HEXDUMP(LEVEL, COLOR, BUF, LEN, FLAGS) do { if(LEVEL < g_xlog_modules[XLOG_MODULE_ID]) { XLOG_SUPPRESSED(LEVEL); break; } XLOG_STATIC_ARGS const xlog_args_t xlog_args__ = {.options = XLOG_OPTS_DEFAULT, .color = COLOR, .function = XLOG_PARAM_FUNCTION, .line = XLOG_PARAM_LINE, .level = LEVEL, .id = XLOG_MODULE_ID}; xlog_hexdump(&xlog_args__, BUF, LEN, FLAGS);} while(0)
+
+#define XLOGD_DEBUG_HEXDUMP(BUF, LEN) XLOGD_HEXDUMP(XLOG_LEVEL_DEBUG, XLOG_COLOR_GRN,  BUF, LEN, XLOG_HEXDUMP_DEFAULT)
+#define XLOGD_INFO_HEXDUMP(BUF, LEN)  XLOGD_HEXDUMP(XLOG_LEVEL_INFO,  XLOG_COLOR_NONE, BUF, LEN, XLOG_HEXDUMP_DEFAULT)
+#define XLOGD_WARN_HEXDUMP(BUF, LEN)  XLOGD_HEXDUMP(XLOG_LEVEL_WARN,  XLOG_COLOR_YEL,  BUF, LEN, XLOG_HEXDUMP_DEFAULT)
+#define XLOGD_ERROR_HEXDUMP(BUF, LEN) XLOGD_HEXDUMP(XLOG_LEVEL_ERROR, XLOG_COLOR_RED,  BUF, LEN, XLOG_HEXDUMP_DEFAULT)
+
+// define XLOG_RL_BURST and XLOG_RL_PERIOD (ms) to control the default rate limit of the _RL macros
+#ifndef XLOG_RL_BURST
+#define XLOG_RL_BURST (10)
+#endif
+#ifndef XLOG_RL_PERIOD
+#define XLOG_RL_PERIOD (1000)
+#endif
+
+// Rate limited logging.  Each call site has its own token bucket.  The quantity of suppressed records is printed before the next record from the site.
+#define XLOG_RL(LEVEL, OPTS, COLOR, BURST, PERIOD, FORMAT, ...) do { if(LEVEL < g_xlog_modules[XLOG_MODULE_ID]) { XLOG_SUPPRESSED(LEVEL); break; } static xlog_rate_limit_t xlog_rl__ = XLOG_RATE_LIMIT_INIT(BURST, PERIOD); if(!xlog_rate_limit_pass(&xlog_rl__)) { break; } XLOG_RL_STATIC_ARGS const xlog_args_t xlog_args__ = {.options = OPTS, .color = COLOR, .function = XLOG_PARAM_FUNCTION, .line = XLOG_PARAM_LINE, .level = LEVEL, .id = XLOG_MODULE_ID}; if(xlog_rl__.suppressed != 0) { xlog_rate_limit_report(&xlog_args__, &xlog_rl__, XLOGD_OUTPUT); } XLOG_FPRINTF(LEVEL, &xlog_args__, FORMAT, ##__VA_ARGS__);} while(0)
+#define XLOGD_RL(LEVEL, OPTS, COLOR, BURST, PERIOD, ...) XLOG_RL(LEVEL, OPTS, COLOR, BURST, PERIOD, ##__VA_ARGS__)
+
+#define XLOGD_DEBUG_RL(...) XLOGD_RL(XLOG_LEVEL_DEBUG, XLOG_OPTS_DEFAULT, XLOG_COLOR_GRN,  XLOG_RL_BURST, XLOG_RL_PERIOD, __VA_ARGS__)
+#define XLOGD_INFO_RL(...)  XLOGD_RL(XLOG_LEVEL_INFO,  XLOG_OPTS_DEFAULT, XLOG_COLOR_NONE, XLOG_RL_BURST, XLOG_RL_PERIOD, __VA_ARGS__)
+#define XLOGD_WARN_RL(...)  XLOGD_RL(XLOG_LEVEL_WARN,  XLOG_OPTS_DEFAULT, XLOG_COLOR_YEL,  XLOG_RL_BURST, XLOG_RL_PERIOD, __VA_ARGS__)
+#define XLOGD_ERROR_RL(...) XLOGD_RL(XLOG_LEVEL_ERROR, XLOG_OPTS_DEFAULT, XLOG_COLOR_RED,  XLOG_RL_BURST, XLOG_RL_PERIOD, __VA_ARGS__)
+
+#define XLOGD_SAFE(LEVEL, OPTS, COLOR, STRING) do { if(LEVEL < g_xlog_modules[XLOG_MODULE_ID]) { XLOG_SUPPRESSED(LEVEL); break; } XLOG_STATIC_ARGS const xlog_args_t xlog_args__ = {.options = OPTS, .color = COLOR, .function = XLOG_PARAM_FUNCTION, .line = XLOG_PARAM_LINE, .level = LEVEL, .id = XLOG_MODULE_ID}; xlog_fprintf_safe(&xlog_args__, XLOGD_OUTPUT, STRING);} while(0)
 
 #define XLOGD_SAFE_DEBUG(STRING) XLOGD_SAFE(XLOG_LEVEL_DEBUG, XLOG_OPTS_DEFAULT, XLOG_COLOR_GRN,  STRING)
 #define XLOGD_SAFE_INFO(STRING)  XLOGD_SAFE(XLOG_LEVEL_INFO,  XLOG_OPTS_DEFAULT, XLOG_COLOR_NONE, STRING)
@@ -0,0 +1,259 @@
+/*
+##########################################################################
+# If not stated otherwise in this file or this component's LICENSE
+# file the following copyright and licenses apply:
+#
+# Copyright 2019 RDK Management
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+##########################################################################
+*/
+#ifndef __RDKX_LOGGER_HPP__
+#define __RDKX_LOGGER_HPP__
+
+// C++ logging.  Include this file instead of rdkx_logger.h to check the format string of each XLOG macro (XLOGD_INFO,
+// XLOG_WARN, XLOGD_ERROR_RL, ...) against the types of its arguments at compile time.  The arguments are passed to the
+// library in an array of typed values (xlog_arg_t) and formatted without vsnprintf or memory allocation.  The macros and
+// the records are otherwise the same as in C (xlog_args_t, levels in g_xlog_modules, sinks, etc).
+//
+// The format must be a string literal using the conversions of the built-in formatter (%d %i %u %x %X %c %s %p %%) or a
+// floating point conversion.  A mismatch fails to compile with a note naming the problem (ie. format_error_argument_type).
+// Integers of any size can be used with the integer conversions.  std::string can be used with %s.  %m is not supported.
+
+#if __cplusplus < 201402L
+#error rdkx_logger.hpp requires C++14 or later
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include "rdkx_logger.h"
+
+// define XLOG_CPP_LEVEL_MIN to remove the records below a level at compile time, including those of the dynamic XLOGD
+// macros (the static XLOG macros are removed by XLOG_LEVEL as in C)
+#ifndef XLOG_CPP_LEVEL_MIN
+#define XLOG_CPP_LEVEL_MIN XLOG_LEVEL_ALL
+#endif
+
+namespace xlog {
+namespace detail {
+
+enum arg_kind_t {
+   ARG_KIND_NONE,
+   ARG_KIND_INT,
+   ARG_KIND_FLOAT,
+   ARG_KIND_STR,
+   ARG_KIND_PTR
+};
+
+template<typename... T> struct type_list {};
+
+// Only used in decltype to get the decayed types of the arguments
+template<typename... T> type_list<typename std::decay<T>::type...> arg_types(const T &...);
+
+template<typename T, typename = void> struct arg_traits {
+   static constexpr arg_kind_t kind = ARG_KIND_NONE;
+};
+
+template<typename T> struct arg_traits<T, typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type> {
+   static constexpr arg_kind_t kind = ARG_KIND_INT;
+   typedef typename std::conditional<std::is_enum<T>::value, std::underlying_type<T>, std::common_type<T>>::type::type integer_t;
+
+   static xlog_arg_t encode(T value) {
+      xlog_arg_t arg = {};
+      arg.type    = std::is_signed<integer_t>::value ? XLOG_ARG_TYPE_INT : XLOG_ARG_TYPE_UINT;
+      arg.size    = sizeof(integer_t);
+      arg.value.u = std::is_signed<integer_t>::value ? (uint64_t)(int64_t)(integer_t)value : (uint64_t)(integer_t)value;
+      return(arg);
+   }
+};
+
+template<typename T> struct arg_traits<T, typename std::enable_if<std::is_floating_point<T>::value>::type> {
+   static constexpr arg_kind_t kind = ARG_KIND_FLOAT;
+
+   static xlog_arg_t encode(T value) {
+      xlog_arg_t arg = {};
+      arg.type    = XLOG_ARG_TYPE_DOUBLE;
+      arg.value.d = (double)value;
+      return(arg);
+   }
+};
+
+template<> struct arg_traits<const char *> {
+   static constexpr arg_kind_t kind = ARG_KIND_STR;
+
+   static xlog_arg_t encode(const char *value) {
+      xlog_arg_t arg = {};
+      arg.type    = XLOG_ARG_TYPE_STR;
+      arg.value.s = value;
+      return(arg);
+   }
+};
+
+template<> struct arg_traits<char *> : arg_traits<const char *> {};
+
+template<> struct arg_traits<std::string> {
+   static constexpr arg_kind_t kind = ARG_KIND_STR;
+
+   static xlog_arg_t encode(const std::string &value) {
+      return(arg_traits<const char *>::encode(value.c_str()));
+   }
+};
+
+// Pointers other than strings (cast a string to const void * to print its address)
+template<typename T> struct arg_traits<T, typename std::enable_if<(std::is_pointer<T>::value && !std::is_same<T, const char *>::value && !std::is_same<T, char *>::value) ||
+                                                                  std::is_same<T, std::nullptr_t>::value>::type> {
+   static constexpr arg_kind_t kind = ARG_KIND_PTR;
+
+   static xlog_arg_t encode(T value) {
+      xlog_arg_t arg = {};
+      arg.type    = XLOG_ARG_TYPE_PTR;
+      arg.value.p = (const void *)value;
+      return(arg);
+   }
+};
+
+// Not constexpr.  Reaching one of these while checking a format stops the compilation and the compiler names the function.
+inline void format_error_too_few_arguments(void) {}
+inline void format_error_too_many_arguments(void) {}
+inline void format_error_argument_type(void) {}
+inline void format_error_conversion_not_supported(void) {}
+
+// Follows the parsing of xlog_format_fast (rdkx_logger_format.c) so a format which passes is formatted by the library
+template<typename... T>
+constexpr bool format_check(const char *format, type_list<T...>) {
+   const arg_kind_t kinds[] = { arg_traits<T>::kind..., ARG_KIND_NONE };
+   const size_t     qty     = sizeof...(T);
+   size_t           index   = 0;
+
+   for(size_t pos = 0; format[pos] != '\0'; pos++) {
+      if(format[pos] != '%') {
+         continue;
+      }
+      pos++;
+      if(format[pos] == '%') {
+         continue;
+      }
+      bool flags = false; // Flags other than -
+      for(;; pos++) {
+         if(format[pos] == '0' || format[pos] == '#' || format[pos] == '+' || format[pos] == ' ') {
+            flags = true;
+         } else if(format[pos] != '-') {
+            break;
+         }
+      }
+      // Width and precision
+      bool precision = false;
+      for(uint32_t field = 0; field < 2; field++) {
+         if(field == 1) {
+            if(format[pos] != '.') {
+               break;
+            }
+            precision = true;
+            pos++;
+         }
+         if(format[pos] == '*') {
+            if(index >= qty) {
+               format_error_too_few_arguments();
+               return(false);
+            }
+            if(kinds[index++] != ARG_KIND_INT) {
+               format_error_argument_type();
+               return(false);
+            }
+            pos++;
+         } else {
+            while(format[pos] >= '0' && format[pos] <= '9') {
+               pos++;
+            }
+         }
+      }
+      // Length modifier (H for hh and L for ll)
+      char length = '\0';
+      if(format[pos] == 'h' || format[pos] == 'l') {
+         length = format[pos++];
+         if(format[pos] == length) {
+            length = (length == 'h') ? 'H' : 'L';
+            pos++;
+         }
+      } else if(format[pos] == 'z' || format[pos] == 'j' || format[pos] == 't') {
+         length = format[pos++];
+      }
+
+      arg_kind_t kind = ARG_KIND_NONE;
+      switch(format[pos]) {
+         case 'd': case 'i': case 'u': case 'x': case 'X': {
+            kind = ARG_KIND_INT;
+            break;
+         }
+         case 'c': {
+            kind = (length == '\0' && !precision && !flags) ? ARG_KIND_INT : ARG_KIND_NONE;
+            break;
+         }
+         case 's': {
+            kind = (length == '\0' && !flags) ? ARG_KIND_STR : ARG_KIND_NONE;
+            break;
+         }
+         case 'p': {
+            kind = (length == '\0' && !precision && !flags) ? ARG_KIND_PTR : ARG_KIND_NONE;
+            break;
+         }
+         case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A': {
+            kind = (length == '\0' || length == 'l') ? ARG_KIND_FLOAT : ARG_KIND_NONE;
+            break;
+         }
+         default: {
+            break;
+         }
+      }
+      if(kind == ARG_KIND_NONE) {
+         format_error_conversion_not_supported();
+         return(false);
+      }
+      if(index >= qty) {
+         format_error_too_few_arguments();
+         return(false);
+      }
+      if(kinds[index++] != kind) {
+         format_error_argument_type();
+         return(false);
+      }
+   }
+   if(index != qty) {
+      format_error_too_many_arguments();
+      return(false);
+   }
+   return(true);
+}
+
+template<typename T>
+inline xlog_arg_t encode(const T &value) {
+   return(arg_traits<typename std::decay<T>::type>::encode(value));
+}
+
+template<typename... T>
+inline int write(const xlog_args_t *args, FILE *stream, const char *format, const T &... values) {
+   // One more entry so the array is not empty without arguments
+   const xlog_arg_t argv[sizeof...(T) + 1] = { encode(values)..., xlog_arg_t() };
+   return(xlog_write_args(args, stream, format, argv, sizeof...(T)));
+}
+
+} // namespace detail
+} // namespace xlog
+
+// Replaces the call made by the XLOG and XLOG_RL macros of rdkx_logger.h
+#undef XLOG_FPRINTF
+#define XLOG_FPRINTF(LEVEL, ARGS, FORMAT, ...) { static_assert(xlog::detail::format_check(FORMAT, decltype(xlog::detail::arg_types(__VA_ARGS__)){}), "invalid format string or arguments"); if((LEVEL) >= XLOG_CPP_LEVEL_MIN) { xlog::detail::write(ARGS, XLOGD_OUTPUT, FORMAT, ##__VA_ARGS__); } }
+
+#endif
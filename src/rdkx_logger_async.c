@@ -0,0 +1,466 @@
+/*
+##########################################################################
+# If not stated otherwise in this file or this component's LICENSE
+# file the following copyright and licenses apply:
+#
+# Copyright 2019 RDK Management
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+##########################################################################
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include "rdkx_logger.h"
+#include "rdkx_logger_private.h"
+
+// Each thread which logs in asynchronous mode owns a single producer/single consumer ring of formatted records.  The writer
+// thread is the only consumer.  It merges the rings in timestamp order and performs the output.  Only records to the
+// standard streams or the user print callback are queued.  Streams and fds passed by the caller can be closed as soon as
+// the call returns so they are written synchronously.
+
+#ifndef XLOG_ASYNC_RING_SIZE_DEFAULT
+#define XLOG_ASYNC_RING_SIZE_DEFAULT (16 * 1024)
+#endif
+
+#define XLOG_ASYNC_RING_SIZE_MIN      (1024)
+#define XLOG_ASYNC_RING_SIZE_MAX      (16 * 1024 * 1024)
+#define XLOG_ASYNC_RECORD_SIZE_MAX    (4096)     // Records larger than this are written synchronously
+#define XLOG_ASYNC_WRITER_TIMEOUT_MS  (100)      // Maximum time the writer sleeps without being woken
+#define XLOG_ASYNC_FLUSH_TIMEOUT_MS   (500)      // Maximum time to wait for the rings to drain in xlog_async_flush
+#define XLOG_ASYNC_STREAM_QTY_MAX     (8)        // Maximum quantity of streams flushed when the writer goes idle
+#define XLOG_ASYNC_CACHE_LINE_SIZE    (64)
+
+#define XLOG_ASYNC_ALIGN(x)        (((x) + 7) & ~((uint32_t)7))
+
+typedef struct {
+   uint64_t timestamp; // Monotonic time in nanoseconds when the record was queued
+   FILE *   stream;    // Output stream or NULL to use the file descriptor
+   int32_t  fd;        // Output file descriptor (only used if stream is NULL)
+   uint16_t level;     // Log level of the record
+   uint16_t module;    // Module id of the record
+   uint32_t size;      // Size of the formatted record which follows the header
+} xlog_async_record_t;
+
+typedef struct xlog_async_ring_s {
+   struct xlog_async_ring_s *next;
+   uint8_t *                 data;
+   uint32_t                  size;     // Size of the data buffer (power of 2)
+   volatile bool             orphaned; // Owning thread has exited
+   uint64_t                  dropped;  // Written by the producer only
+   uint64_t                  blocked;  // Written by the producer only
+   // Keep the producer and consumer indices on separate cache lines to avoid false sharing
+   volatile uint32_t         head __attribute__((aligned(XLOG_ASYNC_CACHE_LINE_SIZE))); // Producer write index
+   volatile uint32_t         tail __attribute__((aligned(XLOG_ASYNC_CACHE_LINE_SIZE))); // Consumer read index
+} xlog_async_ring_t;
+
+volatile bool g_xlog_async = false;
+
+static xlog_async_full_t   g_xlog_async_full      = XLOG_ASYNC_FULL_DROP;
+static uint32_t            g_xlog_async_ring_size = XLOG_ASYNC_RING_SIZE_DEFAULT;
+static xlog_async_ring_t * g_xlog_async_rings     = NULL;
+static pthread_mutex_t     g_xlog_async_mutex     = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t      g_xlog_async_cond;
+static pthread_t           g_xlog_async_thread;
+static pthread_key_t       g_xlog_async_key;
+static bool                g_xlog_async_key_init  = false;
+static volatile bool       g_xlog_async_running   = false;
+static volatile bool       g_xlog_async_sleeping  = false;
+static uint64_t            g_xlog_async_records   = 0;
+static uint64_t            g_xlog_async_dropped   = 0; // Totals from rings which have been freed
+static uint64_t            g_xlog_async_blocked   = 0;
+
+static __thread xlog_async_ring_t *g_xlog_async_ring_thread   = NULL;
+static __thread bool               g_xlog_async_writer_thread = false; // Set in the writer thread
+
+static void *              xlog_async_writer(void *data);
+static xlog_async_ring_t * xlog_async_ring_get(void);
+static void                xlog_async_ring_release(void *data);
+static void                xlog_async_ring_free(xlog_async_ring_t *ring);
+static bool                xlog_async_rings_empty(void);
+static void                xlog_async_wake(void);
+static void                xlog_async_copy_in(xlog_async_ring_t *ring, uint32_t index, const void *src, uint32_t size);
+static void                xlog_async_copy_out(const xlog_async_ring_t *ring, uint32_t index, void *dst, uint32_t size);
+static uint64_t            xlog_async_timestamp(void);
+
+int xlog_async_init(const xlog_async_params_t *params) {
+   if(params == NULL) {
+      return(-1);
+   }
+   if(g_xlog_async_running) {
+      XLOGD_WARN("async mode is already running");
+      return(-1);
+   }
+   uint32_t ring_size = (params->ring_size == 0) ? XLOG_ASYNC_RING_SIZE_DEFAULT : params->ring_size;
+   if(ring_size < XLOG_ASYNC_RING_SIZE_MIN || ring_size > XLOG_ASYNC_RING_SIZE_MAX) {
+      XLOGD_ERROR("invalid ring size <%u>", ring_size);
+      return(-1);
+   }
+   // Round up to a power of 2 so the ring indices can be masked
+   uint32_t size = XLOG_ASYNC_RING_SIZE_MIN;
+   while(size < ring_size) {
+      size <<= 1;
+   }
+   g_xlog_async_ring_size = size;
+   g_xlog_async_full      = params->full;
+
+   if(!g_xlog_async_key_init) {
+      if(0 != pthread_key_create(&g_xlog_async_key, xlog_async_ring_release)) {
+         XLOGD_ERROR("unable to create thread key");
+         return(-1);
+      }
+      g_xlog_async_key_init = true;
+   }
+
+   pthread_condattr_t attr;
+   pthread_condattr_init(&attr);
+   pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+   pthread_cond_init(&g_xlog_async_cond, &attr);
+   pthread_condattr_destroy(&attr);
+
+   g_xlog_async_running = true;
+   if(0 != pthread_create(&g_xlog_async_thread, NULL, xlog_async_writer, NULL)) {
+      int errsv = errno;
+      XLOGD_ERROR("unable to create writer thread <%s>", strerror(errsv));
+      g_xlog_async_running = false;
+      pthread_cond_destroy(&g_xlog_async_cond);
+      return(-1);
+   }
+   __atomic_store_n(&g_xlog_async, true, __ATOMIC_RELEASE);
+
+   XLOGD_INFO("ring size <%u> full <%s>", size, (params->full == XLOG_ASYNC_FULL_BLOCK) ? "BLOCK" : "DROP");
+   return(0);
+}
+
+void xlog_async_term(void) {
+   if(!g_xlog_async_running) {
+      return;
+   }
+   // Stop queuing new records and let the writer drain the rings before exiting
+   __atomic_store_n(&g_xlog_async, false, __ATOMIC_SEQ_CST);
+
+   pthread_mutex_lock(&g_xlog_async_mutex);
+   g_xlog_async_running = false;
+   pthread_cond_signal(&g_xlog_async_cond);
+   pthread_mutex_unlock(&g_xlog_async_mutex);
+
+   pthread_join(g_xlog_async_thread, NULL);
+   pthread_cond_destroy(&g_xlog_async_cond);
+
+   // Free the rings of threads which have exited.  Rings of live threads are retained since they are still referenced.
+   pthread_mutex_lock(&g_xlog_async_mutex);
+   xlog_async_ring_t **prev = &g_xlog_async_rings;
+   while(*prev != NULL) {
+      xlog_async_ring_t *ring = *prev;
+      if(ring->orphaned) {
+         *prev = ring->next;
+         xlog_async_ring_free(ring);
+      } else {
+         prev = &ring->next;
+      }
+   }
+   pthread_mutex_unlock(&g_xlog_async_mutex);
+}
+
+int xlog_async_enqueue(const xlog_args_t *args, FILE *stream, int fd, const struct iovec *iov, int iovcnt) {
+   size_t size = 0;
+   for(int index = 0; index < iovcnt; index++) {
+      size += iov[index].iov_len;
+   }
+   uint32_t total = XLOG_ASYNC_ALIGN(sizeof(xlog_async_record_t) + size);
+
+   // Records logged by the writer thread (ie. from a print callback) are written directly since it would wait on itself if
+   // its ring were full
+   if(g_xlog_async_writer_thread || size > XLOG_ASYNC_RECORD_SIZE_MAX || total > (g_xlog_async_ring_size >> 1)) {
+      return(xlog_outputv(args->level, stream, fd, iov, iovcnt));
+   }
+   if(stream != stdout && stream != stderr) {
+      if(stream == NULL || !xlog_output_user()) {
+         return(xlog_outputv(args->level, stream, fd, iov, iovcnt));
+      }
+      stream = stdout; // The callback doesn't use the stream.  The caller's stream is not kept since it may be closed.
+   }
+
+   xlog_async_ring_t *ring = xlog_async_ring_get();
+   if(ring == NULL) {
+      return(xlog_outputv(args->level, stream, fd, iov, iovcnt));
+   }
+
+   uint32_t head = ring->head;
+   bool     blocked = false;
+   do {
+      uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+      if(ring->size - (head - tail) >= total) {
+         break;
+      }
+      if(g_xlog_async_full == XLOG_ASYNC_FULL_DROP) {
+         ring->dropped++;
+         return(0);
+      }
+      if(!blocked) {
+         ring->blocked++;
+         blocked = true;
+      }
+      if(!__atomic_load_n(&g_xlog_async, __ATOMIC_ACQUIRE)) { // Writer is stopping
+         return(xlog_outputv(args->level, stream, fd, iov, iovcnt));
+      }
+      xlog_async_wake();
+      sched_yield();
+   } while(1);
+
+   xlog_async_record_t record;
+   record.timestamp = xlog_async_timestamp();
+   record.stream    = stream;
+   record.fd        = fd;
+   record.level     = args->level;
+   record.module    = args->id;
+   record.size      = size;
+
+   xlog_async_copy_in(ring, head, &record, sizeof(record));
+   head += sizeof(record);
+   for(int index = 0; index < iovcnt; index++) {
+      xlog_async_copy_in(ring, head, iov[index].iov_base, iov[index].iov_len);
+      head += iov[index].iov_len;
+   }
+
+   // Publish the record to the writer
+   __atomic_store_n(&ring->head, ring->head + total, __ATOMIC_SEQ_CST);
+
+   if(__atomic_load_n(&g_xlog_async_sleeping, __ATOMIC_SEQ_CST)) {
+      xlog_async_wake();
+   }
+   return(size);
+}
+
+void xlog_async_flush(void) {
+   if(!__atomic_load_n(&g_xlog_async, __ATOMIC_ACQUIRE)) {
+      return;
+   }
+   xlog_async_wake();
+
+   struct timespec delay = { .tv_sec = 0, .tv_nsec = 1000000 };
+   for(uint32_t index = 0; index < XLOG_ASYNC_FLUSH_TIMEOUT_MS; index++) {
+      // The mutex prevents the writer from freeing a ring while it is being checked
+      pthread_mutex_lock(&g_xlog_async_mutex);
+      bool empty = xlog_async_rings_empty();
+      pthread_mutex_unlock(&g_xlog_async_mutex);
+      if(empty) {
+         break;
+      }
+      nanosleep(&delay, NULL);
+   }
+}
+
+void xlog_async_stats_get(xlog_async_stats_t *stats) {
+   if(stats == NULL) {
+      return;
+   }
+   memset(stats, 0, sizeof(*stats));
+
+   pthread_mutex_lock(&g_xlog_async_mutex);
+   stats->records = __atomic_load_n(&g_xlog_async_records, __ATOMIC_RELAXED);
+   stats->dropped = g_xlog_async_dropped;
+   stats->blocked = g_xlog_async_blocked;
+   for(xlog_async_ring_t *ring = g_xlog_async_rings; ring != NULL; ring = ring->next) {
+      stats->dropped += __atomic_load_n(&ring->dropped, __ATOMIC_RELAXED);
+      stats->blocked += __atomic_load_n(&ring->blocked, __ATOMIC_RELAXED);
+      stats->rings++;
+   }
+   pthread_mutex_unlock(&g_xlog_async_mutex);
+}
+
+xlog_async_ring_t *xlog_async_ring_get(void) {
+   xlog_async_ring_t *ring = g_xlog_async_ring_thread;
+   if(ring != NULL) {
+      return(ring);
+   }
+   ring = (xlog_async_ring_t *)calloc(1, sizeof(*ring));
+   if(ring == NULL) {
+      return(NULL);
+   }
+   ring->data = (uint8_t *)malloc(g_xlog_async_ring_size);
+   if(ring->data == NULL) {
+      free(ring);
+      return(NULL);
+   }
+   ring->size = g_xlog_async_ring_size;
+
+   pthread_mutex_lock(&g_xlog_async_mutex);
+   ring->next = g_xlog_async_rings;
+   __atomic_store_n(&g_xlog_async_rings, ring, __ATOMIC_RELEASE);
+   pthread_mutex_unlock(&g_xlog_async_mutex);
+
+   pthread_setspecific(g_xlog_async_key, ring);
+   g_xlog_async_ring_thread = ring;
+   return(ring);
+}
+
+void xlog_async_ring_release(void *data) {
+   // Called on thread exit.  The writer frees the ring once it has been drained.
+   xlog_async_ring_t *ring = (xlog_async_ring_t *)data;
+   __atomic_store_n(&ring->orphaned, true, __ATOMIC_RELEASE);
+   g_xlog_async_ring_thread = NULL;
+}
+
+void xlog_async_ring_free(xlog_async_ring_t *ring) {
+   // Must be called with the mutex locked
+   g_xlog_async_dropped += ring->dropped;
+   g_xlog_async_blocked += ring->blocked;
+   free(ring->data);
+   free(ring);
+}
+
+bool xlog_async_rings_empty(void) {
+   for(xlog_async_ring_t *ring = __atomic_load_n(&g_xlog_async_rings, __ATOMIC_ACQUIRE); ring != NULL; ring = ring->next) {
+      if(__atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) != __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE)) {
+         return(false);
+      }
+   }
+   return(true);
+}
+
+void xlog_async_wake(void) {
+   pthread_mutex_lock(&g_xlog_async_mutex);
+   pthread_cond_signal(&g_xlog_async_cond);
+   pthread_mutex_unlock(&g_xlog_async_mutex);
+}
+
+void xlog_async_copy_in(xlog_async_ring_t *ring, uint32_t index, const void *src, uint32_t size) {
+   uint32_t offset = index & (ring->size - 1);
+   uint32_t first  = ring->size - offset;
+   if(first >= size) {
+      memcpy(&ring->data[offset], src, size);
+   } else {
+      memcpy(&ring->data[offset], src, first);
+      memcpy(ring->data, ((const uint8_t *)src) + first, size - first);
+   }
+}
+
+void xlog_async_copy_out(const xlog_async_ring_t *ring, uint32_t index, void *dst, uint32_t size) {
+   uint32_t offset = index & (ring->size - 1);
+   uint32_t first  = ring->size - offset;
+   if(first >= size) {
+      memcpy(dst, &ring->data[offset], size);
+   } else {
+      memcpy(dst, &ring->data[offset], first);
+      memcpy(((uint8_t *)dst) + first, ring->data, size - first);
+   }
+}
+
+uint64_t xlog_async_timestamp(void) {
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return(((uint64_t)ts.tv_sec * 1000000000ULL) + ts.tv_nsec);
+}
+
+void *xlog_async_writer(void *data) {
+   char     buffer[XLOG_ASYNC_RECORD_SIZE_MAX + 1]; // The record is NUL terminated for xlog_print_t callbacks
+   FILE *   streams[XLOG_ASYNC_STREAM_QTY_MAX];
+   uint32_t stream_qty = 0;
+
+   g_xlog_async_writer_thread = true;
+
+   do {
+      // Find the oldest record at the head of all of the rings
+      xlog_async_ring_t * oldest = NULL;
+      xlog_async_record_t record;
+
+      for(xlog_async_ring_t *ring = __atomic_load_n(&g_xlog_async_rings, __ATOMIC_ACQUIRE); ring != NULL; ring = ring->next) {
+         uint32_t tail = ring->tail;
+         if(__atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) == tail) {
+            continue;
+         }
+         xlog_async_record_t header;
+         xlog_async_copy_out(ring, tail, &header, sizeof(header));
+         if(oldest == NULL || header.timestamp < record.timestamp) {
+            oldest = ring;
+            record = header;
+         }
+      }
+
+      if(oldest != NULL) {
+         uint32_t tail = oldest->tail;
+         xlog_async_copy_out(oldest, tail + sizeof(record), buffer, record.size);
+         buffer[record.size] = '\0';
+         __atomic_store_n(&oldest->tail, tail + XLOG_ASYNC_ALIGN(sizeof(record) + record.size), __ATOMIC_RELEASE);
+
+         if(xlog_output((xlog_level_t)record.level, record.stream, record.fd, buffer, record.size) < 0) {
+            xlog_stats_error((xlog_module_id_t)record.module);
+         }
+         __atomic_add_fetch(&g_xlog_async_records, 1, __ATOMIC_RELAXED);
+
+         if(record.stream != NULL) {
+            uint32_t index = 0;
+            for(; index < stream_qty; index++) {
+               if(streams[index] == record.stream) {
+                  break;
+               }
+            }
+            if(index == stream_qty && stream_qty < XLOG_ASYNC_STREAM_QTY_MAX) {
+               streams[stream_qty++] = record.stream;
+            }
+         }
+         continue;
+      }
+
+      // All rings are empty.  Flush the streams which were written and free the rings of threads which have exited.
+      for(uint32_t index = 0; index < stream_qty; index++) {
+         fflush(streams[index]);
+      }
+      stream_qty = 0;
+
+      pthread_mutex_lock(&g_xlog_async_mutex);
+      xlog_async_ring_t **prev = &g_xlog_async_rings;
+      while(*prev != NULL) {
+         xlog_async_ring_t *ring = *prev;
+         if(__atomic_load_n(&ring->orphaned, __ATOMIC_ACQUIRE) && ring->head == ring->tail) {
+            *prev = ring->next;
+            xlog_async_ring_free(ring);
+         } else {
+            prev = &ring->next;
+         }
+      }
+
+      if(!g_xlog_async_running) {
+         pthread_mutex_unlock(&g_xlog_async_mutex);
+         if(xlog_async_rings_empty()) {
+            break;
+         }
+         continue;
+      }
+
+      // Announce that the writer is going to sleep and check again to avoid missing a wake up from a producer
+      __atomic_store_n(&g_xlog_async_sleeping, true, __ATOMIC_SEQ_CST);
+      if(xlog_async_rings_empty()) {
+         struct timespec timeout;
+         clock_gettime(CLOCK_MONOTONIC, &timeout);
+         timeout.tv_nsec += XLOG_ASYNC_WRITER_TIMEOUT_MS * 1000000;
+         if(timeout.tv_nsec >= 1000000000) {
+            timeout.tv_sec++;
+            timeout.tv_nsec -= 1000000000;
+         }
+         pthread_cond_timedwait(&g_xlog_async_cond, &g_xlog_async_mutex, &timeout);
+      }
+      __atomic_store_n(&g_xlog_async_sleeping, false, __ATOMIC_SEQ_CST);
+      pthread_mutex_unlock(&g_xlog_async_mutex);
+   } while(1);
+
+   return(NULL);
+}
@@ -0,0 +1,470 @@
+/*
+##########################################################################
+# If not stated otherwise in this file or this component's LICENSE
+# file the following copyright and licenses apply:
+#
+# Copyright 2019 RDK Management
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+##########################################################################
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include "rdkx_logger.h"
+#include "rdkx_logger_private.h"
+
+// In binary mode, the static data for each call site (format string and xlog_args_t) is written once as a dictionary entry.
+// Each log record only contains the site id, the time of day and the packed arguments.  Use xlog-decode to produce the text.
+
+#define XLOG_BINARY_SITE_QTY_MAX (4096) // Must be a power of 2
+#define XLOG_BINARY_STR_NULL     (0xFFFF)
+#define XLOG_BINARY_ARG_STR_NULL (0xFFFFFFFF)
+
+typedef struct {
+   volatile bool ready;  // Entry has been written to the file and may be used
+   bool          text;   // Records contain the formatted text since the format can't be packed
+   uint32_t      id;
+   const char *  format;
+   xlog_args_t   args;
+} xlog_binary_site_t;
+
+volatile bool g_xlog_binary_modules[XLOG_MODULE_SLOT_QTY]; // Only the generated modules can be enabled
+
+static int                g_xlog_binary_fd      = -1;
+static uint32_t           g_xlog_binary_site_id = 0;
+static pthread_mutex_t    g_xlog_binary_mutex   = PTHREAD_MUTEX_INITIALIZER;
+static pthread_rwlock_t   g_xlog_binary_lock    = PTHREAD_RWLOCK_INITIALIZER; // Held for reading while a record is written so the file isn't closed under it
+static xlog_binary_site_t g_xlog_binary_sites[XLOG_BINARY_SITE_QTY_MAX];
+
+extern const char * const g_xlog_module_id_to_str[];
+
+static int                 xlog_binary_write_record(const xlog_args_t *args, const char *format, va_list ap);
+static xlog_binary_site_t *xlog_binary_site_get(const xlog_args_t *args, const char *format);
+static bool                xlog_binary_site_match(const xlog_binary_site_t *site, const xlog_args_t *args, const char *format);
+static bool                xlog_binary_format_packable(const char *format);
+static uint32_t            xlog_binary_put_str(uint8_t *buffer, uint32_t used, uint32_t size, const char *str);
+static bool                xlog_binary_record_write(int fd, uint8_t *buffer, uint32_t size, xlog_binary_record_type_t type);
+
+int xlog_binary_open(const char *filename) {
+   if(filename == NULL) {
+      XLOGD_ERROR("invalid params");
+      return(-1);
+   }
+   // The lock is taken before the mutex, as in the write path
+   pthread_rwlock_wrlock(&g_xlog_binary_lock);
+   pthread_mutex_lock(&g_xlog_binary_mutex);
+   if(g_xlog_binary_fd >= 0) {
+      pthread_mutex_unlock(&g_xlog_binary_mutex);
+      pthread_rwlock_unlock(&g_xlog_binary_lock);
+      XLOGD_WARN("already open");
+      return(-1);
+   }
+   int fd = open(filename, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+   if(fd < 0) {
+      int errsv = errno;
+      pthread_mutex_unlock(&g_xlog_binary_mutex);
+      pthread_rwlock_unlock(&g_xlog_binary_lock);
+      XLOGD_ERROR("unable to open <%s> <%s>", filename, strerror(errsv));
+      return(-1);
+   }
+
+   // Session record contains the magic, version and the module name table
+   uint8_t  buffer[XLOG_STACK_BUF_SIZE];
+   uint32_t used = sizeof(xlog_binary_record_t);
+   uint32_t version    = XLOG_BINARY_VERSION;
+   uint32_t module_qty = XLOG_MODULE_QTY_MAX;
+
+   memcpy(&buffer[used], XLOG_BINARY_MAGIC, sizeof(XLOG_BINARY_MAGIC)); used += sizeof(XLOG_BINARY_MAGIC);
+   memcpy(&buffer[used], &version,    sizeof(version));                 used += sizeof(version);
+   memcpy(&buffer[used], &module_qty, sizeof(module_qty));              used += sizeof(module_qty);
+   for(uint32_t id = 0; id < XLOG_MODULE_QTY_MAX; id++) {
+      used = xlog_binary_put_str(buffer, used, sizeof(buffer), g_xlog_module_id_to_str[id]);
+   }
+
+   if(!xlog_binary_record_write(fd, buffer, used, XLOG_BINARY_RECORD_SESSION)) {
+      close(fd);
+      pthread_mutex_unlock(&g_xlog_binary_mutex);
+      pthread_rwlock_unlock(&g_xlog_binary_lock);
+      return(-1);
+   }
+
+   memset(g_xlog_binary_sites, 0, sizeof(g_xlog_binary_sites));
+   g_xlog_binary_site_id = 0;
+   g_xlog_binary_fd      = fd;
+   pthread_mutex_unlock(&g_xlog_binary_mutex);
+   pthread_rwlock_unlock(&g_xlog_binary_lock);
+
+   XLOGD_INFO("binary output to <%s>", filename);
+   return(0);
+}
+
+void xlog_binary_close(void) {
+   for(uint32_t id = 0; id < XLOG_MODULE_QTY_MAX; id++) {
+      g_xlog_binary_modules[id] = false;
+   }
+   // Waits for the records being written
+   pthread_rwlock_wrlock(&g_xlog_binary_lock);
+   pthread_mutex_lock(&g_xlog_binary_mutex);
+   if(g_xlog_binary_fd >= 0) {
+      close(g_xlog_binary_fd);
+      g_xlog_binary_fd = -1;
+   }
+   pthread_mutex_unlock(&g_xlog_binary_mutex);
+   pthread_rwlock_unlock(&g_xlog_binary_lock);
+}
+
+void xlog_binary_module_set(xlog_module_id_t id, bool enable) {
+   if(((uint32_t)id) >= XLOG_MODULE_QTY_MAX) {
+      XLOGD_ERROR("invalid module id <%d>", id);
+      return;
+   }
+   if(enable && g_xlog_binary_fd < 0) {
+      XLOGD_ERROR("binary output is not open");
+      return;
+   }
+   g_xlog_binary_modules[id] = enable;
+}
+
+int xlog_binary_write(const xlog_args_t *args, const char *format, va_list ap) {
+   // The file is not closed or opened again while the record and its dictionary entry are written
+   pthread_rwlock_rdlock(&g_xlog_binary_lock);
+   int rc = (g_xlog_binary_fd < 0) ? -1 : xlog_binary_write_record(args, format, ap);
+   pthread_rwlock_unlock(&g_xlog_binary_lock);
+   return(rc);
+}
+
+int xlog_binary_write_record(const xlog_args_t *args, const char *format, va_list ap) {
+   int errsv = errno; // Saved for %m
+   xlog_binary_site_t *site = xlog_binary_site_get(args, format);
+
+   if(site == NULL) { // Dictionary is full, use text output
+      return(-1);
+   }
+
+   uint8_t  buffer[XLOG_STACK_BUF_SIZE];
+   uint32_t used = sizeof(xlog_binary_record_t);
+   struct timeval tv;
+   gettimeofday(&tv, NULL);
+
+   int64_t  sec  = tv.tv_sec;
+   uint32_t usec = tv.tv_usec;
+   memcpy(&buffer[used], &site->id, sizeof(site->id)); used += sizeof(site->id);
+   memcpy(&buffer[used], &usec,     sizeof(usec));     used += sizeof(usec);
+   memcpy(&buffer[used], &sec,      sizeof(sec));      used += sizeof(sec);
+
+   if(site->text) {
+      int rc = vsnprintf((char *)&buffer[used + sizeof(uint32_t)], sizeof(buffer) - used - sizeof(uint32_t), format, ap);
+      if(rc < 0) {
+         return(rc);
+      }
+      uint32_t len = ((size_t)rc >= sizeof(buffer) - used - sizeof(uint32_t)) ? sizeof(buffer) - used - sizeof(uint32_t) - 1 : (uint32_t)rc;
+      memcpy(&buffer[used], &len, sizeof(len));
+      used += sizeof(len) + len;
+   } else {
+      xlog_binary_spec_t spec;
+      const char *       pos = format;
+
+      // Pack the arguments as 64 bit integers, doubles, long doubles or length prefixed strings
+      do {
+         pos = xlog_binary_spec_next(pos, &spec);
+         if(spec.start == NULL) {
+            break;
+         }
+         int64_t value;
+         if(spec.width_arg) {
+            value = va_arg(ap, int);
+            memcpy(&buffer[used], &value, sizeof(value)); used += sizeof(value);
+         }
+         if(spec.prec_arg) {
+            value = va_arg(ap, int);
+            memcpy(&buffer[used], &value, sizeof(value)); used += sizeof(value);
+         }
+         switch(spec.type) {
+            case XLOG_BINARY_ARG_INT:     { value = va_arg(ap, int);                     break; }
+            case XLOG_BINARY_ARG_LONG:    { value = va_arg(ap, long);                    break; }
+            case XLOG_BINARY_ARG_LLONG:   { value = va_arg(ap, long long);               break; }
+            case XLOG_BINARY_ARG_SIZE:    { value = (int64_t)va_arg(ap, size_t);         break; }
+            case XLOG_BINARY_ARG_INTMAX:  { value = va_arg(ap, intmax_t);                break; }
+            case XLOG_BINARY_ARG_PTRDIFF: { value = va_arg(ap, ptrdiff_t);               break; }
+            case XLOG_BINARY_ARG_PTR:     { value = (int64_t)(uintptr_t)va_arg(ap, void *); break; }
+            case XLOG_BINARY_ARG_ERRNO:   { value = errsv;                               break; }
+            case XLOG_BINARY_ARG_DOUBLE: {
+               double val = va_arg(ap, double);
+               memcpy(&value, &val, sizeof(value));
+               break;
+            }
+            case XLOG_BINARY_ARG_LDOUBLE: {
+               long double val = va_arg(ap, long double);
+               memcpy(&buffer[used], &val, sizeof(val));
+               used += sizeof(val);
+               continue;
+            }
+            case XLOG_BINARY_ARG_STRING: {
+               const char *str = va_arg(ap, const char *);
+               uint32_t    len = XLOG_BINARY_ARG_STR_NULL;
+               uint32_t    max = sizeof(buffer) - used - sizeof(len) - 32; // Leave room for the remaining arguments
+               if(str != NULL) {
+                  len = strlen(str);
+                  if(len > max) {
+                     len = max;
+                  }
+               }
+               memcpy(&buffer[used], &len, sizeof(len)); used += sizeof(len);
+               if(str != NULL) {
+                  memcpy(&buffer[used], str, len); used += len;
+               }
+               continue;
+            }
+            default: {
+               value = 0;
+               break;
+            }
+         }
+         memcpy(&buffer[used], &value, sizeof(value)); used += sizeof(value);
+      } while(used + 64 <= sizeof(buffer)); // Arguments which don't fit are not recorded
+   }
+
+   if(!xlog_binary_record_write(g_xlog_binary_fd, buffer, used, XLOG_BINARY_RECORD_LOG)) {
+      return(-1);
+   }
+   return(used);
+}
+
+const char *xlog_binary_spec_next(const char *format, xlog_binary_spec_t *spec) {
+   memset(spec, 0, sizeof(*spec));
+
+   // Find the next conversion, skipping literal text and "%%"
+   const char *pos = format;
+   while(*pos != '\0') {
+      if(*pos == '%') {
+         if(pos[1] != '%') {
+            break;
+         }
+         pos++;
+      }
+      pos++;
+   }
+   if(*pos == '\0') {
+      return(pos);
+   }
+   spec->start = pos++;
+   spec->type  = XLOG_BINARY_ARG_INVALID;
+
+   // Flags
+   while(*pos != '\0' && strchr("-+ #0'I", *pos) != NULL) {
+      pos++;
+   }
+   // Width (positional arguments are not supported)
+   if(*pos == '*') {
+      spec->width_arg = true;
+      pos++;
+   } else {
+      while(*pos >= '0' && *pos <= '9') {
+         pos++;
+      }
+   }
+   if(*pos == '$') {
+      spec->len = pos - spec->start;
+      return(pos);
+   }
+   // Precision
+   if(*pos == '.') {
+      pos++;
+      if(*pos == '*') {
+         spec->prec_arg = true;
+         pos++;
+      } else {
+         while(*pos >= '0' && *pos <= '9') {
+            pos++;
+         }
+      }
+   }
+   // Length modifier
+   char length = '\0';
+   if(pos[0] == 'h' && pos[1] == 'h') {
+      length = 'H';
+      pos += 2;
+   } else if(pos[0] == 'l' && pos[1] == 'l') {
+      length = 'q';
+      pos += 2;
+   } else if(*pos != '\0' && strchr("hlqLjzZt", *pos) != NULL) {
+      length = *pos++;
+   }
+   // Conversion
+   switch(*pos) {
+      case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': {
+         switch(length) {
+            case 'l': { spec->type = XLOG_BINARY_ARG_LONG;    break; }
+            case 'q':
+            case 'L': { spec->type = XLOG_BINARY_ARG_LLONG;   break; }
+            case 'z':
+            case 'Z': { spec->type = XLOG_BINARY_ARG_SIZE;    break; }
+            case 'j': { spec->type = XLOG_BINARY_ARG_INTMAX;  break; }
+            case 't': { spec->type = XLOG_BINARY_ARG_PTRDIFF; break; }
+            default:  { spec->type = XLOG_BINARY_ARG_INT;     break; }
+         }
+         break;
+      }
+      case 'c': {
+         spec->type = (length == '\0') ? XLOG_BINARY_ARG_INT : XLOG_BINARY_ARG_INVALID;
+         break;
+      }
+      case 's': {
+         spec->type = (length == '\0') ? XLOG_BINARY_ARG_STRING : XLOG_BINARY_ARG_INVALID;
+         break;
+      }
+      case 'p': {
+         spec->type = XLOG_BINARY_ARG_PTR;
+         break;
+      }
+      case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A': {
+         spec->type = (length == 'L') ? XLOG_BINARY_ARG_LDOUBLE : XLOG_BINARY_ARG_DOUBLE;
+         break;
+      }
+      case 'm': {
+         spec->type = XLOG_BINARY_ARG_ERRNO;
+         break;
+      }
+      default: { // %n, wide characters and unknown conversions
+         break;
+      }
+   }
+   if(*pos != '\0') {
+      pos++;
+   }
+   spec->len = pos - spec->start;
+   return(pos);
+}
+
+xlog_binary_site_t *xlog_binary_site_get(const xlog_args_t *args, const char *format) {
+   uintptr_t hash = ((uintptr_t)format >> 3) ^ ((uintptr_t)args->function >> 3) ^ ((uintptr_t)args->line * 31) ^ ((uintptr_t)args->level << 8) ^ ((uintptr_t)args->id << 12) ^ args->options;
+   uint32_t  index = (uint32_t)(hash ^ (hash >> 16)) & (XLOG_BINARY_SITE_QTY_MAX - 1);
+
+   for(uint32_t count = 0; count < XLOG_BINARY_SITE_QTY_MAX; count++, index = (index + 1) & (XLOG_BINARY_SITE_QTY_MAX - 1)) {
+      xlog_binary_site_t *site = &g_xlog_binary_sites[index];
+      if(__atomic_load_n(&site->ready, __ATOMIC_ACQUIRE)) {
+         if(xlog_binary_site_match(site, args, format)) {
+            return(site);
+         }
+         continue;
+      }
+
+      // Empty entry.  Add the site to the dictionary unless another thread got here first.
+      pthread_mutex_lock(&g_xlog_binary_mutex);
+      if(site->ready) {
+         pthread_mutex_unlock(&g_xlog_binary_mutex);
+         if(xlog_binary_site_match(site, args, format)) {
+            return(site);
+         }
+         continue;
+      }
+      site->id     = g_xlog_binary_site_id++;
+      site->text   = !xlog_binary_format_packable(format);
+      site->format = format;
+      site->args   = *args;
+
+      uint8_t  buffer[XLOG_STACK_BUF_SIZE];
+      uint32_t used   = sizeof(xlog_binary_record_t);
+      uint32_t flags  = site->text ? 1 : 0;
+      int32_t  line   = args->line;
+      uint16_t level  = args->level;
+      uint16_t module = args->id;
+
+      memcpy(&buffer[used], &site->id,       sizeof(site->id));       used += sizeof(site->id);
+      memcpy(&buffer[used], &flags,          sizeof(flags));          used += sizeof(flags);
+      memcpy(&buffer[used], &args->options,  sizeof(args->options));  used += sizeof(args->options);
+      memcpy(&buffer[used], &line,           sizeof(line));           used += sizeof(line);
+      memcpy(&buffer[used], &level,          sizeof(level));          used += sizeof(level);
+      memcpy(&buffer[used], &module,         sizeof(module));         used += sizeof(module);
+      used = xlog_binary_put_str(buffer, used, sizeof(buffer), args->color);
+      used = xlog_binary_put_str(buffer, used, sizeof(buffer), args->function);
+      used = xlog_binary_put_str(buffer, used, sizeof(buffer), format);
+
+      bool result = xlog_binary_record_write(g_xlog_binary_fd, buffer, used, XLOG_BINARY_RECORD_SITE);
+      if(result) {
+         __atomic_store_n(&site->ready, true, __ATOMIC_RELEASE);
+      }
+      pthread_mutex_unlock(&g_xlog_binary_mutex);
+      return(result ? site : NULL);
+   }
+   return(NULL);
+}
+
+bool xlog_binary_site_match(const xlog_binary_site_t *site, const xlog_args_t *args, const char *format) {
+   return(site->format        == format         &&
+          site->args.function == args->function &&
+          site->args.line     == args->line     &&
+          site->args.level    == args->level    &&
+          site->args.id       == args->id       &&
+          site->args.options  == args->options  &&
+          site->args.color    == args->color);
+}
+
+bool xlog_binary_format_packable(const char *format) {
+   xlog_binary_spec_t spec;
+   do {
+      format = xlog_binary_spec_next(format, &spec);
+      if(spec.start != NULL && spec.type == XLOG_BINARY_ARG_INVALID) {
+         return(false);
+      }
+   } while(spec.start != NULL);
+   return(true);
+}
+
+uint32_t xlog_binary_put_str(uint8_t *buffer, uint32_t used, uint32_t size, const char *str) {
+   uint16_t len = XLOG_BINARY_STR_NULL;
+   if(str != NULL) {
+      size_t str_len = strlen(str);
+      size_t max     = size - used - sizeof(len);
+      if(max >= XLOG_BINARY_STR_NULL) {
+         max = XLOG_BINARY_STR_NULL - 1;
+      }
+      len = (str_len > max) ? max : str_len;
+   }
+   memcpy(&buffer[used], &len, sizeof(len));
+   used += sizeof(len);
+   if(str != NULL) {
+      memcpy(&buffer[used], str, len);
+      used += len;
+   }
+   return(used);
+}
+
+bool xlog_binary_record_write(int fd, uint8_t *buffer, uint32_t size, xlog_binary_record_type_t type) {
+   xlog_binary_record_t record = { .size = size, .type = type, .reserved = 0 };
+   memcpy(buffer, &record, sizeof(record));
+
+   // A single write per record keeps records from different threads intact since the file is opened with O_APPEND
+   uint32_t written = 0;
+   do {
+      ssize_t rc = write(fd, &buffer[written], size - written);
+      if(rc < 0) {
+         if(errno == EINTR) {
+            continue;
+         }
+         return(false);
+      }
+      written += rc;
+   } while(written < size);
+   return(true);
+}
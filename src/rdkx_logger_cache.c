@@ -0,0 +1,259 @@
+/*
+##########################################################################
+# If not stated otherwise in this file or this component's LICENSE
+# file the following copyright and licenses apply:
+#
+# Copyright 2019 RDK Management
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+##########################################################################
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "jansson.h"
+#include "rdkx_logger.h"
+#include "rdkx_logger_private.h"
+
+// The module levels parsed from the JSON configuration file are stored in a binary file which the following processes map
+// read-only instead of searching for, reading and parsing the JSON file.  The cache is used while the JSON file it was
+// built from has the same inode, size and modification time and no configuration file of higher priority exists, which
+// costs a stat of each of those files.  The production flag is kept even when the JSON file has changed.
+
+#define XLOG_CONFIG_CACHE_MAGIC   "XLOGCFG"
+#define XLOG_CONFIG_CACHE_VERSION (1)
+
+typedef struct {
+   char     magic[8];
+   uint32_t version;
+   uint32_t entry_qty;
+   uint32_t production;
+   uint32_t reserved;
+   uint64_t source_dev;
+   uint64_t source_ino;
+   int64_t  source_size;
+   int64_t  source_mtime_sec;
+   int64_t  source_mtime_nsec;
+   char     source[128];     // JSON file which the entries were read from
+} xlog_config_cache_header_t;
+
+// All the modules in the JSON file are stored by name so modules registered later are found too
+typedef struct {
+   char     name[XLOG_MODULE_NAME_SIZE_MAX];
+   uint32_t level;
+} xlog_config_cache_entry_t;
+
+bool g_xlog_config_cache_enable = true;
+
+static void                              xlog_config_cache_path(xlog_module_id_t id, char *path, size_t size);
+static const xlog_config_cache_header_t *xlog_config_cache_map(xlog_module_id_t id, size_t *size);
+static bool                              xlog_config_cache_current(xlog_module_id_t id, const xlog_config_cache_header_t *header);
+
+bool xlog_config_cache_load(xlog_module_id_t id, xlog_level_t *levels, char *file, size_t size, int *production) {
+   size_t                            map_size;
+   const xlog_config_cache_header_t *header = xlog_config_cache_map(id, &map_size);
+   if(header == NULL) {
+      return(false);
+   }
+   *production = header->production;
+
+   bool current = xlog_config_cache_current(id, header);
+   if(current) {
+      const xlog_config_cache_entry_t *entries = (const xlog_config_cache_entry_t *)(header + 1);
+      for(uint32_t index = 0; index < header->entry_qty; index++) {
+         xlog_module_id_t module = xlog_module_to_id(entries[index].name);
+         if(xlog_module_valid(module) && entries[index].level < XLOG_LEVEL_INVALID) {
+            levels[module] = (xlog_level_t)entries[index].level;
+         }
+      }
+      snprintf(file, size, "%s", header->source);
+   }
+   munmap((void *)header, map_size);
+   return(current);
+}
+
+int xlog_config_cache_level(xlog_module_id_t id, const char *name, xlog_level_t *level) {
+   size_t                            map_size;
+   const xlog_config_cache_header_t *header = xlog_config_cache_map(id, &map_size);
+   if(header == NULL) {
+      return(-1);
+   }
+   int rc = -1;
+   if(xlog_config_cache_current(id, header)) {
+      const xlog_config_cache_entry_t *entries = (const xlog_config_cache_entry_t *)(header + 1);
+      rc = 0;
+      for(uint32_t index = 0; index < header->entry_qty; index++) {
+         if(0 == strcmp(entries[index].name, name) && entries[index].level < XLOG_LEVEL_INVALID) {
+            *level = (xlog_level_t)entries[index].level;
+            rc     = 1;
+            break;
+         }
+      }
+   }
+   munmap((void *)header, map_size);
+   return(rc);
+}
+
+void xlog_config_cache_store(xlog_module_id_t id, const char *file, const struct stat *source, json_t *obj, bool production) {
+   if(!g_xlog_config_cache_enable || !json_is_object(obj) || strlen(file) >= sizeof(((xlog_config_cache_header_t *)0)->source)) {
+      return;
+   }
+   size_t   size = sizeof(xlog_config_cache_header_t) + (json_object_size(obj) * sizeof(xlog_config_cache_entry_t));
+   uint8_t *data = (uint8_t *)calloc(1, size);
+   if(data == NULL) {
+      XLOGD_ERROR("out of memory");
+      return;
+   }
+   xlog_config_cache_header_t *header  = (xlog_config_cache_header_t *)data;
+   xlog_config_cache_entry_t * entries = (xlog_config_cache_entry_t *)(header + 1);
+
+   memcpy(header->magic, XLOG_CONFIG_CACHE_MAGIC, sizeof(header->magic));
+   header->version           = XLOG_CONFIG_CACHE_VERSION;
+   header->production        = production;
+   header->source_dev        = source->st_dev;
+   header->source_ino        = source->st_ino;
+   header->source_size       = source->st_size;
+   header->source_mtime_sec  = source->st_mtim.tv_sec;
+   header->source_mtime_nsec = source->st_mtim.tv_nsec;
+   snprintf(header->source, sizeof(header->source), "%s", file);
+
+   const char *module;
+   json_t *    value;
+   json_object_foreach(obj, module, value) {
+      const char *level_str = json_string_value(value);
+      if(level_str == NULL || strlen(module) >= XLOG_MODULE_NAME_SIZE_MAX) {
+         continue;
+      }
+      rdkx_logger_level_t *level = rdkx_logger_level_str_to_num(level_str, strlen(level_str));
+      if(level == NULL || level->level >= XLOG_LEVEL_INVALID) {
+         continue;
+      }
+      xlog_config_cache_entry_t *entry = &entries[header->entry_qty++];
+      snprintf(entry->name, sizeof(entry->name), "%s", module);
+      entry->level = level->level;
+   }
+   uint32_t entry_qty = header->entry_qty;
+   size = sizeof(xlog_config_cache_header_t) + (entry_qty * sizeof(xlog_config_cache_entry_t));
+
+   // The cache is written to a temporary file and renamed so other processes never map a partial file
+   char path[128];
+   char temp[160];
+   xlog_config_cache_path(id, path, sizeof(path));
+   snprintf(temp, sizeof(temp), "%s.%d", path, getpid());
+
+   int fd = open(temp, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC | O_NOFOLLOW, 0644);
+   if(fd < 0) {
+      int errsv = errno;
+      XLOGD_WARN("unable to create <%s> <%s>", temp, strerror(errsv));
+      free(data);
+      return;
+   }
+   size_t used = 0;
+   while(used < size) {
+      ssize_t rc = write(fd, &data[used], size - used);
+      if(rc < 0) {
+         if(errno == EINTR) {
+            continue;
+         }
+         break;
+      }
+      used += rc;
+   }
+   close(fd);
+   free(data);
+
+   if(used != size || rename(temp, path) < 0) {
+      int errsv = errno;
+      XLOGD_WARN("unable to write <%s> <%s>", path, strerror(errsv));
+      unlink(temp);
+      return;
+   }
+   XLOGD_DEBUG("stored <%s> entries <%u>", path, entry_qty);
+}
+
+void xlog_config_cache_path(xlog_module_id_t id, char *path, size_t size) {
+   // The configuration file depends on the module which initialized the library
+   if(xlog_module_valid(id)) {
+      snprintf(path, size, "%s/%s%s.cache", XLOG_CONFIG_CACHE_DIR_NAME, XLOG_CONFIG_FILE_NAME_ROOT, xlog_module_name_get(id, NULL));
+   } else {
+      snprintf(path, size, "%s/%s.cache", XLOG_CONFIG_CACHE_DIR_NAME, XLOG_CONFIG_FILE_NAME_ROOT);
+   }
+}
+
+const xlog_config_cache_header_t *xlog_config_cache_map(xlog_module_id_t id, size_t *size) {
+   if(!g_xlog_config_cache_enable) {
+      return(NULL);
+   }
+   char path[128];
+   xlog_config_cache_path(id, path, sizeof(path));
+
+   int fd = open(path, O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+   if(fd < 0) {
+      return(NULL);
+   }
+   // The cache directory is shared so only files written by this user or root are trusted
+   struct stat st;
+   if(fstat(fd, &st) < 0 || (st.st_uid != 0 && st.st_uid != geteuid()) || (size_t)st.st_size < sizeof(xlog_config_cache_header_t)) {
+      close(fd);
+      return(NULL);
+   }
+   void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+   close(fd);
+   if(data == MAP_FAILED) {
+      return(NULL);
+   }
+   const xlog_config_cache_header_t *header = (const xlog_config_cache_header_t *)data;
+   if(memcmp(header->magic, XLOG_CONFIG_CACHE_MAGIC, sizeof(header->magic)) != 0 || header->version != XLOG_CONFIG_CACHE_VERSION ||
+      sizeof(*header) + ((uint64_t)header->entry_qty * sizeof(xlog_config_cache_entry_t)) != (uint64_t)st.st_size) {
+      XLOGD_WARN("invalid cache <%s>", path);
+      munmap(data, st.st_size);
+      return(NULL);
+   }
+   const xlog_config_cache_entry_t *entries = (const xlog_config_cache_entry_t *)(header + 1);
+   for(uint32_t index = 0; index < header->entry_qty; index++) {
+      if(entries[index].name[sizeof(entries[index].name) - 1] != '\0') {
+         XLOGD_WARN("invalid cache <%s>", path);
+         munmap(data, st.st_size);
+         return(NULL);
+      }
+   }
+   *size = st.st_size;
+   return(header);
+}
+
+bool xlog_config_cache_current(xlog_module_id_t id, const xlog_config_cache_header_t *header) {
+   struct stat st;
+   if(header->source[sizeof(header->source) - 1] != '\0' || stat(header->source, &st) < 0) {
+      return(false);
+   }
+   if((uint64_t)st.st_dev != header->source_dev || (uint64_t)st.st_ino != header->source_ino || st.st_size != header->source_size ||
+      st.st_mtim.tv_sec != header->source_mtime_sec || st.st_mtim.tv_nsec != header->source_mtime_nsec) {
+      return(false);
+   }
+   // A file which xlog_config_load would read before the source was created later
+   char     files[XLOG_CONFIG_FILE_QTY_MAX][XLOG_CONFIG_FILE_SIZE_MAX];
+   uint32_t qty = xlog_config_files(id, header->production, files);
+   for(uint32_t index = 0; index < qty && 0 != strcmp(files[index], header->source); index++) {
+      if(stat(files[index], &st) == 0) {
+         return(false);
+      }
+   }
+   return(true);
+}
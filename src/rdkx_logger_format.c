@@ -0,0 +1,533 @@
+/*
+##########################################################################
+# If not stated otherwise in this file or this component's LICENSE
+# file the following copyright and licenses apply:
+#
+# Copyright 2019 RDK Management
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+##########################################################################
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
+#include "rdkx_logger.h"
+#include "rdkx_logger_private.h"
+
+// Formatter for the conversions which are commonly used in log records (%d %i %u %x %X %c %s %p %% with the - 0 # + space
+// flags, width, precision and the hh h l ll z j t length modifiers).  The output is the same as vsnprintf.  Any other
+// conversion (ie. floating point or %m) is formatted by vsnprintf from the start of the format string.
+//
+// The arguments are read from a va_list or from an array of typed arguments (xlog_arg_t, used by rdkx_logger.hpp).  Typed
+// arguments are converted as vsnprintf would with the length modifier matching the type of the argument, so a length
+// modifier which does not match only narrows the value for hh and h.  Floating point arguments are formatted by snprintf
+// directly into the output since there is no va_list to start over with.
+
+typedef struct {
+   char * str;
+   size_t size;
+   size_t used; // Length of the complete output which may be larger than size
+} xlog_format_out_t;
+
+// Source of the arguments (argv is NULL for a va_list)
+typedef struct {
+   va_list *         ap;
+   const xlog_arg_t *argv;
+   uint32_t          argc;
+   uint32_t          index;
+} xlog_format_src_t;
+
+#define XLOG_FORMAT_FLAG_LEFT  (1 << 0) // -
+#define XLOG_FORMAT_FLAG_ZERO  (1 << 1) // 0
+#define XLOG_FORMAT_FLAG_ALT   (1 << 2) // #
+#define XLOG_FORMAT_FLAG_PLUS  (1 << 3) // +
+#define XLOG_FORMAT_FLAG_SPACE (1 << 4) // space
+
+typedef enum {
+   XLOG_FORMAT_LEN_INT,
+   XLOG_FORMAT_LEN_CHAR,
+   XLOG_FORMAT_LEN_SHORT,
+   XLOG_FORMAT_LEN_LONG,
+   XLOG_FORMAT_LEN_LLONG,
+   XLOG_FORMAT_LEN_SIZE,
+   XLOG_FORMAT_LEN_INTMAX,
+   XLOG_FORMAT_LEN_PTRDIFF
+} xlog_format_len_t;
+
+volatile bool g_xlog_format_enable = true;
+
+// Two decimal digits for each value from 0 to 99
+static const char g_xlog_format_digits[201] =
+   "0001020304050607080910111213141516171819"
+   "2021222324252627282930313233343536373839"
+   "4041424344454647484950515253545556575859"
+   "6061626364656667686970717273747576777879"
+   "8081828384858687888990919293949596979899";
+
+static const char g_xlog_format_hex_lower[] = "0123456789abcdef";
+static const char g_xlog_format_hex_upper[] = "0123456789ABCDEF";
+
+static bool              xlog_format_fast(xlog_format_out_t *out, const char *format, xlog_format_src_t *src);
+static __inline bool     xlog_format_arg_signed(xlog_format_src_t *src, xlog_format_len_t len, int64_t *value);
+static __inline bool     xlog_format_arg_unsigned(xlog_format_src_t *src, xlog_format_len_t len, uint64_t *value);
+static __inline bool     xlog_format_arg_typed(xlog_format_src_t *src, xlog_arg_type_t type, const xlog_arg_t **arg);
+static bool              xlog_format_float(xlog_format_out_t *out, xlog_format_src_t *src, uint32_t flags, int width, int precision, char conversion);
+static __inline void     xlog_format_put(xlog_format_out_t *out, const char *data, size_t len);
+static __inline void     xlog_format_pad(xlog_format_out_t *out, char c, size_t len);
+static __inline uint32_t xlog_format_dec(char *end, uint64_t value);
+static __inline uint32_t xlog_format_hex(char *end, uint64_t value, const char *digits);
+static void              xlog_format_number(xlog_format_out_t *out, uint32_t flags, int width, int precision, const char *prefix, uint32_t prefix_len, const char *digits, uint32_t digit_qty);
+
+int xlog_vformat(char *str, size_t size, const char *format, va_list ap) {
+   if(!g_xlog_format_enable) {
+      return(vsnprintf(str, size, format, ap));
+   }
+   xlog_format_out_t out = { .str = str, .size = size, .used = 0 };
+   va_list           aq;
+
+   // Format from a copy of the arguments so vsnprintf can start over if an unsupported conversion is found
+   va_copy(aq, ap);
+   xlog_format_src_t src = { .ap = &aq, .argv = NULL, .argc = 0, .index = 0 };
+   bool done = xlog_format_fast(&out, format, &src);
+   va_end(aq);
+
+   if(!done || out.used > INT32_MAX) {
+      return(vsnprintf(str, size, format, ap));
+   }
+   if(size > 0) {
+      str[(out.used < size) ? out.used : size - 1] = '\0';
+   }
+   return(out.used);
+}
+
+int xlog_format_args(char *str, size_t size, const char *format, const xlog_arg_t *argv, uint32_t argc) {
+   xlog_format_out_t out = { .str = str, .size = size, .used = 0 };
+   xlog_format_src_t src = { .ap = NULL, .argv = argv, .argc = argc, .index = 0 };
+
+   // Unsupported conversions, wrong argument types and unused arguments are errors since there is no fallback
+   if(!xlog_format_fast(&out, format, &src) || src.index != argc || out.used > INT32_MAX) {
+      return(-1);
+   }
+   if(size > 0) {
+      str[(out.used < size) ? out.used : size - 1] = '\0';
+   }
+   return(out.used);
+}
+
+bool xlog_format_fast(xlog_format_out_t *out, const char *format, xlog_format_src_t *src) {
+   do {
+      // Copy the literal text up to the next conversion
+      const char *percent = strchr(format, '%');
+      if(percent == NULL) {
+         xlog_format_put(out, format, strlen(format));
+         return(true);
+      }
+      if(percent != format) {
+         xlog_format_put(out, format, percent - format);
+      }
+      format = percent + 1;
+
+      if(*format == '%') {
+         xlog_format_put(out, "%", 1);
+         format++;
+         continue;
+      }
+
+      // Flags
+      uint32_t flags = 0;
+      for(;; format++) {
+         if(*format == '-') {
+            flags |= XLOG_FORMAT_FLAG_LEFT;
+         } else if(*format == '0') {
+            flags |= XLOG_FORMAT_FLAG_ZERO;
+         } else if(*format == '#') {
+            flags |= XLOG_FORMAT_FLAG_ALT;
+         } else if(*format == '+') {
+            flags |= XLOG_FORMAT_FLAG_PLUS;
+         } else if(*format == ' ') {
+            flags |= XLOG_FORMAT_FLAG_SPACE;
+         } else {
+            break;
+         }
+      }
+
+      // Width
+      int width = 0;
+      if(*format == '*') {
+         int64_t value;
+         if(!xlog_format_arg_signed(src, XLOG_FORMAT_LEN_INT, &value)) {
+            return(false);
+         }
+         width = (int)value;
+         if(width < 0) {
+            flags |= XLOG_FORMAT_FLAG_LEFT;
+            width  = (width == INT32_MIN) ? INT32_MAX : -width;
+         }
+         format++;
+      } else {
+         for(; *format >= '0' && *format <= '9'; format++) {
+            if(width > (INT32_MAX - 9) / 10) {
+               return(false);
+            }
+            width = (width * 10) + (*format - '0');
+         }
+      }
+
+      // Precision (negative if it was not specified)
+      int precision = -1;
+      if(*format == '.') {
+         format++;
+         if(*format == '*') {
+            int64_t value;
+            if(!xlog_format_arg_signed(src, XLOG_FORMAT_LEN_INT, &value)) {
+               return(false);
+            }
+            precision = (int)value;
+            if(precision < 0) {
+               precision = -1;
+            }
+            format++;
+         } else {
+            for(precision = 0; *format >= '0' && *format <= '9'; format++) {
+               if(precision > (INT32_MAX - 9) / 10) {
+                  return(false);
+               }
+               precision = (precision * 10) + (*format - '0');
+            }
+         }
+      }
+
+      // Length modifier
+      xlog_format_len_t len = XLOG_FORMAT_LEN_INT;
+      switch(*format) {
+         case 'h': {
+            len = (format[1] == 'h') ? XLOG_FORMAT_LEN_CHAR : XLOG_FORMAT_LEN_SHORT;
+            format += (format[1] == 'h') ? 2 : 1;
+            break;
+         }
+         case 'l': {
+            len = (format[1] == 'l') ? XLOG_FORMAT_LEN_LLONG : XLOG_FORMAT_LEN_LONG;
+            format += (format[1] == 'l') ? 2 : 1;
+            break;
+         }
+         case 'z': { len = XLOG_FORMAT_LEN_SIZE;    format++; break; }
+         case 'j': { len = XLOG_FORMAT_LEN_INTMAX;  format++; break; }
+         case 't': { len = XLOG_FORMAT_LEN_PTRDIFF; format++; break; }
+         default: {
+            break;
+         }
+      }
+
+      char     digits[24];
+      char *   end    = &digits[sizeof(digits)];
+      char     prefix[2];
+      uint32_t prefix_len = 0;
+      uint32_t qty;
+
+      switch(*format) {
+         case 'd':
+         case 'i': {
+            int64_t value;
+            if(!xlog_format_arg_signed(src, len, &value)) {
+               return(false);
+            }
+            uint64_t magnitude = (value < 0) ? -(uint64_t)value : (uint64_t)value;
+            if(value < 0) {
+               prefix[prefix_len++] = '-';
+            } else if(flags & XLOG_FORMAT_FLAG_PLUS) {
+               prefix[prefix_len++] = '+';
+            } else if(flags & XLOG_FORMAT_FLAG_SPACE) {
+               prefix[prefix_len++] = ' ';
+            }
+            qty = (precision == 0 && magnitude == 0) ? 0 : xlog_format_dec(end, magnitude);
+            xlog_format_number(out, flags, width, precision, prefix, prefix_len, end - qty, qty);
+            break;
+         }
+         case 'u':
+         case 'x':
+         case 'X': {
+            uint64_t value;
+            if(!xlog_format_arg_unsigned(src, len, &value)) {
+               return(false);
+            }
+            if(precision == 0 && value == 0) {
+               qty = 0;
+            } else if(*format == 'u') {
+               qty = xlog_format_dec(end, value);
+            } else {
+               qty = xlog_format_hex(end, value, (*format == 'x') ? g_xlog_format_hex_lower : g_xlog_format_hex_upper);
+               if((flags & XLOG_FORMAT_FLAG_ALT) && value != 0) {
+                  prefix[prefix_len++] = '0';
+                  prefix[prefix_len++] = *format;
+               }
+            }
+            xlog_format_number(out, flags, width, precision, prefix, prefix_len, end - qty, qty);
+            break;
+         }
+         case 'p': {
+            if(len != XLOG_FORMAT_LEN_INT || precision >= 0 || (flags & ~XLOG_FORMAT_FLAG_LEFT)) {
+               return(false);
+            }
+            const void *value;
+            if(src->argv == NULL) {
+               value = va_arg(*src->ap, void *);
+            } else {
+               const xlog_arg_t *arg;
+               if(!xlog_format_arg_typed(src, XLOG_ARG_TYPE_PTR, &arg)) {
+                  return(false);
+               }
+               value = arg->value.p;
+            }
+            if(value == NULL) {
+               xlog_format_number(out, flags, width, -1, NULL, 0, "(nil)", 5);
+               break;
+            }
+            prefix[prefix_len++] = '0';
+            prefix[prefix_len++] = 'x';
+            qty = xlog_format_hex(end, (uintptr_t)value, g_xlog_format_hex_lower);
+            xlog_format_number(out, flags, width, -1, prefix, prefix_len, end - qty, qty);
+            break;
+         }
+         case 's': {
+            if(len != XLOG_FORMAT_LEN_INT || (flags & ~XLOG_FORMAT_FLAG_LEFT)) {
+               return(false);
+            }
+            const char *value;
+            if(src->argv == NULL) {
+               value = va_arg(*src->ap, const char *);
+            } else {
+               const xlog_arg_t *arg;
+               if(!xlog_format_arg_typed(src, XLOG_ARG_TYPE_STR, &arg)) {
+                  return(false);
+               }
+               value = arg->value.s;
+            }
+            if(value == NULL) { // Same as glibc
+               value = (precision < 0 || precision >= 6) ? "(null)" : "";
+            }
+            size_t value_len = (precision >= 0) ? strnlen(value, precision) : strlen(value);
+            xlog_format_number(out, flags, width, -1, NULL, 0, value, value_len);
+            break;
+         }
+         case 'c': {
+            if(len != XLOG_FORMAT_LEN_INT || precision >= 0 || (flags & ~XLOG_FORMAT_FLAG_LEFT)) {
+               return(false);
+            }
+            int64_t character;
+            if(!xlog_format_arg_signed(src, XLOG_FORMAT_LEN_INT, &character)) {
+               return(false);
+            }
+            char value = (unsigned char)character;
+            xlog_format_number(out, flags, width, -1, NULL, 0, &value, 1);
+            break;
+         }
+         case 'f': case 'F':
+         case 'e': case 'E':
+         case 'g': case 'G':
+         case 'a': case 'A': {
+            if(src->argv == NULL || (len != XLOG_FORMAT_LEN_INT && len != XLOG_FORMAT_LEN_LONG)) {
+               return(false);
+            }
+            if(!xlog_format_float(out, src, flags, width, precision, *format)) {
+               return(false);
+            }
+            break;
+         }
+         default: { // Not supported
+            return(false);
+         }
+      }
+      format++;
+   } while(1);
+}
+
+bool xlog_format_arg_signed(xlog_format_src_t *src, xlog_format_len_t len, int64_t *value) {
+   if(src->argv == NULL) {
+      switch(len) {
+         case XLOG_FORMAT_LEN_CHAR:    { *value = (signed char)va_arg(*src->ap, int); break; }
+         case XLOG_FORMAT_LEN_SHORT:   { *value = (short)va_arg(*src->ap, int);       break; }
+         case XLOG_FORMAT_LEN_LONG:    { *value = va_arg(*src->ap, long);             break; }
+         case XLOG_FORMAT_LEN_LLONG:   { *value = va_arg(*src->ap, long long);        break; }
+         case XLOG_FORMAT_LEN_SIZE:    { *value = va_arg(*src->ap, ssize_t);          break; }
+         case XLOG_FORMAT_LEN_INTMAX:  { *value = va_arg(*src->ap, intmax_t);         break; }
+         case XLOG_FORMAT_LEN_PTRDIFF: { *value = va_arg(*src->ap, ptrdiff_t);        break; }
+         default:                      { *value = va_arg(*src->ap, int);              break; }
+      }
+      return(true);
+   }
+   const xlog_arg_t *arg;
+   if(!xlog_format_arg_typed(src, XLOG_ARG_TYPE_INT, &arg)) {
+      return(false);
+   }
+   // The value is read with the size of the argument's type (ie. an unsigned int of 0xFFFFFFFF is -1)
+   uint32_t shift = (arg->size >= 8 || arg->size == 0) ? 0 : 64 - (arg->size * 8);
+   *value = (int64_t)(arg->value.u << shift) >> shift;
+   if(len == XLOG_FORMAT_LEN_CHAR) {
+      *value = (signed char)*value;
+   } else if(len == XLOG_FORMAT_LEN_SHORT) {
+      *value = (short)*value;
+   }
+   return(true);
+}
+
+bool xlog_format_arg_unsigned(xlog_format_src_t *src, xlog_format_len_t len, uint64_t *value) {
+   if(src->argv == NULL) {
+      switch(len) {
+         case XLOG_FORMAT_LEN_CHAR:    { *value = (unsigned char)va_arg(*src->ap, unsigned int);  break; }
+         case XLOG_FORMAT_LEN_SHORT:   { *value = (unsigned short)va_arg(*src->ap, unsigned int); break; }
+         case XLOG_FORMAT_LEN_LONG:    { *value = va_arg(*src->ap, unsigned long);                break; }
+         case XLOG_FORMAT_LEN_LLONG:   { *value = va_arg(*src->ap, unsigned long long);           break; }
+         case XLOG_FORMAT_LEN_SIZE:    { *value = va_arg(*src->ap, size_t);                       break; }
+         case XLOG_FORMAT_LEN_INTMAX:  { *value = va_arg(*src->ap, uintmax_t);                    break; }
+         case XLOG_FORMAT_LEN_PTRDIFF: { *value = (size_t)va_arg(*src->ap, ptrdiff_t);            break; }
+         default:                      { *value = va_arg(*src->ap, unsigned int);                 break; }
+      }
+      return(true);
+   }
+   const xlog_arg_t *arg;
+   if(!xlog_format_arg_typed(src, XLOG_ARG_TYPE_INT, &arg)) {
+      return(false);
+   }
+   // A negative value keeps the size of the argument's type (ie. an int of -1 is 0xFFFFFFFF)
+   *value = (arg->size >= 8 || arg->size == 0) ? arg->value.u : arg->value.u & ((1ULL << (arg->size * 8)) - 1);
+   if(len == XLOG_FORMAT_LEN_CHAR) {
+      *value = (unsigned char)*value;
+   } else if(len == XLOG_FORMAT_LEN_SHORT) {
+      *value = (unsigned short)*value;
+   }
+   return(true);
+}
+
+bool xlog_format_arg_typed(xlog_format_src_t *src, xlog_arg_type_t type, const xlog_arg_t **arg) {
+   if(src->index >= src->argc) {
+      return(false);
+   }
+   const xlog_arg_t *next = &src->argv[src->index];
+   // Signed and unsigned integers are interchangeable like they are for vsnprintf
+   if(next->type != type && !(type == XLOG_ARG_TYPE_INT && next->type == XLOG_ARG_TYPE_UINT)) {
+      return(false);
+   }
+   src->index++;
+   *arg = next;
+   return(true);
+}
+
+bool xlog_format_float(xlog_format_out_t *out, xlog_format_src_t *src, uint32_t flags, int width, int precision, char conversion) {
+   const xlog_arg_t *arg;
+   if(!xlog_format_arg_typed(src, XLOG_ARG_TYPE_DOUBLE, &arg)) {
+      return(false);
+   }
+   // The conversion is rebuilt with the width and precision passed as arguments (a negative precision is ignored)
+   char     spec[12];
+   uint32_t len = 0;
+   spec[len++] = '%';
+   if(flags & XLOG_FORMAT_FLAG_LEFT)  { spec[len++] = '-'; }
+   if(flags & XLOG_FORMAT_FLAG_ZERO)  { spec[len++] = '0'; }
+   if(flags & XLOG_FORMAT_FLAG_ALT)   { spec[len++] = '#'; }
+   if(flags & XLOG_FORMAT_FLAG_PLUS)  { spec[len++] = '+'; }
+   if(flags & XLOG_FORMAT_FLAG_SPACE) { spec[len++] = ' '; }
+   spec[len++] = '*';
+   spec[len++] = '.';
+   spec[len++] = '*';
+   spec[len++] = conversion;
+   spec[len]   = '\0';
+
+   char *str   = (out->used < out->size) ? &out->str[out->used] : NULL;
+   int   rc    = snprintf(str, (str == NULL) ? 0 : out->size - out->used, spec, width, precision, arg->value.d);
+   if(rc < 0) {
+      return(false);
+   }
+   out->used += rc;
+   return(true);
+}
+
+void xlog_format_put(xlog_format_out_t *out, const char *data, size_t len) {
+   if(out->used < out->size) {
+      size_t avail = out->size - out->used;
+      memcpy(&out->str[out->used], data, (len < avail) ? len : avail);
+   }
+   out->used += len;
+}
+
+void xlog_format_pad(xlog_format_out_t *out, char c, size_t len) {
+   if(len == 0) {
+      return;
+   }
+   if(out->used < out->size) {
+      size_t avail = out->size - out->used;
+      memset(&out->str[out->used], c, (len < avail) ? len : avail);
+   }
+   out->used += len;
+}
+
+uint32_t xlog_format_dec(char *end, uint64_t value) {
+   char *ptr = end;
+
+   // Two digits per division
+   while(value >= 100) {
+      const char *pair = &g_xlog_format_digits[(value % 100) * 2];
+      value /= 100;
+      *--ptr = pair[1];
+      *--ptr = pair[0];
+   }
+   if(value >= 10) {
+      const char *pair = &g_xlog_format_digits[value * 2];
+      *--ptr = pair[1];
+      *--ptr = pair[0];
+   } else {
+      *--ptr = '0' + value;
+   }
+   return(end - ptr);
+}
+
+uint32_t xlog_format_hex(char *end, uint64_t value, const char *digits) {
+   char *ptr = end;
+   do {
+      *--ptr = digits[value & 0xF];
+      value >>= 4;
+   } while(value != 0);
+   return(end - ptr);
+}
+
+void xlog_format_number(xlog_format_out_t *out, uint32_t flags, int width, int precision, const char *prefix, uint32_t prefix_len, const char *digits, uint32_t digit_qty) {
+   // The precision is the minimum quantity of digits.  The zero flag is ignored when the precision is specified.
+   size_t zeros = ((precision >= 0) && ((uint32_t)precision > digit_qty)) ? precision - digit_qty : 0;
+   size_t total = prefix_len + zeros + digit_qty;
+   size_t pad   = ((size_t)width > total) ? width - total : 0;
+
+   if(pad == 0 && zeros == 0 && prefix_len == 0) { // Most conversions in log records
+      xlog_format_put(out, digits, digit_qty);
+      return;
+   }
+
+   if(flags & XLOG_FORMAT_FLAG_LEFT) {
+      xlog_format_put(out, prefix, prefix_len);
+      xlog_format_pad(out, '0', zeros);
+      xlog_format_put(out, digits, digit_qty);
+      xlog_format_pad(out, ' ', pad);
+      return;
+   }
+   if((flags & XLOG_FORMAT_FLAG_ZERO) && precision < 0) {
+      zeros += pad;
+   } else {
+      xlog_format_pad(out, ' ', pad);
+   }
+   xlog_format_put(out, prefix, prefix_len);
+   xlog_format_pad(out, '0', zeros);
+   xlog_format_put(out, digits, digit_qty);
+}
@@ -0,0 +1,82 @@
+/*
+##########################################################################
+# If not stated otherwise in this file or this component's LICENSE
+# file the following copyright and licenses apply:
+#
+# Copyright 2019 RDK Management
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+##########################################################################
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "rdkx_logger.h"
+#include "rdkx_logger_private.h"
+
+// Each byte is encoded by copying its two digits from a 512 byte table, so a line is built without any division or
+// formatting calls.
+
+#define XLOG_HEXDUMP_ROW_UPPER(D) D"0" D"1" D"2" D"3" D"4" D"5" D"6" D"7" D"8" D"9" D"A" D"B" D"C" D"D" D"E" D"F"
+#define XLOG_HEXDUMP_ROW_LOWER(D) D"0" D"1" D"2" D"3" D"4" D"5" D"6" D"7" D"8" D"9" D"a" D"b" D"c" D"d" D"e" D"f"
+
+static const char g_xlog_hexdump_upper[] = XLOG_HEXDUMP_ROW_UPPER("0") XLOG_HEXDUMP_ROW_UPPER("1") XLOG_HEXDUMP_ROW_UPPER("2") XLOG_HEXDUMP_ROW_UPPER("3")
+                                           XLOG_HEXDUMP_ROW_UPPER("4") XLOG_HEXDUMP_ROW_UPPER("5") XLOG_HEXDUMP_ROW_UPPER("6") XLOG_HEXDUMP_ROW_UPPER("7")
+                                           XLOG_HEXDUMP_ROW_UPPER("8") XLOG_HEXDUMP_ROW_UPPER("9") XLOG_HEXDUMP_ROW_UPPER("A") XLOG_HEXDUMP_ROW_UPPER("B")
+                                           XLOG_HEXDUMP_ROW_UPPER("C") XLOG_HEXDUMP_ROW_UPPER("D") XLOG_HEXDUMP_ROW_UPPER("E") XLOG_HEXDUMP_ROW_UPPER("F");
+static const char g_xlog_hexdump_lower[] = XLOG_HEXDUMP_ROW_LOWER("0") XLOG_HEXDUMP_ROW_LOWER("1") XLOG_HEXDUMP_ROW_LOWER("2") XLOG_HEXDUMP_ROW_LOWER("3")
+                                           XLOG_HEXDUMP_ROW_LOWER("4") XLOG_HEXDUMP_ROW_LOWER("5") XLOG_HEXDUMP_ROW_LOWER("6") XLOG_HEXDUMP_ROW_LOWER("7")
+                                           XLOG_HEXDUMP_ROW_LOWER("8") XLOG_HEXDUMP_ROW_LOWER("9") XLOG_HEXDUMP_ROW_LOWER("a") XLOG_HEXDUMP_ROW_LOWER("b")
+                                           XLOG_HEXDUMP_ROW_LOWER("c") XLOG_HEXDUMP_ROW_LOWER("d") XLOG_HEXDUMP_ROW_LOWER("e") XLOG_HEXDUMP_ROW_LOWER("f");
+
+uint32_t xlog_hexdump_width(uint32_t flags) {
+   uint32_t width = (flags >> XLOG_HEXDUMP_WIDTH_SHIFT) & 0xFF;
+   if(width == 0) {
+      return(XLOG_HEXDUMP_WIDTH_DEFAULT);
+   }
+   return((width > XLOG_HEXDUMP_WIDTH_MAX) ? XLOG_HEXDUMP_WIDTH_MAX : width);
+}
+
+size_t xlog_hexdump_line(char *str, const uint8_t *data, size_t qty, size_t offset, uint32_t width, uint32_t flags) {
+   const char *digits = (flags & XLOG_HEXDUMP_LOWER) ? g_xlog_hexdump_lower : g_xlog_hexdump_upper;
+   size_t      used   = 0;
+
+   if(flags & XLOG_HEXDUMP_OFFSET) {
+      for(int32_t shift = 24; shift >= 0; shift -= 8) {
+         memcpy(&str[used], &digits[((offset >> shift) & 0xFF) * 2], 2);
+         used += 2;
+      }
+      str[used++] = ':';
+      str[used++] = ' ';
+   }
+   for(size_t index = 0; index < qty; index++) {
+      memcpy(&str[used], &digits[data[index] * 2], 2);
+      str[used + 2] = ' ';
+      used += 3;
+   }
+   if(!(flags & XLOG_HEXDUMP_ASCII)) {
+      return(used - 1); // Drop the trailing space
+   }
+   // Pad a short last line so the gutter lines up with the previous lines
+   memset(&str[used], ' ', (width - qty) * 3 + 1);
+   used += (width - qty) * 3 + 1;
+   str[used++] = '|';
+   for(size_t index = 0; index < qty; index++) {
+      uint8_t c = data[index];
+      str[used++] = (c >= 0x20 && c < 0x7F) ? (char)c : '.';
+   }
+   str[used++] = '|';
+   return(used);
+}
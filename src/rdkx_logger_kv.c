@@ -0,0 +1,263 @@
+/*
+##########################################################################
+# If not stated otherwise in this file or this component's LICENSE
+# file the following copyright and licenses apply:
+#
+# Copyright 2019 RDK Management
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+##########################################################################
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <sys/time.h>
+#include "rdkx_logger.h"
+#include "rdkx_logger_private.h"
+
+// Key/value records are encoded directly into the caller's buffer.  JSON records which don't fit are cut at the last
+// complete field and marked as truncated so that each line is always a valid JSON object.
+
+#define XLOG_KV_JSON_TRUNCATED ",\"truncated\":true"
+#define XLOG_KV_JSON_END       "}\n"
+
+typedef struct {
+   char * str;
+   size_t size;
+   size_t used;
+   bool   full;
+} xlog_kv_buf_t;
+
+volatile xlog_kv_format_t g_xlog_kv_format = XLOG_KV_FORMAT_TEXT; // Never XLOG_KV_FORMAT_DEFAULT
+
+static const char *g_xlog_kv_level_names[] = { "ALL", "DEBUG", "INFO", "WARN", "ERROR", "FATAL", "INVALID" };
+static const char  g_xlog_kv_hex_digits[]  = "0123456789abcdef";
+
+static void xlog_kv_put(xlog_kv_buf_t *buf, const char *data, size_t len);
+static void xlog_kv_put_uint(xlog_kv_buf_t *buf, uint64_t value, uint32_t digits_min);
+static void xlog_kv_put_int(xlog_kv_buf_t *buf, int64_t value);
+static void xlog_kv_put_hex(xlog_kv_buf_t *buf, uint64_t value);
+static void xlog_kv_put_escaped(xlog_kv_buf_t *buf, const char *str);
+static void xlog_kv_put_value(xlog_kv_buf_t *buf, const xlog_kv_t *kv, bool json);
+static void xlog_kv_put_json_str(xlog_kv_buf_t *buf, const char *key, const char *value);
+
+void xlog_kv_format_set(xlog_kv_format_t format) {
+   if(format != XLOG_KV_FORMAT_TEXT && format != XLOG_KV_FORMAT_JSON) {
+      XLOGD_ERROR("invalid format <%d>", format);
+      return;
+   }
+   g_xlog_kv_format = format;
+}
+
+size_t xlog_kv_text(char *str, size_t size, const char *event, const xlog_kv_t *kvs, uint32_t kv_qty, bool *truncated) {
+   xlog_kv_buf_t buf = { .str = str, .size = size, .used = 0, .full = false };
+
+   xlog_kv_put(&buf, event, strlen(event));
+   for(uint32_t index = 0; index < kv_qty && !buf.full; index++) {
+      xlog_kv_put(&buf, " ", 1);
+      xlog_kv_put(&buf, kvs[index].key, strlen(kvs[index].key));
+      xlog_kv_put(&buf, "=", 1);
+      xlog_kv_put_value(&buf, &kvs[index], false);
+   }
+   *truncated = buf.full;
+   return(buf.used);
+}
+
+size_t xlog_kv_json(const xlog_args_t *args, const struct timeval *tv, char *str, size_t size, const char *event, const xlog_kv_t *kvs, uint32_t kv_qty, bool *truncated) {
+   size_t reserve = sizeof(XLOG_KV_JSON_TRUNCATED XLOG_KV_JSON_END);
+   *truncated = true;
+   if(size <= reserve) {
+      return(0);
+   }
+   xlog_kv_buf_t  buf = { .str = str, .size = size - reserve, .used = 0, .full = false };
+   struct timeval now;
+
+   if(tv == NULL) {
+      gettimeofday(&now, NULL);
+      tv = &now;
+   }
+   xlog_kv_put(&buf, "{\"ts\":", 6);
+   xlog_kv_put_uint(&buf, tv->tv_sec, 1);
+   xlog_kv_put(&buf, ".", 1);
+   xlog_kv_put_uint(&buf, tv->tv_usec, 6);
+   xlog_kv_put_json_str(&buf, "module", xlog_module_name_get(args->id, NULL));
+   xlog_kv_put_json_str(&buf, "level", g_xlog_kv_level_names[(((uint32_t)args->level) < XLOG_LEVEL_INVALID) ? args->level : XLOG_LEVEL_INVALID]);
+   if(buf.full) {
+      return(0);
+   }
+   size_t mark = buf.used;
+
+   if(args->function != NULL) {
+      xlog_kv_put_json_str(&buf, "function", args->function);
+   }
+   if(args->line >= 0) {
+      xlog_kv_put(&buf, ",\"line\":", 8);
+      xlog_kv_put_uint(&buf, args->line, 1);
+   }
+   xlog_kv_put_json_str(&buf, "event", event);
+
+   for(uint32_t index = 0; index < kv_qty && !buf.full; index++) {
+      mark = buf.used;
+      xlog_kv_put(&buf, ",\"", 2);
+      xlog_kv_put_escaped(&buf, kvs[index].key);
+      xlog_kv_put(&buf, "\":", 2);
+      xlog_kv_put_value(&buf, &kvs[index], true);
+   }
+   if(buf.full) { // Drop the partial field
+      buf.used = mark;
+      memcpy(&str[buf.used], XLOG_KV_JSON_TRUNCATED, sizeof(XLOG_KV_JSON_TRUNCATED) - 1);
+      buf.used += sizeof(XLOG_KV_JSON_TRUNCATED) - 1;
+   }
+   memcpy(&str[buf.used], XLOG_KV_JSON_END, sizeof(XLOG_KV_JSON_END));
+   buf.used += sizeof(XLOG_KV_JSON_END) - 1;
+   *truncated = buf.full;
+
+   return(buf.used);
+}
+
+void xlog_kv_put(xlog_kv_buf_t *buf, const char *data, size_t len) {
+   if(buf->full || buf->used + len > buf->size) {
+      buf->full = true;
+      return;
+   }
+   memcpy(&buf->str[buf->used], data, len);
+   buf->used += len;
+}
+
+void xlog_kv_put_uint(xlog_kv_buf_t *buf, uint64_t value, uint32_t digits_min) {
+   char     digits[20];
+   uint32_t qty = 0;
+
+   do {
+      digits[sizeof(digits) - 1 - qty++] = '0' + (value % 10);
+      value /= 10;
+   } while(value != 0 || qty < digits_min);
+
+   xlog_kv_put(buf, &digits[sizeof(digits) - qty], qty);
+}
+
+void xlog_kv_put_int(xlog_kv_buf_t *buf, int64_t value) {
+   if(value < 0) {
+      xlog_kv_put(buf, "-", 1);
+      xlog_kv_put_uint(buf, -(uint64_t)value, 1);
+      return;
+   }
+   xlog_kv_put_uint(buf, value, 1);
+}
+
+void xlog_kv_put_hex(xlog_kv_buf_t *buf, uint64_t value) {
+   char     digits[18];
+   uint32_t qty = 0;
+
+   do {
+      digits[sizeof(digits) - 1 - qty++] = g_xlog_kv_hex_digits[value & 0xF];
+      value >>= 4;
+   } while(value != 0);
+   digits[sizeof(digits) - 1 - qty++] = 'x';
+   digits[sizeof(digits) - 1 - qty++] = '0';
+
+   xlog_kv_put(buf, &digits[sizeof(digits) - qty], qty);
+}
+
+void xlog_kv_put_escaped(xlog_kv_buf_t *buf, const char *str) {
+   const char *start = str;
+
+   // Copy runs of characters which don't need to be escaped
+   for(; *str != '\0'; str++) {
+      unsigned char c = *str;
+      if(c >= 0x20 && c != '"' && c != '\\') {
+         continue;
+      }
+      xlog_kv_put(buf, start, str - start);
+      start = str + 1;
+
+      char escape[6] = { '\\', c, 0, 0, 0, 0 };
+      if(c == '\n') {
+         escape[1] = 'n';
+      } else if(c == '\r') {
+         escape[1] = 'r';
+      } else if(c == '\t') {
+         escape[1] = 't';
+      } else if(c < 0x20) {
+         escape[1] = 'u';
+         escape[2] = '0';
+         escape[3] = '0';
+         escape[4] = g_xlog_kv_hex_digits[c >> 4];
+         escape[5] = g_xlog_kv_hex_digits[c & 0xF];
+         xlog_kv_put(buf, escape, 6);
+         continue;
+      }
+      xlog_kv_put(buf, escape, 2);
+   }
+   xlog_kv_put(buf, start, str - start);
+}
+
+void xlog_kv_put_value(xlog_kv_buf_t *buf, const xlog_kv_t *kv, bool json) {
+   switch(kv->type) {
+      case XLOG_KV_TYPE_INT: {
+         xlog_kv_put_int(buf, kv->value.i);
+         break;
+      }
+      case XLOG_KV_TYPE_UINT: {
+         xlog_kv_put_uint(buf, kv->value.u, 1);
+         break;
+      }
+      case XLOG_KV_TYPE_HEX: { // JSON has no hex numbers so the value is a string
+         if(json) {
+            xlog_kv_put(buf, "\"", 1);
+         }
+         xlog_kv_put_hex(buf, kv->value.u);
+         if(json) {
+            xlog_kv_put(buf, "\"", 1);
+         }
+         break;
+      }
+      case XLOG_KV_TYPE_BOOL: {
+         if(kv->value.u) {
+            xlog_kv_put(buf, "true", 4);
+         } else {
+            xlog_kv_put(buf, "false", 5);
+         }
+         break;
+      }
+      case XLOG_KV_TYPE_STR: {
+         const char *str = (kv->value.s != NULL) ? kv->value.s : "(null)";
+         if(!json) {
+            xlog_kv_put(buf, str, strlen(str));
+            break;
+         }
+         if(kv->value.s == NULL) {
+            xlog_kv_put(buf, "null", 4);
+            break;
+         }
+         xlog_kv_put(buf, "\"", 1);
+         xlog_kv_put_escaped(buf, str);
+         xlog_kv_put(buf, "\"", 1);
+         break;
+      }
+      default: {
+         xlog_kv_put(buf, json ? "null" : "?", json ? 4 : 1);
+         break;
+      }
+   }
+}
+
+void xlog_kv_put_json_str(xlog_kv_buf_t *buf, const char *key, const char *value) {
+   xlog_kv_put(buf, ",\"", 2);
+   xlog_kv_put(buf, key, strlen(key));
+   xlog_kv_put(buf, "\":\"", 3);
+   xlog_kv_put_escaped(buf, value);
+   xlog_kv_put(buf, "\"", 1);
+}
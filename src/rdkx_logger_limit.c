@@ -0,0 +1,206 @@
+/*
+##########################################################################
+# If not stated otherwise in this file or this component's LICENSE
+# file the following copyright and licenses apply:
+#
+# Copyright 2019 RDK Management
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+##########################################################################
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <time.h>
+#include <pthread.h>
+#include "rdkx_logger.h"
+#include "rdkx_logger_private.h"
+
+// Rate limiting keeps a token bucket in a static variable at each XLOG_RL call site.  Collapse mode keeps a copy of the
+// last record printed by the process and counts how many times it was repeated instead of printing it.  The repeat
+// report is copied out under the mutex and printed after it is released so the mutex is never held during output.
+
+typedef struct {
+   bool        valid;
+   xlog_args_t args;
+   FILE *      stream;
+   int         fd;
+   uint32_t    repeats;
+   size_t      len;
+   char        body[XLOG_STACK_BUF_SIZE];
+} xlog_collapse_record_t;
+
+typedef struct {
+   xlog_args_t args;
+   FILE *      stream;
+   int         fd;
+   uint32_t    repeats;
+} xlog_collapse_report_t;
+
+volatile bool g_xlog_collapse = false;
+
+static xlog_collapse_record_t g_xlog_collapse_last;
+static pthread_mutex_t        g_xlog_collapse_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static uint32_t xlog_rate_limit_time_ms(void);
+static bool     xlog_collapse_take(xlog_collapse_record_t *last, xlog_collapse_report_t *report);
+static void     xlog_collapse_report(const xlog_collapse_report_t *report);
+
+bool xlog_rate_limit_refill(xlog_rate_limit_t *rl) {
+   uint32_t now  = xlog_rate_limit_time_ms();
+   uint32_t last = __atomic_load_n(&rl->refill, __ATOMIC_RELAXED);
+
+   if(now == 0) { // Zero is reserved for a bucket which has never been refilled
+      now = 1;
+   }
+   if(last == 0) { // The initial burst has been used.  Refills start from now.
+      __atomic_compare_exchange_n(&rl->refill, &last, now, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+      return(false);
+   }
+   uint32_t elapsed = now - last;
+   uint64_t tokens  = rl->burst;
+
+   if(elapsed < rl->period) {
+      tokens = ((uint64_t)elapsed * rl->burst) / rl->period;
+      if(tokens == 0) { // Suppressed
+         return(false);
+      }
+   }
+   // Only one thread refills the bucket.  The others were suppressed.
+   if(!__atomic_compare_exchange_n(&rl->refill, &last, now, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+      return(false);
+   }
+   // The tokens went negative once per suppressed record, including this one
+   int32_t old = __atomic_exchange_n(&rl->tokens, (int32_t)tokens - 1, __ATOMIC_RELAXED);
+   if(old < -1) {
+      __atomic_add_fetch(&rl->suppressed, (uint32_t)(-(old + 1)), __ATOMIC_RELAXED);
+   }
+   return(true);
+}
+
+void xlog_rate_limit_report(const xlog_args_t *args, xlog_rate_limit_t *rl, FILE *stream) {
+   uint32_t suppressed = __atomic_exchange_n(&rl->suppressed, 0, __ATOMIC_RELAXED);
+   if(suppressed == 0) {
+      return;
+   }
+   xlog_fprintf(args, stream, "%u records suppressed by rate limit", suppressed);
+}
+
+uint32_t xlog_rate_limit_time_ms(void) {
+   struct timespec ts;
+   #ifdef CLOCK_MONOTONIC_COARSE
+   clock_gettime(CLOCK_MONOTONIC_COARSE, &ts); // Read from the vdso without a system call
+   #else
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   #endif
+   return((uint32_t)((uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000));
+}
+
+void xlog_collapse_set(bool enable) {
+   xlog_collapse_report_t report;
+   bool                   pending = false;
+
+   pthread_mutex_lock(&g_xlog_collapse_mutex);
+   if(!enable) {
+      pending = xlog_collapse_take(&g_xlog_collapse_last, &report);
+      g_xlog_collapse_last.valid = false;
+   }
+   __atomic_store_n(&g_xlog_collapse, enable, __ATOMIC_RELAXED);
+   pthread_mutex_unlock(&g_xlog_collapse_mutex);
+
+   if(pending) {
+      xlog_collapse_report(&report);
+   }
+}
+
+void xlog_collapse_flush(void) {
+   xlog_collapse_report_t report;
+
+   pthread_mutex_lock(&g_xlog_collapse_mutex);
+   bool pending = xlog_collapse_take(&g_xlog_collapse_last, &report);
+   g_xlog_collapse_last.valid = false;
+   pthread_mutex_unlock(&g_xlog_collapse_mutex);
+
+   if(pending) {
+      xlog_collapse_report(&report);
+   }
+}
+
+bool xlog_collapse_check(const xlog_args_t *args, FILE *stream, int fd, const char *body, size_t len) {
+   xlog_collapse_record_t *last = &g_xlog_collapse_last;
+   xlog_collapse_report_t  report;
+
+   pthread_mutex_lock(&g_xlog_collapse_mutex);
+   if(last->valid                                &&
+      last->stream        == stream              &&
+      last->fd            == fd                  &&
+      last->len           == len                 &&
+      last->args.function == args->function      &&
+      last->args.line     == args->line          &&
+      last->args.level    == args->level         &&
+      last->args.id       == args->id            &&
+      last->args.options  == args->options       &&
+      last->args.color    == args->color         &&
+      memcmp(last->body, body, len) == 0) {
+      last->repeats++;
+      pthread_mutex_unlock(&g_xlog_collapse_mutex);
+      return(true);
+   }
+   bool pending = xlog_collapse_take(last, &report);
+
+   last->valid = (len <= sizeof(last->body));
+   if(last->valid) {
+      last->args    = *args;
+      last->stream  = stream;
+      last->fd      = fd;
+      last->repeats = 0;
+      last->len     = len;
+      memcpy(last->body, body, len);
+   }
+   pthread_mutex_unlock(&g_xlog_collapse_mutex);
+
+   // Printed before the caller prints the new record
+   if(pending) {
+      xlog_collapse_report(&report);
+   }
+   return(false);
+}
+
+bool xlog_collapse_take(xlog_collapse_record_t *last, xlog_collapse_report_t *report) {
+   // Called with the mutex held
+   if(!last->valid || last->repeats == 0) {
+      return(false);
+   }
+   report->args    = last->args;
+   report->stream  = last->stream;
+   report->fd      = last->fd;
+   report->repeats = last->repeats;
+   last->repeats   = 0;
+   return(true);
+}
+
+void xlog_collapse_report(const xlog_collapse_report_t *report) {
+   char         body[48];
+   char         prefix[XLOG_PREFIX_BUF_SIZE];
+   char         postfix[XLOG_POSTFIX_SIZE];
+   struct iovec iov[3];
+   int          len = snprintf(body, sizeof(body), "last message repeated %u times", report->repeats);
+
+   iov[1].iov_base = body;
+   iov[1].iov_len  = len;
+   if(xlog_frame(&report->args, prefix, postfix, iov) == 0) {
+      xlog_emitv(&report->args, report->stream, report->fd, iov, 3);
+   }
+}
@@ -26,3 +26,292 @@ typedef struct rdkx_logger_level_s  { char *name; unsigned char level; } rdkx_lo
 
 struct rdkx_logger_module_s *rdkx_logger_module_str_to_index(const char *str, size_t len);
 struct rdkx_logger_level_s * rdkx_logger_level_str_to_num(const char *str, size_t len);
+
+#ifdef __RDKX_LOGGER__
+#include <sys/time.h>
+
+// This value indicates the size of the local stack variable used by key/value records, binary records and user print
+// callbacks which take a single buffer
+#ifndef XLOG_STACK_BUF_SIZE
+#define XLOG_STACK_BUF_SIZE (4096)
+#endif
+
+// Stack buffers used by the formatted output path.  Longer bodies are formatted again into a buffer kept by the thread so
+// they are not truncated.
+#ifndef XLOG_PREFIX_BUF_SIZE
+#define XLOG_PREFIX_BUF_SIZE (160)
+#endif
+#ifndef XLOG_BODY_BUF_SIZE
+#define XLOG_BODY_BUF_SIZE (384)
+#endif
+#define XLOG_POSTFIX_SIZE (sizeof(XLOG_COLOR_NRM) + 2)
+
+#ifndef XLOG_CONFIG_FILE_DIR_NAME_PRD
+#define XLOG_CONFIG_FILE_DIR_NAME_PRD "/etc"
+#endif
+
+#ifndef XLOG_CONFIG_FILE_DIR_NAME_DEV
+#define XLOG_CONFIG_FILE_DIR_NAME_DEV "/opt"
+#endif
+
+#define XLOG_CONFIG_FILE_NAME      "rdkx_logger.json"
+#define XLOG_CONFIG_FILE_NAME_ROOT "rdkx_logger_"
+
+// Directory of the binary configuration cache.  It should be cleared at boot (ie. tmpfs) so the production flag is read
+// again after an upgrade.
+#ifndef XLOG_CONFIG_CACHE_DIR_NAME
+#define XLOG_CONFIG_CACHE_DIR_NAME "/tmp"
+#endif
+
+// Internal interfaces shared between the library's source files (rdkx_logger.h must be included first)
+int  xlog_output(xlog_level_t level, FILE *stream, int fd, const char *buffer, size_t size);
+int  xlog_outputv(xlog_level_t level, FILE *stream, int fd, const struct iovec *iov, int iovcnt);
+bool xlog_output_user(void); // Records to a stream go to the user print callback
+int  xlog_format_record(const xlog_args_t *args, const struct timeval *tv, char *str, size_t size, const char *body, size_t body_len);
+int  xlog_emitv(const xlog_args_t *args, FILE *stream, int fd, const struct iovec *iov, int iovcnt); // 3 vectors are prefix, body, postfix
+int  xlog_deliverv(const xlog_args_t *args, FILE *stream, int fd, const struct iovec *iov, int iovcnt);
+int  xlog_frame(const xlog_args_t *args, char *prefix, char *postfix, struct iovec *iov);
+int  xlog_config_reload(void);
+int  xlog_vformat(char *str, size_t size, const char *format, va_list ap);
+int  xlog_format_args(char *str, size_t size, const char *format, const xlog_arg_t *argv, uint32_t argc);
+int  xlog_safe_output(const xlog_args_t *args, const struct timeval *tv, FILE *stream, int fd, const char *string, size_t len);
+void xlog_level_update(uint32_t id, xlog_level_t level);
+void xlog_levels_refresh(void);
+bool xlog_module_valid(xlog_module_id_t id); // Generated or registered module
+const char *xlog_module_name_get(xlog_module_id_t id, uint32_t *len);
+xlog_module_id_t xlog_module_to_id(const char *module); // XLOG_MODULE_QTY_MAX if not found
+
+struct json_t;
+struct stat;
+
+// Configuration files which can be used, in order of priority
+#define XLOG_CONFIG_FILE_QTY_MAX  (4)
+#define XLOG_CONFIG_FILE_SIZE_MAX (128)
+
+uint32_t xlog_config_files(xlog_module_id_t id, bool production, char files[][XLOG_CONFIG_FILE_SIZE_MAX]);
+
+extern bool g_xlog_config_cache_enable;
+
+bool xlog_config_cache_load(xlog_module_id_t id, xlog_level_t *levels, char *file, size_t size, int *production);
+int  xlog_config_cache_level(xlog_module_id_t id, const char *name, xlog_level_t *level);
+void xlog_config_cache_store(xlog_module_id_t id, const char *file, const struct stat *source, struct json_t *obj, bool production);
+
+extern volatile bool g_xlog_async;
+
+int  xlog_async_init(const xlog_async_params_t *params);
+void xlog_async_term(void);
+int  xlog_async_enqueue(const xlog_args_t *args, FILE *stream, int fd, const struct iovec *iov, int iovcnt);
+
+bool xlog_site_enabled(const xlog_args_t *args);
+
+// Compressed file format.  The file header is followed by blocks which can each be decoded on their own.  When the file
+// is closed, the block index and the trailer are appended.
+#define XLOG_ZFILE_MAGIC         "XLOGZIP"
+#define XLOG_ZFILE_VERSION       (1)
+#define XLOG_ZFILE_BLOCK_MAGIC   (0x4B4C425A) // "ZBLK"
+#define XLOG_ZFILE_TRAILER_MAGIC (0x58444E5A) // "ZNDX"
+
+#define XLOG_ZFILE_BLOCK_STORED  (0)
+#define XLOG_ZFILE_BLOCK_LZ      (1)
+#define XLOG_ZFILE_BLOCK_ZLIB    (2)
+
+typedef struct {
+   char     magic[8];
+   uint32_t version;
+   uint32_t block_size; // Maximum uncompressed size of a block
+   uint32_t pid;
+   uint32_t reserved;
+} xlog_zfile_header_t;
+
+typedef struct {
+   uint32_t magic;
+   uint16_t codec;     // XLOG_ZFILE_BLOCK_ value
+   uint16_t reserved;
+   uint32_t raw_size;  // Uncompressed size
+   uint32_t data_size; // Size of the data which follows
+   uint64_t timestamp; // Time in us since the epoch of the first record in the block
+} xlog_zfile_block_t;
+
+typedef struct {
+   uint64_t offset;    // Offset of the block header in the file
+   uint64_t timestamp;
+} xlog_zfile_index_entry_t;
+
+typedef struct {
+   uint32_t magic;
+   uint32_t qty;    // Quantity of index entries
+   uint64_t offset; // Offset of the first index entry
+} xlog_zfile_trailer_t;
+
+extern volatile bool g_xlog_zfile;
+extern volatile bool g_xlog_zfile_tee;
+extern __thread bool g_xlog_zfile_compressor_thread; // Records from the compressor thread bypass the file to avoid a deadlock
+
+int    xlog_zfile_write(const struct iovec *iov, int iovcnt);
+size_t xlog_lz_compress(const uint8_t *src, size_t src_len, uint8_t *dst, size_t dst_size);
+int    xlog_lz_decompress(const uint8_t *src, size_t src_len, uint8_t *dst, size_t dst_size);
+
+extern volatile uint32_t g_xlog_sink_qty;
+
+#define XLOG_KV_FORMAT_QTY (3)
+
+// Key/value record encoded in each format requested by the output or a sink (indexed by xlog_kv_format_t)
+typedef struct {
+   struct iovec iov[XLOG_KV_FORMAT_QTY][3];
+   int          iovcnt[XLOG_KV_FORMAT_QTY]; // 0 when the record is not encoded in the format
+} xlog_kv_record_t;
+
+int      xlog_sink_emitv(const xlog_args_t *args, FILE *stream, int fd, const struct iovec *iov, int iovcnt, bool output, const xlog_kv_record_t *kv); // output is cleared to skip XLOG_SINK_TYPE_DEFAULT
+uint32_t xlog_sink_kv_formats(const xlog_args_t *args); // Mask of the key/value formats of the sinks which match the record
+
+typedef struct xlog_socket_s xlog_socket_t;
+
+xlog_socket_t *xlog_socket_open(const xlog_sink_params_t *params);
+void           xlog_socket_close(xlog_socket_t *sock);
+int            xlog_socket_writev(xlog_socket_t *sock, const struct iovec *iov, int iovcnt);
+
+void xlog_stats_output(const xlog_args_t *args, int rc, bool safe);
+void xlog_stats_truncated(xlog_module_id_t id, bool safe); // The block is not allocated when safe is set
+void xlog_stats_suppressed_int(xlog_module_id_t id, xlog_level_t level, bool safe);
+void xlog_stats_error(xlog_module_id_t id);
+void xlog_stats_shed(xlog_module_id_t id);
+
+extern volatile xlog_kv_format_t g_xlog_kv_format;
+
+size_t xlog_kv_text(char *str, size_t size, const char *event, const xlog_kv_t *kvs, uint32_t kv_qty, bool *truncated);
+size_t xlog_kv_json(const xlog_args_t *args, const struct timeval *tv, char *str, size_t size, const char *event, const xlog_kv_t *kvs, uint32_t kv_qty, bool *truncated);
+
+#define XLOG_HEXDUMP_WIDTH_SHIFT    (8)
+#define XLOG_HEXDUMP_WIDTH_DEFAULT  (16)
+#define XLOG_HEXDUMP_WIDTH_MAX      (32)
+#define XLOG_HEXDUMP_LINE_SIZE_MAX  (10 + (XLOG_HEXDUMP_WIDTH_MAX * 4) + 3) // Offset, digits, gutter
+
+uint32_t xlog_hexdump_width(uint32_t flags);
+size_t   xlog_hexdump_line(char *str, const uint8_t *data, size_t qty, size_t offset, uint32_t width, uint32_t flags);
+
+extern volatile bool g_xlog_collapse;
+
+bool xlog_collapse_check(const xlog_args_t *args, FILE *stream, int fd, const char *body, size_t len);
+void xlog_collapse_flush(void);
+
+extern volatile bool         g_xlog_shed;         // Write latency is measured
+extern volatile xlog_level_t g_xlog_shed_level;   // Records below this level are not printed (XLOG_LEVEL_ALL when not shedding)
+extern volatile bool         g_xlog_shed_pending; // A transition is waiting to be reported by xlog_shed_report
+
+uint64_t xlog_shed_write_begin(void);
+void     xlog_shed_write_end(uint64_t begin);
+void     xlog_shed_record(xlog_module_id_t id);
+void     xlog_shed_report(void);
+
+// Shared memory level table.  Levels written to the segment (ie. by xlog-level) are applied to the levels of every
+// attached process.  The entries are indexed by module id so all processes must be built with the same module list.
+#define XLOG_SHM_NAME            "/rdkx_logger_levels"
+#define XLOG_SHM_MAGIC           (0x474F4C58) // "XLOG"
+#define XLOG_SHM_VERSION         (1)
+#define XLOG_SHM_MODULE_QTY_MAX  (256)
+#define XLOG_SHM_LEVEL_UNSET     (0xFF)       // Entry has not been set.  Processes keep their own level.
+#define XLOG_SHM_CACHE_LINE_SIZE (64)
+
+typedef struct {
+   uint32_t          magic;        // Written last by the creator once the segment is initialized
+   uint32_t          version;      // Layout version
+   uint32_t          size;         // Size of the segment
+   uint32_t          module_qty;   // Quantity of modules in the module list
+   uint32_t          modules_hash; // Hash of the module names.  Processes with a different module list don't attach.
+   volatile uint32_t generation;   // Incremented after each change.  Attached processes wait on it with a futex.
+   // Keep the levels on their own cache lines so the header is not written by level changes
+   volatile uint8_t  levels[XLOG_SHM_MODULE_QTY_MAX] __attribute__((aligned(XLOG_SHM_CACHE_LINE_SIZE)));
+} xlog_shm_t;
+
+xlog_shm_t *xlog_shm_open(bool create, bool writable);
+void        xlog_shm_close(xlog_shm_t *shm);
+void        xlog_shm_notify(xlog_shm_t *shm);
+
+// Flight recorder file format.  The file is a header followed by a power of two quantity of fixed size slots.  Records are
+// written to the slot at (head % slot_qty) so the file holds the most recent slot_qty records.
+#define XLOG_RECORDER_MAGIC     "XLOGREC"
+#define XLOG_RECORDER_VERSION   (1)
+#define XLOG_RECORDER_SLOT_SIZE (256)
+
+typedef struct {
+   char              magic[8];    // XLOG_RECORDER_MAGIC
+   uint32_t          version;     // Layout version
+   uint32_t          header_size; // Offset of the first slot
+   uint32_t          slot_size;   // Size of each slot
+   uint32_t          slot_qty;    // Quantity of slots (power of two)
+   uint32_t          pid;         // Process which wrote the file
+   uint32_t          reserved;
+   // Keep the head on its own cache line so the writers don't share it with the read-only fields
+   volatile uint64_t head __attribute__((aligned(XLOG_SHM_CACHE_LINE_SIZE))); // Quantity of slots claimed
+} xlog_recorder_header_t;
+
+typedef struct {
+   volatile uint32_t seq;          // Low 32 bits of the slot's position + 1 when complete or 0 while it is written
+   uint16_t          id;           // Module id
+   uint8_t           level;        // Level
+   uint8_t           function_len; // Length of the function name at the start of text
+   uint32_t          line;         // Line number
+   uint32_t          options;      // XLOG_OPTS_ options (without color)
+   int64_t           tv_sec;       // Time the record was written
+   uint32_t          tv_usec;
+   uint16_t          len;          // Length of the body which follows the function name in text
+   uint16_t          reserved;
+   char              text[XLOG_RECORDER_SLOT_SIZE - 32];
+} xlog_recorder_slot_t;
+
+// Called for each complete record from oldest to newest
+typedef void (*xlog_recorder_callback_t)(const xlog_args_t *args, const struct timeval *tv, const char *body, size_t len, void *data);
+
+extern volatile xlog_level_t g_xlog_recorder_level;
+
+bool xlog_recorder_valid(const xlog_recorder_header_t *rec, size_t size);
+int  xlog_recorder_foreach(const xlog_recorder_header_t *rec, xlog_recorder_callback_t callback, void *data);
+void xlog_recorder_write(const xlog_args_t *args, const char *body, size_t len);
+int  xlog_recorder_vwrite(const xlog_args_t *args, const char *format, va_list ap);
+int  xlog_recorder_dump_output(FILE *stream, int fd);
+
+// Binary log format
+#define XLOG_BINARY_MAGIC   "XLOGBIN"
+#define XLOG_BINARY_VERSION (1)
+
+typedef enum {
+   XLOG_BINARY_RECORD_SESSION = 1, // Start of a process' output.  Resets the site dictionary.
+   XLOG_BINARY_RECORD_SITE    = 2, // Dictionary entry for a call site
+   XLOG_BINARY_RECORD_LOG     = 3  // Log record for a call site
+} xlog_binary_record_type_t;
+
+// All records start with this header.  Values are stored in host byte order.
+typedef struct {
+   uint32_t size; // Size of the record including this header
+   uint16_t type; // xlog_binary_record_type_t
+   uint16_t reserved;
+} xlog_binary_record_t;
+
+typedef enum {
+   XLOG_BINARY_ARG_INT,     // int (including char, short and unsigned variants)
+   XLOG_BINARY_ARG_LONG,    // long
+   XLOG_BINARY_ARG_LLONG,   // long long
+   XLOG_BINARY_ARG_SIZE,    // size_t
+   XLOG_BINARY_ARG_INTMAX,  // intmax_t
+   XLOG_BINARY_ARG_PTRDIFF, // ptrdiff_t
+   XLOG_BINARY_ARG_PTR,     // void *
+   XLOG_BINARY_ARG_DOUBLE,  // double
+   XLOG_BINARY_ARG_LDOUBLE, // long double
+   XLOG_BINARY_ARG_STRING,  // char * (copied inline)
+   XLOG_BINARY_ARG_ERRNO,   // %m (errno is recorded)
+   XLOG_BINARY_ARG_INVALID  // Not supported.  Records for the site contain the formatted text.
+} xlog_binary_arg_t;
+
+typedef struct {
+   const char *      start;     // Start of the conversion specification or NULL if there are no more
+   uint32_t          len;       // Length of the conversion specification
+   bool              width_arg; // Width is passed as an int argument
+   bool              prec_arg;  // Precision is passed as an int argument
+   xlog_binary_arg_t type;
+} xlog_binary_spec_t;
+
+extern volatile bool g_xlog_binary_modules[];
+
+const char *xlog_binary_spec_next(const char *format, xlog_binary_spec_t *spec);
+int         xlog_binary_write(const xlog_args_t *args, const char *format, va_list ap);
+#endif
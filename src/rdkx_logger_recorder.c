@@ -0,0 +1,326 @@
+/*
+##########################################################################
+# If not stated otherwise in this file or this component's LICENSE
+# file the following copyright and licenses apply:
+#
+# Copyright 2019 RDK Management
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+##########################################################################
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+#include "rdkx_logger.h"
+#include "rdkx_logger_private.h"
+
+// The ring is in a MAP_SHARED file mapping so the records written before a crash are in the page cache and survive the
+// process.  Writers claim a slot with one atomic increment of the head and mark it complete by storing its sequence last.
+// Records which are overwritten while they are read are skipped.  Writers and dumps are counted while they use the mapping
+// so it isn't unmapped under them by xlog_recorder_close (a lock can't be used since they run in signal handlers).
+
+#define XLOG_RECORDER_SLOT_QTY_MIN     (16)
+#define XLOG_RECORDER_FUNCTION_LEN_MAX (63) // Longer function names are truncated to leave room for the body
+
+volatile xlog_level_t g_xlog_recorder_level = XLOG_LEVEL_INVALID;
+
+static xlog_recorder_header_t *g_xlog_recorder         = NULL;
+static size_t                  g_xlog_recorder_size    = 0;
+static volatile bool           g_xlog_recorder_dumping = false;
+static uint32_t                g_xlog_recorder_users   = 0;
+
+static xlog_recorder_header_t *xlog_recorder_get(void);
+static void                    xlog_recorder_put(void);
+static xlog_recorder_slot_t   *xlog_recorder_slot_claim(xlog_recorder_header_t *rec, const xlog_args_t *args, uint64_t *pos);
+static void                    xlog_recorder_slot_commit(xlog_recorder_slot_t *slot, uint64_t pos);
+static void                    xlog_recorder_dump_record(const xlog_args_t *args, const struct timeval *tv, const char *body, size_t len, void *data);
+
+typedef struct {
+   FILE *stream;
+   int   fd;
+} xlog_recorder_dump_t;
+
+int xlog_recorder_open(const char *filename, uint32_t size, xlog_level_t level) {
+   if(filename == NULL || ((uint32_t)level) >= XLOG_LEVEL_INVALID) {
+      XLOGD_ERROR("invalid params");
+      return(-1);
+   }
+   if(g_xlog_recorder != NULL) {
+      XLOGD_WARN("already open");
+      return(-1);
+   }
+   // Round the quantity of slots down to a power of two
+   uint32_t slot_qty = XLOG_RECORDER_SLOT_QTY_MIN;
+   while(size >= sizeof(xlog_recorder_header_t) + (size_t)slot_qty * 2 * XLOG_RECORDER_SLOT_SIZE && slot_qty < (1u << 30)) {
+      slot_qty *= 2;
+   }
+   size_t total = sizeof(xlog_recorder_header_t) + (size_t)slot_qty * XLOG_RECORDER_SLOT_SIZE;
+
+   // Keep the previous process' records (ie. from before a crash and restart)
+   char prev[PATH_MAX];
+   if(snprintf(prev, sizeof(prev), "%s.prev", filename) < (int)sizeof(prev) && 0 == access(filename, F_OK)) {
+      if(rename(filename, prev) < 0) {
+         int errsv = errno;
+         XLOGD_WARN("unable to rename <%s> <%s>", filename, strerror(errsv));
+      }
+   }
+
+   int fd = open(filename, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+   if(fd < 0) {
+      int errsv = errno;
+      XLOGD_ERROR("unable to open <%s> <%s>", filename, strerror(errsv));
+      return(-1);
+   }
+   if(ftruncate(fd, total) < 0) {
+      int errsv = errno;
+      XLOGD_ERROR("unable to size <%s> <%s>", filename, strerror(errsv));
+      close(fd);
+      return(-1);
+   }
+   xlog_recorder_header_t *rec = (xlog_recorder_header_t *)mmap(NULL, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+   close(fd);
+   if(rec == MAP_FAILED) {
+      int errsv = errno;
+      XLOGD_ERROR("unable to map <%s> <%s>", filename, strerror(errsv));
+      return(-1);
+   }
+
+   // The file is zero filled so all slots start out incomplete
+   memcpy(rec->magic, XLOG_RECORDER_MAGIC, sizeof(rec->magic));
+   rec->version     = XLOG_RECORDER_VERSION;
+   rec->header_size = sizeof(xlog_recorder_header_t);
+   rec->slot_size   = XLOG_RECORDER_SLOT_SIZE;
+   rec->slot_qty    = slot_qty;
+   rec->pid         = getpid();
+   rec->head        = 0;
+
+   g_xlog_recorder_size = total;
+   __atomic_store_n(&g_xlog_recorder, rec, __ATOMIC_RELEASE);
+   __atomic_store_n(&g_xlog_recorder_level, level, __ATOMIC_RELEASE);
+   xlog_levels_refresh();
+
+   XLOGD_INFO("file <%s> records <%u> level <%d>", filename, slot_qty, level);
+   return(0);
+}
+
+void xlog_recorder_close(void) {
+   xlog_recorder_header_t *rec = g_xlog_recorder;
+   if(rec == NULL) {
+      return;
+   }
+   __atomic_store_n(&g_xlog_recorder_level, XLOG_LEVEL_INVALID, __ATOMIC_RELEASE);
+   xlog_levels_refresh();
+   __atomic_store_n(&g_xlog_recorder, NULL, __ATOMIC_SEQ_CST);
+
+   // Wait for the writers which loaded the mapping before it was cleared
+   while(__atomic_load_n(&g_xlog_recorder_users, __ATOMIC_SEQ_CST) != 0) {
+      sched_yield();
+   }
+
+   // The file is left in place so it can be read after the process exits
+   munmap(rec, g_xlog_recorder_size);
+   g_xlog_recorder_size = 0;
+}
+
+xlog_recorder_header_t *xlog_recorder_get(void) {
+   // The count is raised before the mapping is loaded so xlog_recorder_close either sees the count or this sees NULL
+   __atomic_add_fetch(&g_xlog_recorder_users, 1, __ATOMIC_SEQ_CST);
+   xlog_recorder_header_t *rec = __atomic_load_n(&g_xlog_recorder, __ATOMIC_SEQ_CST);
+   if(rec == NULL) {
+      xlog_recorder_put();
+   }
+   return(rec);
+}
+
+void xlog_recorder_put(void) {
+   __atomic_sub_fetch(&g_xlog_recorder_users, 1, __ATOMIC_RELEASE);
+}
+
+xlog_recorder_slot_t *xlog_recorder_slot_claim(xlog_recorder_header_t *rec, const xlog_args_t *args, uint64_t *pos) {
+   *pos = __atomic_fetch_add(&rec->head, 1, __ATOMIC_RELAXED);
+
+   xlog_recorder_slot_t *slot = (xlog_recorder_slot_t *)((char *)rec + rec->header_size + (*pos & (rec->slot_qty - 1)) * XLOG_RECORDER_SLOT_SIZE);
+
+   __atomic_store_n(&slot->seq, 0, __ATOMIC_RELAXED);
+   __atomic_thread_fence(__ATOMIC_RELEASE);
+
+   struct timeval tv;
+   gettimeofday(&tv, NULL);
+
+   size_t function_len = (args->function != NULL) ? strnlen(args->function, XLOG_RECORDER_FUNCTION_LEN_MAX) : 0;
+
+   slot->id           = args->id;
+   slot->level        = args->level;
+   slot->function_len = function_len;
+   slot->line         = args->line;
+   slot->options      = args->options & ~(XLOG_OPTS_COLOR | XLOG_OPTS_SITE | XLOG_OPTS_TID | XLOG_OPTS_TNAME); // The dump is formatted by another thread
+   slot->tv_sec       = tv.tv_sec;
+   slot->tv_usec      = tv.tv_usec;
+   slot->len          = 0;
+   memcpy(slot->text, args->function, function_len);
+
+   return(slot);
+}
+
+void xlog_recorder_slot_commit(xlog_recorder_slot_t *slot, uint64_t pos) {
+   __atomic_store_n(&slot->seq, (uint32_t)pos + 1, __ATOMIC_RELEASE);
+}
+
+void xlog_recorder_write(const xlog_args_t *args, const char *body, size_t len) {
+   if(args->level < g_xlog_recorder_level) {
+      return;
+   }
+   xlog_recorder_header_t *rec = xlog_recorder_get();
+   if(rec == NULL) {
+      return;
+   }
+   uint64_t              pos;
+   xlog_recorder_slot_t *slot  = xlog_recorder_slot_claim(rec, args, &pos);
+   size_t                avail = sizeof(slot->text) - slot->function_len;
+
+   if(len > avail) { // Truncated
+      len = avail;
+   }
+   memcpy(&slot->text[slot->function_len], body, len);
+   slot->len = len;
+
+   xlog_recorder_slot_commit(slot, pos);
+   xlog_recorder_put();
+}
+
+int xlog_recorder_vwrite(const xlog_args_t *args, const char *format, va_list ap) {
+   if(args->level < g_xlog_recorder_level) {
+      return(0);
+   }
+   xlog_recorder_header_t *rec = xlog_recorder_get();
+   if(rec == NULL) {
+      return(0);
+   }
+   uint64_t              pos;
+   xlog_recorder_slot_t *slot  = xlog_recorder_slot_claim(rec, args, &pos);
+   size_t                avail = sizeof(slot->text) - slot->function_len;
+
+   // Format directly into the slot
+   int rc = xlog_vformat(&slot->text[slot->function_len], avail, format, ap);
+   if(rc < 0) {
+      rc = 0;
+   } else if((size_t)rc >= avail) { // Truncated (the terminating null is not kept)
+      rc = avail - 1;
+   }
+   slot->len = rc;
+
+   xlog_recorder_slot_commit(slot, pos);
+   xlog_recorder_put();
+   return(0);
+}
+
+bool xlog_recorder_valid(const xlog_recorder_header_t *rec, size_t size) {
+   if(size < sizeof(xlog_recorder_header_t) || 0 != memcmp(rec->magic, XLOG_RECORDER_MAGIC, sizeof(rec->magic))) {
+      return(false);
+   }
+   if(rec->version != XLOG_RECORDER_VERSION || rec->header_size != sizeof(xlog_recorder_header_t) || rec->slot_size != XLOG_RECORDER_SLOT_SIZE) {
+      return(false);
+   }
+   if(rec->slot_qty == 0 || (rec->slot_qty & (rec->slot_qty - 1)) != 0) {
+      return(false);
+   }
+   return(size >= rec->header_size + (size_t)rec->slot_qty * rec->slot_size);
+}
+
+int xlog_recorder_foreach(const xlog_recorder_header_t *rec, xlog_recorder_callback_t callback, void *data) {
+   uint64_t head  = __atomic_load_n(&rec->head, __ATOMIC_ACQUIRE);
+   uint64_t first = (head > rec->slot_qty) ? head - rec->slot_qty : 0;
+   int      qty   = 0;
+
+   for(uint64_t pos = first; pos < head; pos++) {
+      const xlog_recorder_slot_t *slot = (const xlog_recorder_slot_t *)((const char *)rec + rec->header_size + (pos & (rec->slot_qty - 1)) * rec->slot_size);
+      xlog_recorder_slot_t        copy;
+      char                        function[UINT8_MAX + 1];
+
+      // Copy the slot and check that it was not rewritten during the copy
+      if(__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != (uint32_t)pos + 1) {
+         continue;
+      }
+      memcpy(&copy, (const void *)slot, sizeof(copy));
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      if(__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) != (uint32_t)pos + 1) {
+         continue;
+      }
+      if((size_t)copy.function_len + copy.len > sizeof(copy.text) || !xlog_module_valid(copy.id)) {
+         continue;
+      }
+      memcpy(function, copy.text, copy.function_len);
+      function[copy.function_len] = '\0';
+
+      xlog_args_t args = {
+         .options  = copy.options,
+         .color    = XLOG_COLOR_NONE,
+         .function = (copy.function_len > 0) ? function : XLOG_FUNCTION_NONE,
+         .line     = copy.line,
+         .level    = copy.level,
+         .id       = copy.id
+      };
+      struct timeval tv = { .tv_sec = copy.tv_sec, .tv_usec = copy.tv_usec };
+
+      callback(&args, &tv, &copy.text[copy.function_len], copy.len, data);
+      qty++;
+   }
+   return(qty);
+}
+
+int xlog_recorder_dump(FILE *stream) {
+   if(stream == NULL) {
+      return(-1);
+   }
+   return(xlog_recorder_dump_output(stream, -1));
+}
+
+int xlog_recorder_dump_output(FILE *stream, int fd) {
+   // Asynchronous safe.  Records are printed through the same path as xlog_fprintf_safe.
+   xlog_recorder_header_t *rec = xlog_recorder_get();
+   if(rec == NULL) {
+      return(-1);
+   }
+   // A FATAL record printed by a signal handler during a dump would start another one
+   if(__atomic_exchange_n(&g_xlog_recorder_dumping, true, __ATOMIC_ACQUIRE)) {
+      xlog_recorder_put();
+      return(-1);
+   }
+   xlog_recorder_dump_t dump    = { .stream = stream, .fd = fd };
+   xlog_args_t          args    = { .options = XLOG_OPTS_DEFAULT & ~XLOG_OPTS_COLOR, .color = XLOG_COLOR_NONE, .function = XLOG_FUNCTION_NONE, .line = XLOG_LINE_NONE, .level = XLOG_LEVEL_FATAL, .id = XLOG_MODULE_ID_XLOG };
+   const char           begin[] = "flight recorder begin";
+   const char           end[]   = "flight recorder end";
+
+   xlog_safe_output(&args, NULL, stream, fd, begin, sizeof(begin) - 1);
+   int qty = xlog_recorder_foreach(rec, xlog_recorder_dump_record, &dump);
+   xlog_safe_output(&args, NULL, stream, fd, end, sizeof(end) - 1);
+
+   __atomic_store_n(&g_xlog_recorder_dumping, false, __ATOMIC_RELEASE);
+   xlog_recorder_put();
+   return(qty);
+}
+
+void xlog_recorder_dump_record(const xlog_args_t *args, const struct timeval *tv, const char *body, size_t len, void *data) {
+   xlog_recorder_dump_t *dump = (xlog_recorder_dump_t *)data;
+   xlog_safe_output(args, tv, dump->stream, dump->fd, body, len);
+}
@@ -0,0 +1,241 @@
+/*
+##########################################################################
+# If not stated otherwise in this file or this component's LICENSE
+# file the following copyright and licenses apply:
+#
+# Copyright 2019 RDK Management
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+##########################################################################
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <time.h>
+#include <pthread.h>
+#include "rdkx_logger.h"
+#include "rdkx_logger_private.h"
+
+// The latency of each synchronous write to the output, including the wait for the stream lock, is averaged.  When the
+// average reaches the budget, records below the shed level are no longer printed (they are still written to the flight
+// recorder).  Printing resumes once no write has exceeded the recovery latency for the hold time and none is in progress.
+// The print levels are not changed so the levels set by xlog_level_set or the configuration file are the floor which is
+// restored.  The records shed are counted per module in the statistics.  The transitions are detected inside the write
+// path so they are only saved there and reported at the start of the next record (see xlog_shed_report).
+
+#define XLOG_SHED_HOLD_DEFAULT_MS (1000)
+#define XLOG_SHED_AVERAGE_SHIFT   (3) // Each write has a weight of 1/8 in the average
+
+#ifdef CLOCK_MONOTONIC_COARSE
+#define XLOG_SHED_CLOCK_COARSE CLOCK_MONOTONIC_COARSE
+#else
+#define XLOG_SHED_CLOCK_COARSE CLOCK_MONOTONIC
+#endif
+
+typedef struct {
+   bool        enter;    // Shedding is starting (the level is raised once this is reported)
+   uint64_t    average;  // Average write latency in ns when the budget was exceeded
+   const char *reason;   // Reason shedding stopped
+   int64_t     duration; // Time in ns spent shedding
+   uint64_t    shed;     // Records shed
+} xlog_shed_transition_t;
+
+volatile bool         g_xlog_shed         = false;
+volatile xlog_level_t g_xlog_shed_level   = XLOG_LEVEL_ALL;
+volatile bool         g_xlog_shed_pending = false;
+
+static pthread_mutex_t        g_xlog_shed_mutex    = PTHREAD_MUTEX_INITIALIZER; // Serializes the transitions
+static uint64_t               g_xlog_shed_budget   = 0;                 // Average latency in ns at which records are shed
+static uint64_t               g_xlog_shed_recover  = 0;                 // Latency in ns under which a write is considered recovered
+static uint64_t               g_xlog_shed_hold     = 0;                 // Time in ns without a slow write before printing resumes
+static xlog_level_t           g_xlog_shed_params_level;                 // Level applied when the budget is exceeded
+static uint64_t               g_xlog_shed_average  = 0;                 // Average write latency in ns
+static uint64_t               g_xlog_shed_slow     = 0;                 // Time of the last write over the recovery latency
+static uint32_t               g_xlog_shed_writes   = 0;                 // Writes in progress
+static uint64_t               g_xlog_shed_begin    = 0;                 // Time at which shedding started
+static uint64_t               g_xlog_shed_base     = 0;                 // Records shed before shedding started
+static bool                   g_xlog_shed_entering = false;             // The budget was exceeded and the level is not raised yet
+static xlog_shed_transition_t g_xlog_shed_transition;                   // Transition which is not reported yet
+
+static uint64_t xlog_shed_time_ns(clockid_t clock);
+static uint64_t xlog_shed_total(void);
+static void     xlog_shed_enter(uint64_t now, uint64_t average);
+static void     xlog_shed_check(uint64_t now);
+static void     xlog_shed_exit(uint64_t now, const char *reason);
+
+int xlog_shed_start(const xlog_shed_params_t *params) {
+   if(params == NULL || params->budget == 0) {
+      XLOGD_ERROR("invalid params");
+      return(-1);
+   }
+   if(params->level <= XLOG_LEVEL_DEBUG || params->level >= XLOG_LEVEL_INVALID) {
+      XLOGD_ERROR("invalid level <%d>", params->level);
+      return(-1);
+   }
+   uint32_t recover = (params->recover == 0) ? params->budget / 2 : params->recover;
+   if(recover > params->budget) {
+      XLOGD_ERROR("recover <%u us> is over budget <%u us>", recover, params->budget);
+      return(-1);
+   }
+   uint32_t hold = (params->hold == 0) ? XLOG_SHED_HOLD_DEFAULT_MS : params->hold;
+
+   pthread_mutex_lock(&g_xlog_shed_mutex);
+   __atomic_store_n(&g_xlog_shed_budget,  (uint64_t)params->budget * 1000, __ATOMIC_RELAXED);
+   __atomic_store_n(&g_xlog_shed_recover, (uint64_t)recover * 1000,        __ATOMIC_RELAXED);
+   __atomic_store_n(&g_xlog_shed_hold,    (uint64_t)hold * 1000000,        __ATOMIC_RELAXED);
+   g_xlog_shed_params_level = params->level;
+   if(g_xlog_shed_level != XLOG_LEVEL_ALL) { // Already shedding.  Apply the new level.
+      __atomic_store_n(&g_xlog_shed_level, params->level, __ATOMIC_RELAXED);
+   }
+   __atomic_store_n(&g_xlog_shed, true, __ATOMIC_RELAXED);
+   pthread_mutex_unlock(&g_xlog_shed_mutex);
+   return(0);
+}
+
+void xlog_shed_stop(void) {
+   pthread_mutex_lock(&g_xlog_shed_mutex);
+   __atomic_store_n(&g_xlog_shed, false, __ATOMIC_RELAXED);
+   if(g_xlog_shed_entering) { // Stopped before the level was raised
+      g_xlog_shed_entering = false;
+      __atomic_store_n(&g_xlog_shed_pending, false, __ATOMIC_RELAXED);
+   }
+   if(g_xlog_shed_level != XLOG_LEVEL_ALL) {
+      xlog_shed_exit(xlog_shed_time_ns(CLOCK_MONOTONIC), "stopped");
+   }
+   __atomic_store_n(&g_xlog_shed_average, 0, __ATOMIC_RELAXED);
+   pthread_mutex_unlock(&g_xlog_shed_mutex);
+   xlog_shed_report();
+}
+
+uint64_t xlog_shed_write_begin(void) {
+   __atomic_add_fetch(&g_xlog_shed_writes, 1, __ATOMIC_RELAXED);
+   return(xlog_shed_time_ns(CLOCK_MONOTONIC));
+}
+
+void xlog_shed_write_end(uint64_t begin) {
+   uint64_t now     = xlog_shed_time_ns(CLOCK_MONOTONIC);
+   uint64_t latency = now - begin;
+
+   __atomic_sub_fetch(&g_xlog_shed_writes, 1, __ATOMIC_RELAXED);
+
+   // Updated without a lock.  A sample lost to a concurrent update does not change the average much.
+   uint64_t average = __atomic_load_n(&g_xlog_shed_average, __ATOMIC_RELAXED);
+   average = average - (average >> XLOG_SHED_AVERAGE_SHIFT) + (latency >> XLOG_SHED_AVERAGE_SHIFT);
+   __atomic_store_n(&g_xlog_shed_average, average, __ATOMIC_RELAXED);
+
+   if(latency >= __atomic_load_n(&g_xlog_shed_recover, __ATOMIC_RELAXED)) {
+      __atomic_store_n(&g_xlog_shed_slow, now, __ATOMIC_RELAXED);
+   }
+   if(g_xlog_shed_level == XLOG_LEVEL_ALL) {
+      if(average >= __atomic_load_n(&g_xlog_shed_budget, __ATOMIC_RELAXED)) {
+         xlog_shed_enter(now, average);
+      }
+   } else {
+      xlog_shed_check(now);
+   }
+}
+
+void xlog_shed_report(void) {
+   // Called outside of the write path (ie. before a record is delivered) so the report can be logged
+   pthread_mutex_lock(&g_xlog_shed_mutex);
+   if(!g_xlog_shed_pending) {
+      pthread_mutex_unlock(&g_xlog_shed_mutex);
+      return;
+   }
+   xlog_shed_transition_t transition = g_xlog_shed_transition;
+   __atomic_store_n(&g_xlog_shed_pending, false, __ATOMIC_RELAXED);
+   pthread_mutex_unlock(&g_xlog_shed_mutex);
+
+   if(!transition.enter) {
+      XLOGD_INFO("shedding %s after <%lld ms> records shed <%llu>", transition.reason, (long long)((transition.duration < 0) ? 0 : transition.duration / 1000000),
+                 (unsigned long long)transition.shed);
+      return;
+   }
+   static const char *names[] = { "ALL", "DEBUG", "INFO", "WARN", "ERROR", "FATAL" };
+
+   // Reported before the level is raised so the record is not shed
+   XLOGD_WARN("write latency <%llu us> over budget <%llu us>, shedding records below <%s>", (unsigned long long)(transition.average / 1000),
+              (unsigned long long)(__atomic_load_n(&g_xlog_shed_budget, __ATOMIC_RELAXED) / 1000), names[g_xlog_shed_params_level]);
+
+   pthread_mutex_lock(&g_xlog_shed_mutex);
+   if(g_xlog_shed_entering) {
+      g_xlog_shed_entering = false;
+      __atomic_store_n(&g_xlog_shed_slow, xlog_shed_time_ns(CLOCK_MONOTONIC), __ATOMIC_RELAXED);
+      __atomic_store_n(&g_xlog_shed_level, g_xlog_shed_params_level, __ATOMIC_RELAXED);
+   }
+   pthread_mutex_unlock(&g_xlog_shed_mutex);
+}
+
+void xlog_shed_record(xlog_module_id_t id) {
+   xlog_stats_shed(id);
+   xlog_shed_check(xlog_shed_time_ns(XLOG_SHED_CLOCK_COARSE));
+}
+
+uint64_t xlog_shed_time_ns(clockid_t clock) {
+   struct timespec ts;
+   clock_gettime(clock, &ts);
+   return(((uint64_t)ts.tv_sec * 1000000000) + ts.tv_nsec);
+}
+
+uint64_t xlog_shed_total(void) {
+   xlog_stats_t stats;
+   if(xlog_stats_get(XLOG_MODULE_ID_INVALID, &stats) < 0) {
+      return(0);
+   }
+   return(stats.shed);
+}
+
+void xlog_shed_enter(uint64_t now, uint64_t average) {
+   // A thread which is already changing the state (or this thread, while reporting) skips the transition
+   if(0 != pthread_mutex_trylock(&g_xlog_shed_mutex)) {
+      return;
+   }
+   if(g_xlog_shed && g_xlog_shed_level == XLOG_LEVEL_ALL && !g_xlog_shed_entering) {
+      g_xlog_shed_begin    = now;
+      g_xlog_shed_base     = xlog_shed_total();
+      g_xlog_shed_entering = true;
+      __atomic_store_n(&g_xlog_shed_slow, now, __ATOMIC_RELAXED);
+
+      // The level is raised by xlog_shed_report once the transition has been reported
+      g_xlog_shed_transition = (xlog_shed_transition_t){ .enter = true, .average = average };
+      __atomic_store_n(&g_xlog_shed_pending, true, __ATOMIC_RELAXED);
+   }
+   pthread_mutex_unlock(&g_xlog_shed_mutex);
+}
+
+void xlog_shed_check(uint64_t now) {
+   // The coarse clock may be behind the time of the last slow write
+   int64_t elapsed = (int64_t)(now - __atomic_load_n(&g_xlog_shed_slow, __ATOMIC_RELAXED));
+   if(elapsed < (int64_t)__atomic_load_n(&g_xlog_shed_hold, __ATOMIC_RELAXED) || __atomic_load_n(&g_xlog_shed_writes, __ATOMIC_RELAXED) != 0) {
+      return;
+   }
+   if(0 != pthread_mutex_trylock(&g_xlog_shed_mutex)) {
+      return;
+   }
+   if(g_xlog_shed_level != XLOG_LEVEL_ALL) {
+      xlog_shed_exit(now, "recovered");
+   }
+   pthread_mutex_unlock(&g_xlog_shed_mutex);
+}
+
+void xlog_shed_exit(uint64_t now, const char *reason) {
+   // Called with the mutex held.  The average starts over so the writes of the previous stall don't trigger it again.
+   __atomic_store_n(&g_xlog_shed_level, XLOG_LEVEL_ALL, __ATOMIC_RELAXED);
+   __atomic_store_n(&g_xlog_shed_average, 0, __ATOMIC_RELAXED);
+
+   g_xlog_shed_transition = (xlog_shed_transition_t){ .enter = false, .reason = reason, .duration = (int64_t)(now - g_xlog_shed_begin),
+                                                      .shed = xlog_shed_total() - g_xlog_shed_base };
+   __atomic_store_n(&g_xlog_shed_pending, true, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,249 @@
+/*
+##########################################################################
+# If not stated otherwise in this file or this component's LICENSE
+# file the following copyright and licenses apply:
+#
+# Copyright 2019 RDK Management
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+##########################################################################
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include "rdkx_logger.h"
+#include "rdkx_logger_private.h"
+
+// The XLOG macros read the level from the process' own g_xlog_modules array, so the level check stays a single load.  A
+// thread waits on the segment's generation counter and applies changed entries to the process' levels.
+
+#if XLOG_MODULE_QTY_MAX > XLOG_SHM_MODULE_QTY_MAX
+#error XLOG_SHM_MODULE_QTY_MAX is too small for the module list
+#endif
+
+#define XLOG_SHM_INIT_TIMEOUT_MS (100) // Maximum time to wait for the creator to initialize the segment
+#define XLOG_SHM_WAIT_TIMEOUT_S  (1)   // Maximum time the thread waits before checking if it should stop
+
+static xlog_shm_t *   g_xlog_shm         = NULL;
+static volatile bool  g_xlog_shm_running = false;
+static pthread_t      g_xlog_shm_thread;
+static uint8_t        g_xlog_shm_applied[XLOG_MODULE_QTY_MAX]; // Last value seen for each entry
+
+extern const char * const g_xlog_module_id_to_str[];
+
+static void *   xlog_shm_thread(void *data);
+static void     xlog_shm_apply(xlog_shm_t *shm, bool all);
+static uint32_t xlog_shm_modules_hash(void);
+
+int xlog_shm_attach(void) {
+   if(g_xlog_shm != NULL) {
+      XLOGD_WARN("already attached");
+      return(-1);
+   }
+   // Processes which only read the levels don't need write access to the segment
+   xlog_shm_t *shm = xlog_shm_open(true, true);
+   if(shm == NULL) {
+      shm = xlog_shm_open(false, false);
+   }
+   if(shm == NULL) {
+      return(-1);
+   }
+
+   for(uint32_t index = 0; index < XLOG_MODULE_QTY_MAX; index++) {
+      g_xlog_shm_applied[index] = XLOG_SHM_LEVEL_UNSET;
+   }
+   xlog_shm_apply(shm, true);
+
+   g_xlog_shm         = shm;
+   g_xlog_shm_running = true;
+   if(0 != pthread_create(&g_xlog_shm_thread, NULL, xlog_shm_thread, NULL)) {
+      XLOGD_ERROR("unable to create thread");
+      g_xlog_shm_running = false;
+      g_xlog_shm         = NULL;
+      xlog_shm_close(shm);
+      return(-1);
+   }
+   return(0);
+}
+
+void xlog_shm_detach(void) {
+   if(g_xlog_shm == NULL) {
+      return;
+   }
+   __atomic_store_n(&g_xlog_shm_running, false, __ATOMIC_SEQ_CST);
+   // Waiters in other processes wake too, but they go back to waiting as the generation has not changed
+   syscall(SYS_futex, &g_xlog_shm->generation, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+   pthread_join(g_xlog_shm_thread, NULL);
+
+   xlog_shm_close(g_xlog_shm);
+   g_xlog_shm = NULL;
+}
+
+xlog_shm_t *xlog_shm_open(bool create, bool writable) {
+   bool created = false;
+   int  fd      = -1;
+
+   if(create) {
+      fd = shm_open(XLOG_SHM_NAME, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+      if(fd >= 0) {
+         created = true;
+         if(ftruncate(fd, sizeof(xlog_shm_t)) < 0) {
+            int errsv = errno;
+            XLOGD_ERROR("unable to size segment <%s>", strerror(errsv));
+            close(fd);
+            shm_unlink(XLOG_SHM_NAME);
+            return(NULL);
+         }
+      }
+   }
+   if(fd < 0) {
+      fd = shm_open(XLOG_SHM_NAME, (writable ? O_RDWR : O_RDONLY) | O_CLOEXEC, 0);
+   }
+   if(fd < 0) {
+      int errsv = errno;
+      if(!create || errsv != EACCES) {
+         XLOGD_WARN("unable to open <%s> <%s>", XLOG_SHM_NAME, strerror(errsv));
+      }
+      return(NULL);
+   }
+
+   struct stat st;
+   if(fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(xlog_shm_t)) {
+      if(!created) { // The creator may not have sized the segment yet
+         usleep(XLOG_SHM_INIT_TIMEOUT_MS * 1000);
+      }
+      if(fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(xlog_shm_t)) {
+         XLOGD_ERROR("invalid segment size");
+         close(fd);
+         return(NULL);
+      }
+   }
+
+   xlog_shm_t *shm = (xlog_shm_t *)mmap(NULL, sizeof(xlog_shm_t), writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd, 0);
+   close(fd);
+   if(shm == MAP_FAILED) {
+      int errsv = errno;
+      XLOGD_ERROR("unable to map segment <%s>", strerror(errsv));
+      return(NULL);
+   }
+
+   if(created) {
+      memset((void *)shm->levels, XLOG_SHM_LEVEL_UNSET, sizeof(shm->levels));
+      shm->version      = XLOG_SHM_VERSION;
+      shm->size         = sizeof(xlog_shm_t);
+      shm->module_qty   = XLOG_MODULE_QTY_MAX;
+      shm->modules_hash = xlog_shm_modules_hash();
+      shm->generation   = 0;
+      __atomic_store_n(&shm->magic, XLOG_SHM_MAGIC, __ATOMIC_RELEASE);
+   } else {
+      for(uint32_t wait = 0; __atomic_load_n(&shm->magic, __ATOMIC_ACQUIRE) != XLOG_SHM_MAGIC && wait < XLOG_SHM_INIT_TIMEOUT_MS; wait++) {
+         usleep(1000);
+      }
+   }
+
+   if(shm->magic != XLOG_SHM_MAGIC || shm->version != XLOG_SHM_VERSION || shm->size != sizeof(xlog_shm_t) ||
+      shm->module_qty != XLOG_MODULE_QTY_MAX || shm->modules_hash != xlog_shm_modules_hash()) {
+      XLOGD_ERROR("incompatible segment magic <0x%08X> version <%u> size <%u> modules <%u>", shm->magic, shm->version, shm->size, shm->module_qty);
+      munmap(shm, sizeof(xlog_shm_t));
+      return(NULL);
+   }
+   return(shm);
+}
+
+void xlog_shm_close(xlog_shm_t *shm) {
+   if(shm != NULL) {
+      munmap(shm, sizeof(xlog_shm_t));
+   }
+}
+
+void xlog_shm_notify(xlog_shm_t *shm) {
+   __atomic_add_fetch(&shm->generation, 1, __ATOMIC_RELEASE);
+   syscall(SYS_futex, &shm->generation, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+void *xlog_shm_thread(void *data) {
+   xlog_shm_t *shm        = g_xlog_shm;
+   uint32_t    generation = __atomic_load_n(&shm->generation, __ATOMIC_ACQUIRE);
+
+   // Apply any change made between the attach and the load of the generation above
+   xlog_shm_apply(shm, false);
+
+   while(__atomic_load_n(&g_xlog_shm_running, __ATOMIC_SEQ_CST)) {
+      struct timespec timeout = { .tv_sec = XLOG_SHM_WAIT_TIMEOUT_S, .tv_nsec = 0 };
+      syscall(SYS_futex, &shm->generation, FUTEX_WAIT, generation, &timeout, NULL, 0);
+
+      uint32_t current = __atomic_load_n(&shm->generation, __ATOMIC_ACQUIRE);
+      if(current != generation) {
+         generation = current;
+         xlog_shm_apply(shm, false);
+      }
+   }
+   return(NULL);
+}
+
+void xlog_shm_apply(xlog_shm_t *shm, bool all) {
+   static const char *names[] = { "ALL", "DEBUG", "INFO", "WARN", "ERROR", "FATAL" };
+   char     summary[512];
+   size_t   used    = 0;
+   uint32_t changes = 0;
+
+   summary[0] = '\0';
+   for(uint32_t index = 0; index < XLOG_MODULE_QTY_MAX; index++) {
+      uint8_t level = __atomic_load_n(&shm->levels[index], __ATOMIC_RELAXED);
+
+      // Only entries which changed are applied so levels set locally for other modules are kept
+      if(level == g_xlog_shm_applied[index] && !all) {
+         continue;
+      }
+      g_xlog_shm_applied[index] = level;
+      if(level >= XLOG_LEVEL_INVALID) {
+         continue;
+      }
+      xlog_level_update(index, (xlog_level_t)level);
+      changes++;
+
+      if(used < sizeof(summary)) {
+         int rc = snprintf(&summary[used], sizeof(summary) - used, " %s <%s>", g_xlog_module_id_to_str[index], names[level]);
+         if(rc > 0) {
+            used += rc;
+         }
+      }
+   }
+   if(changes > 0) {
+      XLOGD_INFO("shared levels applied <%u>%s", changes, summary);
+   }
+}
+
+uint32_t xlog_shm_modules_hash(void) {
+   // FNV-1a over the module names in id order
+   uint32_t hash = 2166136261u;
+   for(uint32_t index = 0; index < XLOG_MODULE_QTY_MAX; index++) {
+      for(const char *str = g_xlog_module_id_to_str[index]; *str != '\0'; str++) {
+         hash = (hash ^ (uint8_t)*str) * 16777619u;
+      }
+      hash = (hash ^ 0) * 16777619u;
+   }
+   return(hash);
+}
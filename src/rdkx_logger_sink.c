@@ -0,0 +1,288 @@
+/*
+##########################################################################
+# If not stated otherwise in this file or this component's LICENSE
+# file the following copyright and licenses apply:
+#
+# Copyright 2019 RDK Management
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+##########################################################################
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <pthread.h>
+#include "rdkx_logger.h"
+#include "rdkx_logger_private.h"
+
+// The record is formatted once by the caller.  Sinks which use different options get a new prefix and postfix around the
+// same body.  Key/value records are encoded once in each format used by the sinks and each sink gets its own format.
+
+typedef struct {
+   bool             used;
+   xlog_sink_type_t type;
+   int              fd;
+   bool             owned;         // The fd was opened by the library
+   xlog_socket_t *  sock;
+   xlog_module_id_t id;
+   uint32_t         level_mask;
+   uint32_t         options_clear;
+   uint32_t         options_set;
+   xlog_kv_format_t kv_format;
+} xlog_sink_t;
+
+volatile uint32_t g_xlog_sink_qty = 0;
+
+static xlog_sink_t      g_xlog_sinks[XLOG_SINK_QTY_MAX];
+static pthread_rwlock_t g_xlog_sink_lock = PTHREAD_RWLOCK_INITIALIZER;
+
+static bool xlog_sink_variant(const xlog_args_t *args, uint32_t options, const struct iovec *iov, char *prefix, char *postfix, struct iovec *variant);
+
+int xlog_sink_add(const xlog_sink_params_t *params) {
+   if(params == NULL) {
+      XLOGD_ERROR("invalid params");
+      return(-1);
+   }
+   if(params->id != XLOG_MODULE_ID_INVALID && !xlog_module_valid(params->id)) {
+      XLOGD_ERROR("invalid module id <%d>", params->id);
+      return(-1);
+   }
+   if(((uint32_t)params->kv_format) >= XLOG_KV_FORMAT_QTY) {
+      XLOGD_ERROR("invalid kv format <%d>", params->kv_format);
+      return(-1);
+   }
+   int            fd    = -1;
+   bool           owned = false;
+   xlog_socket_t *sock  = NULL;
+   switch(params->type) {
+      case XLOG_SINK_TYPE_DEFAULT: {
+         break;
+      }
+      case XLOG_SINK_TYPE_FD: {
+         if(params->fd < 0) {
+            XLOGD_ERROR("invalid fd <%d>", params->fd);
+            return(-1);
+         }
+         fd = params->fd;
+         break;
+      }
+      case XLOG_SINK_TYPE_FILE: {
+         if(params->filename == NULL) {
+            XLOGD_ERROR("NULL filename");
+            return(-1);
+         }
+         fd = open(params->filename, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+         if(fd < 0) {
+            int errsv = errno;
+            XLOGD_ERROR("unable to open <%s> <%s>", params->filename, strerror(errsv));
+            return(-1);
+         }
+         owned = true;
+         break;
+      }
+      case XLOG_SINK_TYPE_SOCKET: {
+         sock = xlog_socket_open(params);
+         if(sock == NULL) {
+            return(-1);
+         }
+         break;
+      }
+      default: {
+         XLOGD_ERROR("invalid type <%d>", params->type);
+         return(-1);
+      }
+   }
+
+   int sink = -1;
+   pthread_rwlock_wrlock(&g_xlog_sink_lock);
+   for(uint32_t index = 0; index < XLOG_SINK_QTY_MAX; index++) {
+      if(!g_xlog_sinks[index].used) {
+         xlog_sink_t *entry   = &g_xlog_sinks[index];
+         entry->type          = params->type;
+         entry->fd            = fd;
+         entry->owned         = owned;
+         entry->sock          = sock;
+         entry->id            = params->id;
+         entry->level_mask    = (params->level_mask == 0) ? XLOG_LEVEL_MASK_ALL : params->level_mask;
+         entry->options_clear = params->options_clear;
+         entry->options_set   = params->options_set & ~XLOG_OPTS_SITE;
+         entry->kv_format     = params->kv_format;
+         entry->used          = true;
+         g_xlog_sink_qty++;
+         sink = index;
+         break;
+      }
+   }
+   pthread_rwlock_unlock(&g_xlog_sink_lock);
+
+   if(sink < 0) {
+      XLOGD_ERROR("sink table is full");
+      if(owned) {
+         close(fd);
+      }
+      if(sock != NULL) {
+         xlog_socket_close(sock);
+      }
+   }
+   return(sink);
+}
+
+void xlog_sink_remove(int sink) {
+   if(sink < 0 || sink >= XLOG_SINK_QTY_MAX) {
+      XLOGD_WARN("invalid sink <%d>", sink);
+      return;
+   }
+   pthread_rwlock_wrlock(&g_xlog_sink_lock);
+   xlog_sink_t *entry = &g_xlog_sinks[sink];
+   if(!entry->used) {
+      pthread_rwlock_unlock(&g_xlog_sink_lock);
+      return;
+   }
+   int            fd    = entry->fd;
+   bool           owned = entry->owned;
+   xlog_socket_t *sock  = entry->sock;
+   entry->used = false;
+   g_xlog_sink_qty--;
+   pthread_rwlock_unlock(&g_xlog_sink_lock);
+
+   if(sock != NULL) { // Closed after the lock is released since the sender thread logs
+      xlog_socket_close(sock);
+   }
+   if(owned) {
+      // Records queued for the file must be written before it is closed
+      if(g_xlog_async) {
+         xlog_async_flush();
+      }
+      close(fd);
+   }
+}
+
+void xlog_sink_remove_all(void) {
+   for(int sink = 0; sink < XLOG_SINK_QTY_MAX; sink++) {
+      if(g_xlog_sinks[sink].used) {
+         xlog_sink_remove(sink);
+      }
+   }
+}
+
+uint32_t xlog_sink_kv_formats(const xlog_args_t *args) {
+   uint32_t formats = 0;
+   pthread_rwlock_rdlock(&g_xlog_sink_lock);
+   for(uint32_t index = 0; index < XLOG_SINK_QTY_MAX; index++) {
+      const xlog_sink_t *sink = &g_xlog_sinks[index];
+      if(!sink->used || (sink->id != XLOG_MODULE_ID_INVALID && sink->id != args->id) || !(sink->level_mask & XLOG_LEVEL_MASK(args->level))) {
+         continue;
+      }
+      formats |= (1u << sink->kv_format);
+   }
+   pthread_rwlock_unlock(&g_xlog_sink_lock);
+   return(formats);
+}
+
+int xlog_sink_emitv(const xlog_args_t *args, FILE *stream, int fd, const struct iovec *iov, int iovcnt, bool output, const xlog_kv_record_t *kv) {
+   char                prefix[XLOG_PREFIX_BUF_SIZE];
+   char                postfix[XLOG_POSTFIX_SIZE];
+   struct iovec        variant[3];
+   const struct iovec *variant_iov     = NULL;          // Record from which variant was built
+   uint32_t            variant_options = args->options; // Options of the record in variant
+   bool                variant_valid   = false;
+   bool                written         = false;
+   bool                error           = false;
+
+   pthread_rwlock_rdlock(&g_xlog_sink_lock);
+   if(g_xlog_sink_qty == 0) { // The last sink was removed
+      pthread_rwlock_unlock(&g_xlog_sink_lock);
+      return(output ? xlog_deliverv(args, stream, fd, iov, iovcnt) : 0);
+   }
+   for(uint32_t index = 0; index < XLOG_SINK_QTY_MAX; index++) {
+      const xlog_sink_t *sink = &g_xlog_sinks[index];
+      if(!sink->used || (sink->id != XLOG_MODULE_ID_INVALID && sink->id != args->id) || !(sink->level_mask & XLOG_LEVEL_MASK(args->level))) {
+         continue;
+      }
+      if(sink->type == XLOG_SINK_TYPE_DEFAULT && !output) { // Replaced by the compressed file
+         continue;
+      }
+      const struct iovec *base    = iov;
+      int                 count   = iovcnt;
+      uint32_t            options = (args->options & ~sink->options_clear) | sink->options_set;
+
+      if(kv != NULL && sink->kv_format != XLOG_KV_FORMAT_DEFAULT && kv->iovcnt[sink->kv_format] > 0) {
+         base  = kv->iov[sink->kv_format];
+         count = kv->iovcnt[sink->kv_format];
+      }
+      const struct iovec *out = base;
+
+      // Only records with a separate prefix and postfix can be changed
+      if(options != args->options && count == 3) {
+         if(!variant_valid || variant_options != options || variant_iov != base) {
+            variant_options = options;
+            variant_iov     = base;
+            variant_valid   = xlog_sink_variant(args, options, base, prefix, postfix, variant);
+         }
+         if(variant_valid) {
+            out = variant;
+         }
+      }
+      int rc;
+      if(sink->type == XLOG_SINK_TYPE_DEFAULT) {
+         rc = xlog_deliverv(args, stream, fd, out, count);
+      } else if(sink->type == XLOG_SINK_TYPE_SOCKET) { // Already asynchronous
+         rc = xlog_socket_writev(sink->sock, out, count);
+      } else {
+         rc = xlog_deliverv(args, NULL, sink->fd, out, count);
+      }
+      if(rc < 0) {
+         error = true;
+      } else {
+         written = true;
+      }
+   }
+   pthread_rwlock_unlock(&g_xlog_sink_lock);
+
+   if(error) {
+      return(-1);
+   }
+   if(!written) {
+      return(0);
+   }
+   size_t size = 0;
+   for(int index = 0; index < iovcnt; index++) {
+      size += iov[index].iov_len;
+   }
+   return(size);
+}
+
+bool xlog_sink_variant(const xlog_args_t *args, uint32_t options, const struct iovec *iov, char *prefix, char *postfix, struct iovec *variant) {
+   variant[1] = iov[1];
+
+   // When only the color is removed, the color sequences are skipped instead of building the prefix again
+   if((options ^ args->options) == XLOG_OPTS_COLOR && !(options & XLOG_OPTS_COLOR) && args->color != NULL) {
+      size_t color_len = strlen(args->color);
+      size_t nrm_len   = sizeof(XLOG_COLOR_NRM) - 1;
+      if(iov[0].iov_len >= color_len && iov[2].iov_len >= nrm_len) {
+         variant[0].iov_base = (char *)iov[0].iov_base + color_len;
+         variant[0].iov_len  = iov[0].iov_len - color_len;
+         variant[2].iov_base = (char *)iov[2].iov_base + nrm_len;
+         variant[2].iov_len  = iov[2].iov_len - nrm_len;
+         return(true);
+      }
+   }
+   xlog_args_t args_sink = *args;
+   args_sink.options = options;
+   return(xlog_frame(&args_sink, prefix, postfix, variant) == 0);
+}
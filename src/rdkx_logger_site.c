@@ -0,0 +1,169 @@
+/*
+##########################################################################
+# If not stated otherwise in this file or this component's LICENSE
+# file the following copyright and licenses apply:
+#
+# Copyright 2019 RDK Management
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+##########################################################################
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <fnmatch.h>
+#include <pthread.h>
+#include "rdkx_logger.h"
+#include "rdkx_logger_private.h"
+
+// Each executable or shared object built with XLOG_SITE_REGISTRY registers the bounds of its xlog_sites section from a
+// constructor.  Every translation unit in the object registers the same bounds, so duplicates are ignored.
+
+#define XLOG_SITE_SECTION_QTY_MAX (64)
+
+typedef struct {
+   xlog_site_t *start;
+   xlog_site_t *stop;
+} xlog_site_section_t;
+
+static xlog_site_section_t g_xlog_site_sections[XLOG_SITE_SECTION_QTY_MAX];
+static uint32_t            g_xlog_site_section_qty = 0;
+static pthread_mutex_t     g_xlog_site_mutex       = PTHREAD_MUTEX_INITIALIZER;
+
+static bool xlog_site_match(const xlog_site_filter_t *filter, const xlog_site_t *site);
+
+void xlog_site_register(xlog_site_t *start, xlog_site_t *stop) {
+   if(start == NULL || stop == NULL || stop <= start) {
+      return;
+   }
+   pthread_mutex_lock(&g_xlog_site_mutex);
+   for(uint32_t index = 0; index < g_xlog_site_section_qty; index++) {
+      if(g_xlog_site_sections[index].start == start) {
+         pthread_mutex_unlock(&g_xlog_site_mutex);
+         return;
+      }
+   }
+   if(g_xlog_site_section_qty >= XLOG_SITE_SECTION_QTY_MAX) {
+      pthread_mutex_unlock(&g_xlog_site_mutex);
+      XLOGD_WARN("too many site sections");
+      return;
+   }
+   g_xlog_site_sections[g_xlog_site_section_qty].start = start;
+   g_xlog_site_sections[g_xlog_site_section_qty].stop  = stop;
+   g_xlog_site_section_qty++;
+   pthread_mutex_unlock(&g_xlog_site_mutex);
+}
+
+void xlog_site_unregister(xlog_site_t *start) {
+   pthread_mutex_lock(&g_xlog_site_mutex);
+   for(uint32_t index = 0; index < g_xlog_site_section_qty; index++) {
+      if(g_xlog_site_sections[index].start == start) {
+         g_xlog_site_sections[index] = g_xlog_site_sections[--g_xlog_site_section_qty];
+         break;
+      }
+   }
+   pthread_mutex_unlock(&g_xlog_site_mutex);
+}
+
+int xlog_site_set(const xlog_site_filter_t *filter, xlog_site_state_t state) {
+   if(state != XLOG_SITE_DEFAULT && state != XLOG_SITE_ENABLE && state != XLOG_SITE_DISABLE) {
+      XLOGD_ERROR("invalid state <%d>", state);
+      return(-1);
+   }
+   int qty = 0;
+
+   pthread_mutex_lock(&g_xlog_site_mutex);
+   for(uint32_t index = 0; index < g_xlog_site_section_qty; index++) {
+      for(xlog_site_t *site = g_xlog_site_sections[index].start; site < g_xlog_site_sections[index].stop; site++) {
+         if(xlog_site_match(filter, site)) {
+            __atomic_store_n(&site->flags, (uint32_t)state, __ATOMIC_RELAXED);
+            qty++;
+         }
+      }
+   }
+   pthread_mutex_unlock(&g_xlog_site_mutex);
+
+   return(qty);
+}
+
+int xlog_site_foreach(const xlog_site_filter_t *filter, xlog_site_callback_t callback, void *data) {
+   if(callback == NULL) {
+      XLOGD_ERROR("invalid params");
+      return(-1);
+   }
+   int qty = 0;
+
+   pthread_mutex_lock(&g_xlog_site_mutex);
+   for(uint32_t index = 0; index < g_xlog_site_section_qty; index++) {
+      for(const xlog_site_t *site = g_xlog_site_sections[index].start; site < g_xlog_site_sections[index].stop; site++) {
+         if(xlog_site_match(filter, site)) {
+            callback(site, data);
+            qty++;
+         }
+      }
+   }
+   pthread_mutex_unlock(&g_xlog_site_mutex);
+
+   return(qty);
+}
+
+bool xlog_site_enabled(const xlog_args_t *args) {
+   const xlog_site_t *site  = (const xlog_site_t *)args;
+   uint32_t           flags = __atomic_load_n(&site->flags, __ATOMIC_RELAXED);
+
+   if(flags != 0) {
+      return((flags & XLOG_SITE_FLAG_ON) ? true : false);
+   }
+   if(!xlog_module_valid(args->id)) {
+      return(false);
+   }
+   return(args->level >= g_xlog_modules[args->id]);
+}
+
+bool xlog_site_match(const xlog_site_filter_t *filter, const xlog_site_t *site) {
+   if(filter == NULL) {
+      return(true);
+   }
+   if(filter->line_min != 0 && site->line < filter->line_min) {
+      return(false);
+   }
+   if(filter->line_max != 0 && site->line > filter->line_max) {
+      return(false);
+   }
+   if(filter->module != NULL) {
+      if(!xlog_module_valid(site->args.id) || 0 != fnmatch(filter->module, xlog_module_name_get(site->args.id, NULL), 0)) {
+         return(false);
+      }
+   }
+   if(filter->function != NULL && (site->function == NULL || 0 != fnmatch(filter->function, site->function, 0))) {
+      return(false);
+   }
+   if(filter->file != NULL) {
+      const char *file = site->file;
+      if(file == NULL) {
+         return(false);
+      }
+      if(strchr(filter->file, '/') == NULL) {
+         const char *base = strrchr(file, '/');
+         if(base != NULL) {
+            file = base + 1;
+         }
+      }
+      if(0 != fnmatch(filter->file, file, 0)) {
+         return(false);
+      }
+   }
+   return(true);
+}
@@ -0,0 +1,327 @@
+/*
+##########################################################################
+# If not stated otherwise in this file or this component's LICENSE
+# file the following copyright and licenses apply:
+#
+# Copyright 2019 RDK Management
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+##########################################################################
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "rdkx_logger.h"
+#include "rdkx_logger_private.h"
+
+// Records are copied into the active buffer by the logging threads.  The sender thread swaps the buffers and sends the
+// records in messages of up to batch_size bytes, so the collector gets one message per batch instead of one write per
+// record.  While the collector is unavailable the records stay in the buffers and new records are dropped once they are
+// full.  Each record is stored after its length so that the messages only end on a record boundary.
+
+#define XLOG_SOCKET_BATCH_SIZE_DEFAULT   (16 * 1024)
+#define XLOG_SOCKET_BATCH_SIZE_MIN       (512)
+#define XLOG_SOCKET_BATCH_SIZE_MAX       (64 * 1024)
+#define XLOG_SOCKET_FLUSH_PERIOD_DEFAULT (100)
+#define XLOG_SOCKET_BUFFER_SIZE_DEFAULT  (256 * 1024)
+#define XLOG_SOCKET_RECONNECT_PERIOD     (1000)
+#define XLOG_SOCKET_IOV_QTY              (256)  // Maximum quantity of records in a message
+
+struct xlog_socket_s {
+   char *          path;
+   int             type;           // SOCK_SEQPACKET or SOCK_DGRAM
+   int             fd;             // -1 while not connected
+   bool            connected;      // Last reported state
+   uint32_t        batch_size;
+   uint32_t        flush_period;
+   uint32_t        buffer_size;    // Size of each buffer
+   pthread_mutex_t mutex;
+   pthread_cond_t  cond;
+   pthread_t       thread;
+   bool            running;
+   uint8_t *       active;         // Filled by the logging threads
+   uint32_t        active_used;
+   uint8_t *       sending;        // Owned by the sender thread
+   uint32_t        sending_used;
+   uint32_t        sending_offset; // Bytes of the sending buffer which have been sent
+   uint32_t        sending_split;  // Bytes of the record at sending_offset which have been sent (longer than the batch)
+   uint64_t        dropped;        // Records dropped since the last report
+};
+
+static void *xlog_socket_sender(void *data);
+static bool  xlog_socket_connect(xlog_socket_t *sock);
+static bool  xlog_socket_send(xlog_socket_t *sock);
+static void  xlog_socket_wait(xlog_socket_t *sock, uint32_t period);
+
+xlog_socket_t *xlog_socket_open(const xlog_sink_params_t *params) {
+   struct sockaddr_un addr;
+   if(params->filename == NULL || strlen(params->filename) >= sizeof(addr.sun_path)) {
+      XLOGD_ERROR("invalid socket path");
+      return(NULL);
+   }
+   uint32_t batch_size  = (params->batch_size == 0) ? XLOG_SOCKET_BATCH_SIZE_DEFAULT : params->batch_size;
+   uint32_t buffer_size = (params->buffer_size == 0) ? XLOG_SOCKET_BUFFER_SIZE_DEFAULT : params->buffer_size;
+   if(batch_size < XLOG_SOCKET_BATCH_SIZE_MIN || batch_size > XLOG_SOCKET_BATCH_SIZE_MAX) {
+      XLOGD_ERROR("invalid batch size <%u>", batch_size);
+      return(NULL);
+   }
+   if(buffer_size < batch_size * 2) {
+      XLOGD_ERROR("buffer size <%u> must be at least twice the batch size <%u>", buffer_size, batch_size);
+      return(NULL);
+   }
+   xlog_socket_t *sock = (xlog_socket_t *)calloc(1, sizeof(xlog_socket_t));
+   if(sock == NULL) {
+      XLOGD_ERROR("out of memory");
+      return(NULL);
+   }
+   sock->path         = strdup(params->filename);
+   sock->type         = params->datagram ? SOCK_DGRAM : SOCK_SEQPACKET;
+   sock->fd           = -1;
+   sock->connected    = true; // Report the first failure to connect
+   sock->batch_size   = batch_size;
+   sock->flush_period = (params->flush_period == 0) ? XLOG_SOCKET_FLUSH_PERIOD_DEFAULT : params->flush_period;
+   sock->buffer_size  = buffer_size / 2;
+   sock->active       = (uint8_t *)malloc(sock->buffer_size);
+   sock->sending      = (uint8_t *)malloc(sock->buffer_size);
+
+   if(sock->path == NULL || sock->active == NULL || sock->sending == NULL) {
+      XLOGD_ERROR("out of memory");
+      goto error;
+   }
+
+   pthread_condattr_t attr;
+   pthread_condattr_init(&attr);
+   pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+   pthread_cond_init(&sock->cond, &attr);
+   pthread_condattr_destroy(&attr);
+   pthread_mutex_init(&sock->mutex, NULL);
+
+   sock->running = true;
+   if(0 != pthread_create(&sock->thread, NULL, xlog_socket_sender, sock)) {
+      int errsv = errno;
+      XLOGD_ERROR("unable to create sender thread <%s>", strerror(errsv));
+      pthread_cond_destroy(&sock->cond);
+      pthread_mutex_destroy(&sock->mutex);
+      goto error;
+   }
+   return(sock);
+
+error:
+   free(sock->path);
+   free(sock->active);
+   free(sock->sending);
+   free(sock);
+   return(NULL);
+}
+
+void xlog_socket_close(xlog_socket_t *sock) {
+   // The sender makes one last attempt to send the buffered records before exiting
+   pthread_mutex_lock(&sock->mutex);
+   sock->running = false;
+   pthread_cond_signal(&sock->cond);
+   pthread_mutex_unlock(&sock->mutex);
+   pthread_join(sock->thread, NULL);
+
+   if(sock->fd >= 0) {
+      close(sock->fd);
+   }
+   pthread_cond_destroy(&sock->cond);
+   pthread_mutex_destroy(&sock->mutex);
+   free(sock->path);
+   free(sock->active);
+   free(sock->sending);
+   free(sock);
+}
+
+int xlog_socket_writev(xlog_socket_t *sock, const struct iovec *iov, int iovcnt) {
+   uint32_t size = 0;
+   for(int index = 0; index < iovcnt; index++) {
+      size += iov[index].iov_len;
+   }
+
+   pthread_mutex_lock(&sock->mutex);
+   if(sock->active_used + sizeof(size) + size > sock->buffer_size) {
+      sock->dropped++;
+      pthread_mutex_unlock(&sock->mutex);
+      return(-1);
+   }
+   memcpy(&sock->active[sock->active_used], &size, sizeof(size));
+   sock->active_used += sizeof(size);
+   for(int index = 0; index < iovcnt; index++) {
+      memcpy(&sock->active[sock->active_used], iov[index].iov_base, iov[index].iov_len);
+      sock->active_used += iov[index].iov_len;
+   }
+   if(sock->active_used >= sock->batch_size && sock->active_used - sizeof(size) - size < sock->batch_size) { // Crossed the batch size
+      pthread_cond_signal(&sock->cond);
+   }
+   pthread_mutex_unlock(&sock->mutex);
+   return(size);
+}
+
+void *xlog_socket_sender(void *data) {
+   xlog_socket_t *sock = (xlog_socket_t *)data;
+
+   pthread_mutex_lock(&sock->mutex);
+   do {
+      bool stopping = !sock->running;
+      if(sock->sending_offset == sock->sending_used) {
+         if(sock->active_used < sock->batch_size && !stopping) {
+            xlog_socket_wait(sock, sock->flush_period);
+            stopping = !sock->running;
+         }
+         if(sock->active_used == 0) {
+            if(stopping) {
+               break;
+            }
+            continue;
+         }
+         uint8_t *buffer      = sock->sending;
+         sock->sending        = sock->active;
+         sock->sending_used   = sock->active_used;
+         sock->sending_offset = 0;
+         sock->active         = buffer;
+         sock->active_used    = 0;
+      }
+      uint64_t dropped = sock->dropped;
+      pthread_mutex_unlock(&sock->mutex);
+
+      bool sent = (sock->fd >= 0 || xlog_socket_connect(sock)) && xlog_socket_send(sock);
+
+      if(sent && dropped > 0) {
+         // Logged after the lock is released since the record is written to this sink too
+         XLOGD_WARN("dropped <%llu> records while <%s> was unavailable", (unsigned long long)dropped, sock->path);
+      }
+      pthread_mutex_lock(&sock->mutex);
+      if(sent) {
+         sock->dropped -= dropped;
+      } else if(stopping) {
+         break; // Give up on the buffered records
+      } else {
+         xlog_socket_wait(sock, XLOG_SOCKET_RECONNECT_PERIOD);
+      }
+   } while(1);
+   pthread_mutex_unlock(&sock->mutex);
+   return(NULL);
+}
+
+void xlog_socket_wait(xlog_socket_t *sock, uint32_t period) {
+   struct timespec timeout;
+   clock_gettime(CLOCK_MONOTONIC, &timeout);
+   timeout.tv_sec  += period / 1000;
+   timeout.tv_nsec += (period % 1000) * 1000000;
+   if(timeout.tv_nsec >= 1000000000) {
+      timeout.tv_sec++;
+      timeout.tv_nsec -= 1000000000;
+   }
+   pthread_cond_timedwait(&sock->cond, &sock->mutex, &timeout);
+}
+
+bool xlog_socket_connect(xlog_socket_t *sock) {
+   struct sockaddr_un addr;
+   memset(&addr, 0, sizeof(addr));
+   addr.sun_family = AF_UNIX;
+   strncpy(addr.sun_path, sock->path, sizeof(addr.sun_path) - 1);
+
+   int fd = socket(AF_UNIX, sock->type | SOCK_CLOEXEC, 0);
+   if(fd < 0) {
+      int errsv = errno;
+      XLOGD_ERROR("unable to create socket <%s>", strerror(errsv));
+      return(false);
+   }
+   if(connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+      int errsv = errno;
+      close(fd);
+      if(sock->connected) { // Only report the change of state
+         sock->connected = false;
+         XLOGD_WARN("unable to connect to <%s> <%s>", sock->path, strerror(errsv));
+      }
+      return(false);
+   }
+   sock->fd = fd;
+   if(!sock->connected) {
+      sock->connected = true;
+      XLOGD_INFO("connected to <%s>", sock->path);
+   }
+   return(true);
+}
+
+bool xlog_socket_send(xlog_socket_t *sock) {
+   struct iovec iov[XLOG_SOCKET_IOV_QTY];
+
+   while(sock->sending_offset < sock->sending_used) {
+      // Gather the complete records which fit in the batch.  A record longer than the batch is split across messages.
+      uint32_t end    = sock->sending_offset; // End of the records in the message
+      uint32_t split  = 0;                    // Bytes of the first record sent once the message is sent (if it is split)
+      size_t   len    = 0;
+      int      iovcnt = 0;
+      do {
+         uint32_t record;
+         memcpy(&record, &sock->sending[end], sizeof(record));
+         uint32_t skip = (iovcnt == 0) ? sock->sending_split : 0;
+         uint32_t size = record - skip;
+         if(iovcnt > 0 && len + size > sock->batch_size) {
+            break;
+         }
+         if(size > sock->batch_size) {
+            size  = sock->batch_size;
+            split = skip + size;
+         }
+         iov[iovcnt].iov_base = &sock->sending[end + sizeof(record) + skip];
+         iov[iovcnt].iov_len  = size;
+         iovcnt++;
+         len += size;
+         if(split == 0) {
+            end += sizeof(record) + record;
+         }
+      } while(split == 0 && end < sock->sending_used && iovcnt < XLOG_SOCKET_IOV_QTY);
+
+      struct msghdr msg;
+      memset(&msg, 0, sizeof(msg));
+      msg.msg_iov    = iov;
+      msg.msg_iovlen = iovcnt;
+
+      ssize_t rc = sendmsg(sock->fd, &msg, MSG_NOSIGNAL);
+      if(rc < 0) {
+         int errsv = errno;
+         if(errsv == EINTR) {
+            continue;
+         }
+         if(errsv == EMSGSIZE) {
+            XLOGD_ERROR("message size <%zu> is too large for <%s>", len, sock->path);
+            sock->sending_offset = end; // Dropped
+            sock->sending_split  = split;
+            continue;
+         }
+         // The collector has gone.  The remaining records are sent after reconnecting.
+         close(sock->fd);
+         sock->fd        = -1;
+         sock->connected = false;
+         XLOGD_WARN("disconnected from <%s> <%s>", sock->path, strerror(errsv));
+         return(false);
+      }
+      sock->sending_offset = end;
+      sock->sending_split  = split;
+   }
+   sock->sending_offset = 0;
+   sock->sending_split  = 0;
+   sock->sending_used   = 0;
+   return(true);
+}
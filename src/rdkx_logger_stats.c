@@ -0,0 +1,344 @@
+/*
+##########################################################################
+# If not stated otherwise in this file or this component's LICENSE
+# file the following copyright and licenses apply:
+#
+# Copyright 2019 RDK Management
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+##########################################################################
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include "rdkx_logger.h"
+#include "rdkx_logger_private.h"
+
+// Each thread counts into its own block so the hot path never writes to a cache line shared with another thread.  Only
+// the owning thread writes a block.  Readers sum the blocks of the live threads and the totals of the threads which have
+// exited while holding the mutex.  A thread's counters for a module are allocated the first time it counts a record of the
+// module, so a thread only pays for the modules it logs.
+
+#define XLOG_STATS_PERIOD_MIN_MS (1000)
+
+typedef struct xlog_stats_thread_s {
+   struct xlog_stats_thread_s *next;
+   xlog_stats_t *              modules[XLOG_MODULE_SLOT_QTY]; // NULL until the thread counts a record of the module
+} xlog_stats_thread_t;
+
+static xlog_stats_thread_t *g_xlog_stats_threads = NULL;
+static xlog_stats_t         g_xlog_stats_retired[XLOG_MODULE_SLOT_QTY]; // Totals from threads which have exited
+static pthread_mutex_t      g_xlog_stats_mutex   = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t        g_xlog_stats_key;
+static pthread_once_t       g_xlog_stats_once    = PTHREAD_ONCE_INIT;
+
+static bool                 g_xlog_stats_summary_running = false;
+static uint32_t             g_xlog_stats_summary_period  = 0;
+static pthread_t            g_xlog_stats_summary_thread;
+static pthread_cond_t       g_xlog_stats_summary_cond;
+
+static __thread xlog_stats_thread_t *g_xlog_stats_thread = NULL;
+
+static xlog_stats_thread_t *xlog_stats_thread_get(bool create);
+static xlog_stats_t *       xlog_stats_module_get(xlog_module_id_t id, bool create);
+static void                 xlog_stats_key_create(void);
+static void                 xlog_stats_thread_release(void *data);
+static void                 xlog_stats_add(xlog_stats_t *dst, const xlog_stats_t *src);
+static void                 xlog_stats_inc(uint64_t *counter, uint64_t value);
+static uint64_t             xlog_stats_sum(const uint64_t *counters);
+static void *               xlog_stats_summary_thread(void *data);
+static void                 xlog_stats_summary_print(xlog_stats_t *prev, uint32_t period);
+
+void xlog_stats_output(const xlog_args_t *args, int rc, bool safe) {
+   // The block is not allocated in the signal safe path
+   xlog_stats_t *stats = xlog_stats_module_get(args->id, !safe);
+   if(stats == NULL) {
+      return;
+   }
+   if(rc < 0) {
+      xlog_stats_inc(&stats->errors, 1);
+   } else if(rc > 0) {
+      uint32_t level = ((uint32_t)args->level < XLOG_LEVEL_INVALID) ? args->level : XLOG_LEVEL_INVALID;
+      xlog_stats_inc(&stats->emitted[level], 1);
+      xlog_stats_inc(&stats->bytes[level], rc);
+   }
+}
+
+void xlog_stats_truncated(xlog_module_id_t id, bool safe) {
+   xlog_stats_t *stats = xlog_stats_module_get(id, !safe);
+   if(stats == NULL) {
+      return;
+   }
+   xlog_stats_inc(&stats->truncated, 1);
+}
+
+void xlog_stats_error(xlog_module_id_t id) {
+   xlog_stats_t *stats = xlog_stats_module_get(id, true);
+   if(stats == NULL) {
+      return;
+   }
+   xlog_stats_inc(&stats->errors, 1);
+}
+
+void xlog_stats_shed(xlog_module_id_t id) {
+   xlog_stats_t *stats = xlog_stats_module_get(id, true);
+   if(stats == NULL) {
+      return;
+   }
+   xlog_stats_inc(&stats->shed, 1);
+}
+
+void xlog_stats_suppressed(xlog_module_id_t id, xlog_level_t level) {
+   xlog_stats_suppressed_int(id, level, false);
+}
+
+void xlog_stats_suppressed_int(xlog_module_id_t id, xlog_level_t level, bool safe) {
+   xlog_stats_t *stats = xlog_stats_module_get(id, !safe);
+   if(stats == NULL) {
+      return;
+   }
+   xlog_stats_inc(&stats->suppressed[((uint32_t)level < XLOG_LEVEL_INVALID) ? level : XLOG_LEVEL_INVALID], 1);
+}
+
+int xlog_stats_get(xlog_module_id_t id, xlog_stats_t *stats) {
+   if(stats == NULL || (!xlog_module_valid(id) && id != XLOG_MODULE_ID_INVALID)) {
+      return(-1);
+   }
+   memset(stats, 0, sizeof(*stats));
+
+   uint32_t first = (id == XLOG_MODULE_ID_INVALID) ? 0 : id;
+   uint32_t last  = (id == XLOG_MODULE_ID_INVALID) ? XLOG_MODULE_SLOT_QTY : id + 1;
+
+   pthread_mutex_lock(&g_xlog_stats_mutex);
+   for(uint32_t index = first; index < last; index++) {
+      xlog_stats_add(stats, &g_xlog_stats_retired[index]);
+      for(xlog_stats_thread_t *thread = g_xlog_stats_threads; thread != NULL; thread = thread->next) {
+         if(thread->modules[index] != NULL) {
+            xlog_stats_add(stats, thread->modules[index]);
+         }
+      }
+   }
+   pthread_mutex_unlock(&g_xlog_stats_mutex);
+   return(0);
+}
+
+int xlog_stats_summary_start(uint32_t period) {
+   if(period < XLOG_STATS_PERIOD_MIN_MS) {
+      XLOGD_ERROR("invalid period <%u>", period);
+      return(-1);
+   }
+   pthread_mutex_lock(&g_xlog_stats_mutex);
+   if(g_xlog_stats_summary_running) {
+      g_xlog_stats_summary_period = period;
+      pthread_cond_signal(&g_xlog_stats_summary_cond);
+      pthread_mutex_unlock(&g_xlog_stats_mutex);
+      return(0);
+   }
+   pthread_condattr_t attr;
+   pthread_condattr_init(&attr);
+   pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+   pthread_cond_init(&g_xlog_stats_summary_cond, &attr);
+   pthread_condattr_destroy(&attr);
+
+   g_xlog_stats_summary_period  = period;
+   g_xlog_stats_summary_running = true;
+   if(0 != pthread_create(&g_xlog_stats_summary_thread, NULL, xlog_stats_summary_thread, NULL)) {
+      int errsv = errno;
+      g_xlog_stats_summary_running = false;
+      pthread_cond_destroy(&g_xlog_stats_summary_cond);
+      pthread_mutex_unlock(&g_xlog_stats_mutex);
+      XLOGD_ERROR("unable to create thread <%s>", strerror(errsv));
+      return(-1);
+   }
+   pthread_mutex_unlock(&g_xlog_stats_mutex);
+   return(0);
+}
+
+void xlog_stats_summary_stop(void) {
+   pthread_mutex_lock(&g_xlog_stats_mutex);
+   if(!g_xlog_stats_summary_running) {
+      pthread_mutex_unlock(&g_xlog_stats_mutex);
+      return;
+   }
+   g_xlog_stats_summary_running = false;
+   pthread_cond_signal(&g_xlog_stats_summary_cond);
+   pthread_mutex_unlock(&g_xlog_stats_mutex);
+
+   pthread_join(g_xlog_stats_summary_thread, NULL);
+   pthread_cond_destroy(&g_xlog_stats_summary_cond);
+}
+
+xlog_stats_thread_t *xlog_stats_thread_get(bool create) {
+   xlog_stats_thread_t *thread = g_xlog_stats_thread;
+   if(thread != NULL || !create) {
+      return(thread);
+   }
+   pthread_once(&g_xlog_stats_once, xlog_stats_key_create);
+
+   thread = (xlog_stats_thread_t *)calloc(1, sizeof(*thread));
+   if(thread == NULL) {
+      return(NULL);
+   }
+   pthread_mutex_lock(&g_xlog_stats_mutex);
+   thread->next         = g_xlog_stats_threads;
+   g_xlog_stats_threads = thread;
+   pthread_mutex_unlock(&g_xlog_stats_mutex);
+
+   pthread_setspecific(g_xlog_stats_key, thread);
+   g_xlog_stats_thread = thread;
+   return(thread);
+}
+
+xlog_stats_t *xlog_stats_module_get(xlog_module_id_t id, bool create) {
+   xlog_stats_thread_t *thread = xlog_stats_thread_get(create);
+   if(thread == NULL || (uint32_t)id >= XLOG_MODULE_SLOT_QTY) {
+      return(NULL);
+   }
+   xlog_stats_t *stats = thread->modules[id];
+   if(stats != NULL || !create) {
+      return(stats);
+   }
+   stats = (xlog_stats_t *)calloc(1, sizeof(*stats));
+   if(stats == NULL) {
+      return(NULL);
+   }
+   // Stored while holding the mutex since the readers walk the blocks of every thread
+   pthread_mutex_lock(&g_xlog_stats_mutex);
+   thread->modules[id] = stats;
+   pthread_mutex_unlock(&g_xlog_stats_mutex);
+   return(stats);
+}
+
+void xlog_stats_key_create(void) {
+   pthread_key_create(&g_xlog_stats_key, xlog_stats_thread_release);
+}
+
+void xlog_stats_thread_release(void *data) {
+   // Called on thread exit.  Fold the thread's counters into the totals so they are not lost.
+   xlog_stats_thread_t *thread = (xlog_stats_thread_t *)data;
+   g_xlog_stats_thread = NULL;
+
+   pthread_mutex_lock(&g_xlog_stats_mutex);
+   for(xlog_stats_thread_t **prev = &g_xlog_stats_threads; *prev != NULL; prev = &(*prev)->next) {
+      if(*prev == thread) {
+         *prev = thread->next;
+         break;
+      }
+   }
+   for(uint32_t index = 0; index < XLOG_MODULE_SLOT_QTY; index++) {
+      if(thread->modules[index] != NULL) {
+         xlog_stats_add(&g_xlog_stats_retired[index], thread->modules[index]);
+      }
+   }
+   pthread_mutex_unlock(&g_xlog_stats_mutex);
+   for(uint32_t index = 0; index < XLOG_MODULE_SLOT_QTY; index++) {
+      free(thread->modules[index]);
+   }
+   free(thread);
+}
+
+void xlog_stats_add(xlog_stats_t *dst, const xlog_stats_t *src) {
+   for(uint32_t level = 0; level <= XLOG_LEVEL_INVALID; level++) {
+      dst->emitted[level]    += __atomic_load_n(&src->emitted[level],    __ATOMIC_RELAXED);
+      dst->suppressed[level] += __atomic_load_n(&src->suppressed[level], __ATOMIC_RELAXED);
+      dst->bytes[level]      += __atomic_load_n(&src->bytes[level],      __ATOMIC_RELAXED);
+   }
+   dst->truncated += __atomic_load_n(&src->truncated, __ATOMIC_RELAXED);
+   dst->errors    += __atomic_load_n(&src->errors,    __ATOMIC_RELAXED);
+   dst->shed      += __atomic_load_n(&src->shed,      __ATOMIC_RELAXED);
+}
+
+void xlog_stats_inc(uint64_t *counter, uint64_t value) {
+   // Only the owning thread writes the counter so a locked read-modify-write is not needed
+   __atomic_store_n(counter, __atomic_load_n(counter, __ATOMIC_RELAXED) + value, __ATOMIC_RELAXED);
+}
+
+uint64_t xlog_stats_sum(const uint64_t *counters) {
+   uint64_t sum = 0;
+   for(uint32_t level = 0; level <= XLOG_LEVEL_INVALID; level++) {
+      sum += counters[level];
+   }
+   return(sum);
+}
+
+void *xlog_stats_summary_thread(void *data) {
+   xlog_stats_t prev[XLOG_MODULE_SLOT_QTY];
+
+   // Modules registered later start from zero
+   memset(prev, 0, sizeof(prev));
+   for(uint32_t index = 0; index < XLOG_MODULE_SLOT_QTY; index++) {
+      if(xlog_module_valid(index)) {
+         xlog_stats_get((xlog_module_id_t)index, &prev[index]);
+      }
+   }
+
+   pthread_mutex_lock(&g_xlog_stats_mutex);
+   while(g_xlog_stats_summary_running) {
+      uint32_t        period = g_xlog_stats_summary_period;
+      struct timespec timeout;
+      clock_gettime(CLOCK_MONOTONIC, &timeout);
+      timeout.tv_sec  += period / 1000;
+      timeout.tv_nsec += (period % 1000) * 1000000;
+      if(timeout.tv_nsec >= 1000000000) {
+         timeout.tv_sec++;
+         timeout.tv_nsec -= 1000000000;
+      }
+      int rc = 0;
+      while(g_xlog_stats_summary_running && period == g_xlog_stats_summary_period && rc != ETIMEDOUT) {
+         rc = pthread_cond_timedwait(&g_xlog_stats_summary_cond, &g_xlog_stats_mutex, &timeout);
+      }
+      if(rc != ETIMEDOUT) { // Stopped or the period changed
+         continue;
+      }
+      pthread_mutex_unlock(&g_xlog_stats_mutex);
+      xlog_stats_summary_print(prev, period);
+      pthread_mutex_lock(&g_xlog_stats_mutex);
+   }
+   pthread_mutex_unlock(&g_xlog_stats_mutex);
+   return(NULL);
+}
+
+void xlog_stats_summary_print(xlog_stats_t *prev, uint32_t period) {
+   // Print the activity since the previous summary along with the module which emitted the most records
+   uint64_t emitted = 0, suppressed = 0, bytes = 0, truncated = 0, errors = 0, shed = 0, top_qty = 0;
+   uint32_t top = XLOG_MODULE_ID_INVALID;
+
+   for(uint32_t index = 0; index < XLOG_MODULE_SLOT_QTY; index++) {
+      if(!xlog_module_valid(index)) {
+         continue;
+      }
+      xlog_stats_t stats;
+      xlog_stats_get((xlog_module_id_t)index, &stats);
+
+      uint64_t qty = xlog_stats_sum(stats.emitted) - xlog_stats_sum(prev[index].emitted);
+      emitted    += qty;
+      suppressed += xlog_stats_sum(stats.suppressed) - xlog_stats_sum(prev[index].suppressed);
+      bytes      += xlog_stats_sum(stats.bytes) - xlog_stats_sum(prev[index].bytes);
+      truncated  += stats.truncated - prev[index].truncated;
+      errors     += stats.errors - prev[index].errors;
+      shed       += stats.shed - prev[index].shed;
+      if(qty > top_qty) {
+         top_qty = qty;
+         top     = index;
+      }
+      prev[index] = stats;
+   }
+   XLOGD_INFO("period <%u ms> emitted <%llu> suppressed <%llu> bytes <%llu> truncated <%llu> errors <%llu> shed <%llu> top <%s:%llu>",
+              period, (unsigned long long)emitted, (unsigned long long)suppressed, (unsigned long long)bytes, (unsigned long long)truncated,
+              (unsigned long long)errors, (unsigned long long)shed, (top != XLOG_MODULE_ID_INVALID) ? xlog_module_name_get(top, NULL) : "NONE", (unsigned long long)top_qty);
+}
@@ -0,0 +1,183 @@
+/*
+##########################################################################
+# If not stated otherwise in this file or this component's LICENSE
+# file the following copyright and licenses apply:
+#
+# Copyright 2019 RDK Management
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+##########################################################################
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/inotify.h>
+#include "rdkx_logger.h"
+#include "rdkx_logger_private.h"
+
+// The directories which hold the configuration files are watched rather than the files themselves so that files which are
+// created, deleted or replaced by rename are detected.
+
+#define XLOG_WATCH_SETTLE_MS    (100)  // Time without events before the configuration is reloaded
+#define XLOG_WATCH_SETTLE_MAX   (10)   // Maximum quantity of settle periods before reloading anyway
+#define XLOG_WATCH_EVENT_MASK   (IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE)
+
+static bool      g_xlog_watch_running = false;
+static int       g_xlog_watch_fd      = -1;
+static int       g_xlog_watch_pipe[2] = { -1, -1 };
+static pthread_t g_xlog_watch_thread;
+
+static void *xlog_config_watch_thread(void *data);
+static bool  xlog_config_watch_read(void);
+static bool  xlog_config_watch_name(const char *name);
+
+int xlog_config_watch_start(void) {
+   if(g_xlog_watch_running) {
+      XLOGD_WARN("already running");
+      return(-1);
+   }
+   g_xlog_watch_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+   if(g_xlog_watch_fd < 0) {
+      int errsv = errno;
+      XLOGD_ERROR("inotify init <%s>", strerror(errsv));
+      return(-1);
+   }
+
+   const char *dirs[] = { XLOG_CONFIG_FILE_DIR_NAME_DEV, XLOG_CONFIG_FILE_DIR_NAME_PRD };
+   uint32_t    watches = 0;
+   for(uint32_t index = 0; index < sizeof(dirs) / sizeof(dirs[0]); index++) {
+      if(inotify_add_watch(g_xlog_watch_fd, dirs[index], XLOG_WATCH_EVENT_MASK) < 0) {
+         int errsv = errno;
+         XLOGD_WARN("unable to watch <%s> <%s>", dirs[index], strerror(errsv));
+         continue;
+      }
+      watches++;
+   }
+   if(watches == 0 || pipe(g_xlog_watch_pipe) < 0) {
+      XLOGD_ERROR("unable to start watcher");
+      close(g_xlog_watch_fd);
+      g_xlog_watch_fd = -1;
+      return(-1);
+   }
+
+   if(0 != pthread_create(&g_xlog_watch_thread, NULL, xlog_config_watch_thread, NULL)) {
+      XLOGD_ERROR("unable to create thread");
+      close(g_xlog_watch_pipe[0]);
+      close(g_xlog_watch_pipe[1]);
+      close(g_xlog_watch_fd);
+      g_xlog_watch_pipe[0] = -1;
+      g_xlog_watch_pipe[1] = -1;
+      g_xlog_watch_fd      = -1;
+      return(-1);
+   }
+   g_xlog_watch_running = true;
+   return(0);
+}
+
+void xlog_config_watch_stop(void) {
+   if(!g_xlog_watch_running) {
+      return;
+   }
+   // Wake the thread by closing the write end of the pipe
+   close(g_xlog_watch_pipe[1]);
+   pthread_join(g_xlog_watch_thread, NULL);
+
+   close(g_xlog_watch_pipe[0]);
+   close(g_xlog_watch_fd);
+   g_xlog_watch_pipe[0] = -1;
+   g_xlog_watch_pipe[1] = -1;
+   g_xlog_watch_fd      = -1;
+   g_xlog_watch_running = false;
+}
+
+void *xlog_config_watch_thread(void *data) {
+   struct pollfd fds[2];
+   fds[0].fd     = g_xlog_watch_fd;
+   fds[0].events = POLLIN;
+   fds[1].fd     = g_xlog_watch_pipe[0];
+   fds[1].events = POLLIN;
+
+   bool     pending = false;
+   uint32_t settle  = 0;
+
+   do {
+      int rc = poll(fds, 2, pending ? XLOG_WATCH_SETTLE_MS : -1);
+      if(rc < 0) {
+         if(errno == EINTR) {
+            continue;
+         }
+         int errsv = errno;
+         XLOGD_ERROR("poll <%s>", strerror(errsv));
+         break;
+      }
+      if(fds[1].revents) { // Stop
+         break;
+      }
+      if(rc > 0 && (fds[0].revents & POLLIN)) {
+         if(xlog_config_watch_read()) {
+            pending = true;
+         }
+         if(!pending || ++settle < XLOG_WATCH_SETTLE_MAX) {
+            continue;
+         }
+      }
+      if(pending) { // Events have settled (editors often write a file several times)
+         xlog_config_reload();
+         pending = false;
+         settle  = 0;
+      }
+   } while(1);
+
+   return(NULL);
+}
+
+bool xlog_config_watch_read(void) {
+   char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+   bool match = false;
+
+   do {
+      ssize_t len = read(g_xlog_watch_fd, buffer, sizeof(buffer));
+      if(len <= 0) {
+         if(len < 0 && errno == EINTR) {
+            continue;
+         }
+         break;
+      }
+      for(char *ptr = buffer; ptr < buffer + len; ) {
+         const struct inotify_event *event = (const struct inotify_event *)ptr;
+         if((event->mask & IN_Q_OVERFLOW) || (event->len > 0 && xlog_config_watch_name(event->name))) {
+            match = true;
+         }
+         ptr += sizeof(struct inotify_event) + event->len;
+      }
+   } while(1);
+
+   return(match);
+}
+
+bool xlog_config_watch_name(const char *name) {
+   // Global file or any module specific file (only the process' own module file is used by the reload)
+   if(0 == strcmp(name, XLOG_CONFIG_FILE_NAME)) {
+      return(true);
+   }
+   size_t len = strlen(name);
+   return(len > sizeof(XLOG_CONFIG_FILE_NAME_ROOT ".json") - 1 &&
+          0 == strncmp(name, XLOG_CONFIG_FILE_NAME_ROOT, sizeof(XLOG_CONFIG_FILE_NAME_ROOT) - 1) &&
+          0 == strcmp(&name[len - 5], ".json"));
+}
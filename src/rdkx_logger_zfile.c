@@ -0,0 +1,683 @@
+/*
+##########################################################################
+# If not stated otherwise in this file or this component's LICENSE
+# file the following copyright and licenses apply:
+#
+# Copyright 2019 RDK Management
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+##########################################################################
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <sys/uio.h>
+#ifdef USE_ZLIB
+#include <zlib.h>
+#endif
+#include "rdkx_logger.h"
+#include "rdkx_logger_private.h"
+
+// Records are copied into the active block by the logging threads.  When the block is full it is handed to the compressor
+// thread which compresses and writes it while the next block is filled.  Each block is compressed on its own so it can be
+// decoded without the rest of the file.  An index of the blocks is appended when the file is rotated or closed.
+
+#define XLOG_ZFILE_BLOCK_SIZE_DEFAULT   (64 * 1024)
+#define XLOG_ZFILE_BLOCK_SIZE_MIN       (4 * 1024)
+#define XLOG_ZFILE_BLOCK_SIZE_MAX       (1024 * 1024)
+#define XLOG_ZFILE_FLUSH_PERIOD_DEFAULT (10000)
+#define XLOG_ZFILE_FILE_QTY_DEFAULT     (1)
+#define XLOG_ZFILE_FILE_QTY_MAX         (9)
+
+// LZ4 block format compressor
+#define XLOG_LZ_HASH_BITS     (12)
+#define XLOG_LZ_MIN_MATCH     (4)
+#define XLOG_LZ_LAST_LITERALS (5)  // The last bytes of the block are always literals
+#define XLOG_LZ_MF_LIMIT      (12) // Matches do not start in the last bytes of the block
+#define XLOG_LZ_OFFSET_MAX    (65535)
+
+volatile bool g_xlog_zfile     = false;
+volatile bool g_xlog_zfile_tee = false;
+
+__thread bool g_xlog_zfile_compressor_thread = false;
+
+static pthread_mutex_t            g_xlog_zfile_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t             g_xlog_zfile_cond;      // Signals the compressor thread
+static pthread_cond_t             g_xlog_zfile_cond_free; // Signals the logging threads that the pending block is free
+static pthread_t                  g_xlog_zfile_thread;
+static bool                       g_xlog_zfile_running = false;
+static bool                       g_xlog_zfile_writing = false; // A record is being copied (the mutex is released while waiting)
+static char *                     g_xlog_zfile_name    = NULL;
+static int                        g_xlog_zfile_fd      = -1;
+static uint32_t                   g_xlog_zfile_size_max;
+static uint32_t                   g_xlog_zfile_file_qty;
+static uint32_t                   g_xlog_zfile_block_size;
+static uint32_t                   g_xlog_zfile_flush_period;
+static uint16_t                   g_xlog_zfile_codec;
+static uint64_t                   g_xlog_zfile_offset; // Size of the current file
+static xlog_zfile_index_entry_t * g_xlog_zfile_index     = NULL;
+static uint32_t                   g_xlog_zfile_index_qty = 0;
+static uint32_t                   g_xlog_zfile_index_max = 0;
+
+// Active block filled by the logging threads and the pending block owned by the compressor thread
+static uint8_t *g_xlog_zfile_active         = NULL;
+static uint32_t g_xlog_zfile_active_used    = 0;
+static uint64_t g_xlog_zfile_active_time    = 0;
+static uint8_t *g_xlog_zfile_pending        = NULL;
+static uint32_t g_xlog_zfile_pending_used   = 0;
+static uint64_t g_xlog_zfile_pending_time   = 0;
+static uint8_t *g_xlog_zfile_compressed     = NULL;
+static uint32_t g_xlog_zfile_compressed_max = 0;
+
+static void *   xlog_zfile_compressor(void *data);
+static void     xlog_zfile_swap(void);
+static bool     xlog_zfile_block_write(const uint8_t *data, uint32_t size, uint64_t timestamp);
+static bool     xlog_zfile_file_open(void);
+static void     xlog_zfile_file_close(void);
+static void     xlog_zfile_rotate(void);
+static bool     xlog_zfile_write_all(int fd, const void *data, size_t size);
+static uint64_t xlog_zfile_time(void);
+static uint32_t xlog_lz_hash(uint32_t value);
+static uint32_t xlog_lz_read32(const uint8_t *src);
+static bool     xlog_lz_sequence(uint8_t *dst, size_t size, size_t *used, const uint8_t *literals, size_t literal_len, uint32_t offset, size_t match_len);
+
+int xlog_zfile_open(const xlog_zfile_params_t *params) {
+   if(params == NULL || params->filename == NULL) {
+      XLOGD_ERROR("invalid params");
+      return(-1);
+   }
+   uint32_t block_size = (params->block_size == 0) ? XLOG_ZFILE_BLOCK_SIZE_DEFAULT : params->block_size;
+   uint32_t file_qty   = (params->file_qty == 0) ? XLOG_ZFILE_FILE_QTY_DEFAULT : params->file_qty;
+   if(block_size < XLOG_ZFILE_BLOCK_SIZE_MIN || block_size > XLOG_ZFILE_BLOCK_SIZE_MAX) {
+      XLOGD_ERROR("invalid block size <%u>", block_size);
+      return(-1);
+   }
+   if(file_qty > XLOG_ZFILE_FILE_QTY_MAX) {
+      XLOGD_ERROR("invalid file qty <%u>", file_qty);
+      return(-1);
+   }
+   uint16_t codec = XLOG_ZFILE_BLOCK_LZ;
+   #ifdef USE_ZLIB
+   if(params->codec != XLOG_ZFILE_CODEC_LZ) {
+      codec = XLOG_ZFILE_BLOCK_ZLIB;
+   }
+   #else
+   if(params->codec == XLOG_ZFILE_CODEC_ZLIB) {
+      XLOGD_ERROR("zlib is not enabled");
+      return(-1);
+   }
+   #endif
+
+   pthread_mutex_lock(&g_xlog_zfile_mutex);
+   if(g_xlog_zfile_running) {
+      pthread_mutex_unlock(&g_xlog_zfile_mutex);
+      XLOGD_WARN("already open");
+      return(-1);
+   }
+   // The LZ output can be slightly larger than the input.  Blocks which don't compress are stored.
+   uint32_t compressed_max = block_size + (block_size / 255) + 16;
+   #ifdef USE_ZLIB
+   if(compressed_max < compressBound(block_size)) {
+      compressed_max = compressBound(block_size);
+   }
+   #endif
+
+   g_xlog_zfile_name       = strdup(params->filename);
+   g_xlog_zfile_active     = (uint8_t *)malloc(block_size);
+   g_xlog_zfile_pending    = (uint8_t *)malloc(block_size);
+   g_xlog_zfile_compressed = (uint8_t *)malloc(compressed_max);
+
+   if(g_xlog_zfile_name == NULL || g_xlog_zfile_active == NULL || g_xlog_zfile_pending == NULL || g_xlog_zfile_compressed == NULL) {
+      XLOGD_ERROR("out of memory");
+      goto error;
+   }
+   g_xlog_zfile_size_max       = params->file_size_max;
+   g_xlog_zfile_file_qty       = file_qty;
+   g_xlog_zfile_block_size     = block_size;
+   g_xlog_zfile_flush_period   = (params->flush_period == 0) ? XLOG_ZFILE_FLUSH_PERIOD_DEFAULT : params->flush_period;
+   g_xlog_zfile_codec          = codec;
+   g_xlog_zfile_compressed_max = compressed_max;
+   g_xlog_zfile_active_used    = 0;
+   g_xlog_zfile_pending_used   = 0;
+
+   // Logs from the previous run are kept as the first rotated file
+   xlog_zfile_rotate();
+   if(!xlog_zfile_file_open()) {
+      goto error;
+   }
+
+   pthread_condattr_t attr;
+   pthread_condattr_init(&attr);
+   pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+   pthread_cond_init(&g_xlog_zfile_cond, &attr);
+   pthread_cond_init(&g_xlog_zfile_cond_free, &attr);
+   pthread_condattr_destroy(&attr);
+
+   g_xlog_zfile_running = true;
+   if(0 != pthread_create(&g_xlog_zfile_thread, NULL, xlog_zfile_compressor, NULL)) {
+      int errsv = errno;
+      XLOGD_ERROR("unable to create compressor thread <%s>", strerror(errsv));
+      g_xlog_zfile_running = false;
+      pthread_cond_destroy(&g_xlog_zfile_cond);
+      pthread_cond_destroy(&g_xlog_zfile_cond_free);
+      xlog_zfile_file_close();
+      goto error;
+   }
+   g_xlog_zfile_tee = params->tee;
+   __atomic_store_n(&g_xlog_zfile, true, __ATOMIC_RELEASE);
+   pthread_mutex_unlock(&g_xlog_zfile_mutex);
+
+   XLOGD_INFO("compressed output to <%s> codec <%s> block size <%u> file size max <%u> qty <%u>", params->filename,
+              (codec == XLOG_ZFILE_BLOCK_ZLIB) ? "ZLIB" : "LZ", block_size, params->file_size_max, file_qty);
+   return(0);
+
+error:
+   free(g_xlog_zfile_name);
+   free(g_xlog_zfile_active);
+   free(g_xlog_zfile_pending);
+   free(g_xlog_zfile_compressed);
+   g_xlog_zfile_name       = NULL;
+   g_xlog_zfile_active     = NULL;
+   g_xlog_zfile_pending    = NULL;
+   g_xlog_zfile_compressed = NULL;
+   pthread_mutex_unlock(&g_xlog_zfile_mutex);
+   return(-1);
+}
+
+void xlog_zfile_close(void) {
+   pthread_mutex_lock(&g_xlog_zfile_mutex);
+   if(!g_xlog_zfile_running) {
+      pthread_mutex_unlock(&g_xlog_zfile_mutex);
+      return;
+   }
+   __atomic_store_n(&g_xlog_zfile, false, __ATOMIC_SEQ_CST);
+   g_xlog_zfile_running = false;
+   pthread_cond_signal(&g_xlog_zfile_cond);
+   pthread_cond_broadcast(&g_xlog_zfile_cond_free);
+   pthread_mutex_unlock(&g_xlog_zfile_mutex);
+
+   // The compressor writes the remaining blocks and the index before exiting
+   pthread_join(g_xlog_zfile_thread, NULL);
+
+   pthread_mutex_lock(&g_xlog_zfile_mutex);
+   pthread_cond_destroy(&g_xlog_zfile_cond);
+   pthread_cond_destroy(&g_xlog_zfile_cond_free);
+   free(g_xlog_zfile_name);
+   free(g_xlog_zfile_active);
+   free(g_xlog_zfile_pending);
+   free(g_xlog_zfile_compressed);
+   free(g_xlog_zfile_index);
+   g_xlog_zfile_name       = NULL;
+   g_xlog_zfile_active     = NULL;
+   g_xlog_zfile_pending    = NULL;
+   g_xlog_zfile_compressed = NULL;
+   g_xlog_zfile_index      = NULL;
+   g_xlog_zfile_index_qty  = 0;
+   g_xlog_zfile_index_max  = 0;
+   pthread_mutex_unlock(&g_xlog_zfile_mutex);
+}
+
+void xlog_zfile_flush(void) {
+   if(!__atomic_load_n(&g_xlog_zfile, __ATOMIC_ACQUIRE)) {
+      return;
+   }
+   pthread_mutex_lock(&g_xlog_zfile_mutex);
+   // Hand the partial block to the compressor and wait until it has been written
+   while(g_xlog_zfile_running && g_xlog_zfile_pending_used != 0) {
+      pthread_cond_wait(&g_xlog_zfile_cond_free, &g_xlog_zfile_mutex);
+   }
+   if(g_xlog_zfile_running && g_xlog_zfile_active_used != 0) {
+      xlog_zfile_swap();
+   }
+   while(g_xlog_zfile_running && g_xlog_zfile_pending_used != 0) {
+      pthread_cond_wait(&g_xlog_zfile_cond_free, &g_xlog_zfile_mutex);
+   }
+   pthread_mutex_unlock(&g_xlog_zfile_mutex);
+}
+
+int xlog_zfile_write(const struct iovec *iov, int iovcnt) {
+   size_t total = 0;
+   size_t size  = 0;
+
+   for(int index = 0; index < iovcnt; index++) {
+      size += iov[index].iov_len;
+   }
+
+   pthread_mutex_lock(&g_xlog_zfile_mutex);
+   while(g_xlog_zfile_running && g_xlog_zfile_writing) {
+      pthread_cond_wait(&g_xlog_zfile_cond_free, &g_xlog_zfile_mutex);
+   }
+   if(!g_xlog_zfile_running) {
+      pthread_mutex_unlock(&g_xlog_zfile_mutex);
+      return(-1);
+   }
+   g_xlog_zfile_writing = true;
+
+   // Start a new block rather than split a record which fits in one so that each block starts on a record boundary
+   if(size <= g_xlog_zfile_block_size && size > g_xlog_zfile_block_size - g_xlog_zfile_active_used) {
+      while(g_xlog_zfile_running && g_xlog_zfile_pending_used != 0) {
+         pthread_cond_wait(&g_xlog_zfile_cond_free, &g_xlog_zfile_mutex);
+      }
+      if(g_xlog_zfile_running) {
+         xlog_zfile_swap();
+      }
+   }
+   for(int index = 0; index < iovcnt && g_xlog_zfile_running; index++) {
+      const uint8_t *data = (const uint8_t *)iov[index].iov_base;
+      size_t         len  = iov[index].iov_len;
+
+      // Records may span blocks since the decoded blocks are concatenated
+      while(len > 0) {
+         if(g_xlog_zfile_active_used == g_xlog_zfile_block_size) {
+            while(g_xlog_zfile_running && g_xlog_zfile_pending_used != 0) { // Compressor is behind
+               pthread_cond_wait(&g_xlog_zfile_cond_free, &g_xlog_zfile_mutex);
+            }
+            if(!g_xlog_zfile_running) {
+               break;
+            }
+            xlog_zfile_swap();
+         }
+         if(g_xlog_zfile_active_used == 0) {
+            g_xlog_zfile_active_time = xlog_zfile_time();
+         }
+         size_t qty = g_xlog_zfile_block_size - g_xlog_zfile_active_used;
+         if(qty > len) {
+            qty = len;
+         }
+         memcpy(&g_xlog_zfile_active[g_xlog_zfile_active_used], data, qty);
+         g_xlog_zfile_active_used += qty;
+         data  += qty;
+         len   -= qty;
+         total += qty;
+      }
+   }
+   g_xlog_zfile_writing = false;
+   pthread_cond_broadcast(&g_xlog_zfile_cond_free);
+   pthread_mutex_unlock(&g_xlog_zfile_mutex);
+   return((total == size) ? (int)total : -1);
+}
+
+void xlog_zfile_swap(void) {
+   // Must be called with the mutex locked and the pending block free
+   uint8_t *block = g_xlog_zfile_pending;
+   g_xlog_zfile_pending      = g_xlog_zfile_active;
+   g_xlog_zfile_pending_used = g_xlog_zfile_active_used;
+   g_xlog_zfile_pending_time = g_xlog_zfile_active_time;
+   g_xlog_zfile_active       = block;
+   g_xlog_zfile_active_used  = 0;
+   pthread_cond_signal(&g_xlog_zfile_cond);
+}
+
+void *xlog_zfile_compressor(void *data) {
+   g_xlog_zfile_compressor_thread = true;
+
+   pthread_mutex_lock(&g_xlog_zfile_mutex);
+   do {
+      if(g_xlog_zfile_pending_used == 0) {
+         if(!g_xlog_zfile_running) {
+            if(g_xlog_zfile_active_used == 0) {
+               break;
+            }
+            xlog_zfile_swap(); // Write the partial block before exiting
+            continue;
+         }
+         // Partial blocks are written after the flush period so that little is lost if the process is killed
+         struct timespec timeout;
+         clock_gettime(CLOCK_MONOTONIC, &timeout);
+         timeout.tv_sec  += g_xlog_zfile_flush_period / 1000;
+         timeout.tv_nsec += (g_xlog_zfile_flush_period % 1000) * 1000000;
+         if(timeout.tv_nsec >= 1000000000) {
+            timeout.tv_sec++;
+            timeout.tv_nsec -= 1000000000;
+         }
+         int rc = pthread_cond_timedwait(&g_xlog_zfile_cond, &g_xlog_zfile_mutex, &timeout);
+         if(rc == ETIMEDOUT && g_xlog_zfile_pending_used == 0 && g_xlog_zfile_active_used != 0) {
+            xlog_zfile_swap();
+         }
+         continue;
+      }
+      uint8_t *block     = g_xlog_zfile_pending;
+      uint32_t size      = g_xlog_zfile_pending_used;
+      uint64_t timestamp = g_xlog_zfile_pending_time;
+      pthread_mutex_unlock(&g_xlog_zfile_mutex);
+
+      xlog_zfile_block_write(block, size, timestamp);
+
+      pthread_mutex_lock(&g_xlog_zfile_mutex);
+      g_xlog_zfile_pending_used = 0;
+      pthread_cond_broadcast(&g_xlog_zfile_cond_free);
+   } while(1);
+   pthread_mutex_unlock(&g_xlog_zfile_mutex);
+
+   xlog_zfile_file_close();
+   return(NULL);
+}
+
+bool xlog_zfile_block_write(const uint8_t *data, uint32_t size, uint64_t timestamp) {
+   xlog_zfile_block_t block;
+   size_t             compressed = 0;
+
+   #ifdef USE_ZLIB
+   if(g_xlog_zfile_codec == XLOG_ZFILE_BLOCK_ZLIB) {
+      uLongf len = g_xlog_zfile_compressed_max;
+      if(Z_OK == compress2(g_xlog_zfile_compressed, &len, data, size, Z_DEFAULT_COMPRESSION)) {
+         compressed = len;
+      }
+   } else
+   #endif
+   {
+      compressed = xlog_lz_compress(data, size, g_xlog_zfile_compressed, g_xlog_zfile_compressed_max);
+   }
+
+   memset(&block, 0, sizeof(block));
+   block.magic     = XLOG_ZFILE_BLOCK_MAGIC;
+   block.raw_size  = size;
+   block.timestamp = timestamp;
+   if(compressed == 0 || compressed >= size) {
+      block.codec     = XLOG_ZFILE_BLOCK_STORED;
+      block.data_size = size;
+   } else {
+      block.codec     = g_xlog_zfile_codec;
+      block.data_size = compressed;
+      data            = g_xlog_zfile_compressed;
+   }
+
+   if(g_xlog_zfile_size_max != 0 && g_xlog_zfile_index_qty > 0 &&
+      g_xlog_zfile_offset + sizeof(block) + block.data_size + ((g_xlog_zfile_index_qty + 1) * sizeof(xlog_zfile_index_entry_t)) + sizeof(xlog_zfile_trailer_t) > g_xlog_zfile_size_max) {
+      xlog_zfile_file_close();
+      xlog_zfile_rotate();
+      xlog_zfile_file_open();
+   }
+   if(g_xlog_zfile_fd < 0) {
+      return(false);
+   }
+
+   if(g_xlog_zfile_index_qty == g_xlog_zfile_index_max) {
+      uint32_t                  qty   = (g_xlog_zfile_index_max == 0) ? 64 : g_xlog_zfile_index_max * 2;
+      xlog_zfile_index_entry_t *index = (xlog_zfile_index_entry_t *)realloc(g_xlog_zfile_index, qty * sizeof(*index));
+      if(index != NULL) {
+         g_xlog_zfile_index     = index;
+         g_xlog_zfile_index_max = qty;
+      }
+   }
+   if(g_xlog_zfile_index_qty < g_xlog_zfile_index_max) {
+      g_xlog_zfile_index[g_xlog_zfile_index_qty].offset    = g_xlog_zfile_offset;
+      g_xlog_zfile_index[g_xlog_zfile_index_qty].timestamp = timestamp;
+      g_xlog_zfile_index_qty++;
+   }
+
+   struct iovec iov[2];
+   iov[0].iov_base = &block;
+   iov[0].iov_len  = sizeof(block);
+   iov[1].iov_base = (void *)data;
+   iov[1].iov_len  = block.data_size;
+
+   // One write per block keeps the quantity of flash writes low
+   ssize_t rc = writev(g_xlog_zfile_fd, iov, 2);
+   if(rc != (ssize_t)(sizeof(block) + block.data_size)) {
+      size_t done = (rc < 0) ? 0 : rc;
+      bool   ok   = (rc >= 0);
+      if(ok && done < sizeof(block)) {
+         ok   = xlog_zfile_write_all(g_xlog_zfile_fd, ((const uint8_t *)&block) + done, sizeof(block) - done);
+         done = sizeof(block);
+      }
+      if(ok) {
+         ok = xlog_zfile_write_all(g_xlog_zfile_fd, data + (done - sizeof(block)), block.data_size - (done - sizeof(block)));
+      }
+      if(!ok) {
+         int errsv = errno;
+         XLOGD_ERROR("write <%s>", strerror(errsv));
+         return(false);
+      }
+   }
+   g_xlog_zfile_offset += sizeof(block) + block.data_size;
+   return(true);
+}
+
+bool xlog_zfile_file_open(void) {
+   int fd = open(g_xlog_zfile_name, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+   if(fd < 0) {
+      int errsv = errno;
+      XLOGD_ERROR("unable to open <%s> <%s>", g_xlog_zfile_name, strerror(errsv));
+      return(false);
+   }
+   xlog_zfile_header_t header;
+   memset(&header, 0, sizeof(header));
+   memcpy(header.magic, XLOG_ZFILE_MAGIC, sizeof(header.magic));
+   header.version    = XLOG_ZFILE_VERSION;
+   header.block_size = g_xlog_zfile_block_size;
+   header.pid        = getpid();
+
+   if(!xlog_zfile_write_all(fd, &header, sizeof(header))) {
+      int errsv = errno;
+      XLOGD_ERROR("unable to write <%s> <%s>", g_xlog_zfile_name, strerror(errsv));
+      close(fd);
+      return(false);
+   }
+   g_xlog_zfile_fd        = fd;
+   g_xlog_zfile_offset    = sizeof(header);
+   g_xlog_zfile_index_qty = 0;
+   return(true);
+}
+
+void xlog_zfile_file_close(void) {
+   if(g_xlog_zfile_fd < 0) {
+      return;
+   }
+   // The index lets readers find the blocks by time without decoding the file.  Readers scan the blocks if it is missing.
+   xlog_zfile_trailer_t trailer;
+   trailer.magic  = XLOG_ZFILE_TRAILER_MAGIC;
+   trailer.qty    = g_xlog_zfile_index_qty;
+   trailer.offset = g_xlog_zfile_offset;
+
+   if(!xlog_zfile_write_all(g_xlog_zfile_fd, g_xlog_zfile_index, g_xlog_zfile_index_qty * sizeof(xlog_zfile_index_entry_t)) ||
+      !xlog_zfile_write_all(g_xlog_zfile_fd, &trailer, sizeof(trailer))) {
+      int errsv = errno;
+      XLOGD_ERROR("unable to write index <%s>", strerror(errsv));
+   }
+   close(g_xlog_zfile_fd);
+   g_xlog_zfile_fd = -1;
+}
+
+void xlog_zfile_rotate(void) {
+   // FILE.(n-1) -> FILE.n ... FILE -> FILE.1
+   size_t len = strlen(g_xlog_zfile_name) + 3;
+   char   from[len];
+   char   to[len];
+
+   for(uint32_t index = g_xlog_zfile_file_qty; index > 0; index--) {
+      if(index == 1) {
+         snprintf(from, len, "%s", g_xlog_zfile_name);
+      } else {
+         snprintf(from, len, "%s.%u", g_xlog_zfile_name, index - 1);
+      }
+      snprintf(to, len, "%s.%u", g_xlog_zfile_name, index);
+      if(rename(from, to) < 0 && errno != ENOENT) {
+         int errsv = errno;
+         XLOGD_WARN("unable to rename <%s> <%s>", from, strerror(errsv));
+      }
+   }
+}
+
+bool xlog_zfile_write_all(int fd, const void *data, size_t size) {
+   const uint8_t *pos = (const uint8_t *)data;
+   while(size > 0) {
+      ssize_t rc = write(fd, pos, size);
+      if(rc < 0) {
+         if(errno == EINTR) {
+            continue;
+         }
+         return(false);
+      }
+      pos  += rc;
+      size -= rc;
+   }
+   return(true);
+}
+
+uint64_t xlog_zfile_time(void) {
+   struct timeval tv;
+   gettimeofday(&tv, NULL);
+   return(((uint64_t)tv.tv_sec * 1000000) + tv.tv_usec);
+}
+
+size_t xlog_lz_compress(const uint8_t *src, size_t src_len, uint8_t *dst, size_t dst_size) {
+   uint32_t table[1 << XLOG_LZ_HASH_BITS]; // Position + 1 of the last occurrence of each hashed sequence
+   size_t   used   = 0;
+   size_t   anchor = 0;
+   size_t   pos    = 0;
+
+   memset(table, 0, sizeof(table));
+
+   if(src_len > XLOG_LZ_MF_LIMIT) {
+      size_t limit = src_len - XLOG_LZ_MF_LIMIT;
+      while(pos < limit) {
+         uint32_t sequence = xlog_lz_read32(&src[pos]);
+         uint32_t hash     = xlog_lz_hash(sequence);
+         size_t   ref      = table[hash];
+         table[hash] = pos + 1;
+
+         if(ref == 0 || pos - (ref - 1) > XLOG_LZ_OFFSET_MAX || xlog_lz_read32(&src[ref - 1]) != sequence) {
+            pos++;
+            continue;
+         }
+         ref--;
+         size_t match_len = XLOG_LZ_MIN_MATCH;
+         while(pos + match_len < src_len - XLOG_LZ_LAST_LITERALS && src[ref + match_len] == src[pos + match_len]) {
+            match_len++;
+         }
+         if(!xlog_lz_sequence(dst, dst_size, &used, &src[anchor], pos - anchor, pos - ref, match_len)) {
+            return(0);
+         }
+         pos   += match_len;
+         anchor = pos;
+      }
+   }
+   // The last sequence only has literals
+   if(!xlog_lz_sequence(dst, dst_size, &used, &src[anchor], src_len - anchor, 0, 0)) {
+      return(0);
+   }
+   return(used);
+}
+
+int xlog_lz_decompress(const uint8_t *src, size_t src_len, uint8_t *dst, size_t dst_size) {
+   size_t pos  = 0;
+   size_t used = 0;
+
+   while(pos < src_len) {
+      uint8_t token       = src[pos++];
+      size_t  literal_len = token >> 4;
+      if(literal_len == 15) {
+         uint8_t value;
+         do {
+            if(pos >= src_len) {
+               return(-1);
+            }
+            value        = src[pos++];
+            literal_len += value;
+         } while(value == 255);
+      }
+      if(literal_len > src_len - pos || literal_len > dst_size - used) {
+         return(-1);
+      }
+      memcpy(&dst[used], &src[pos], literal_len);
+      pos  += literal_len;
+      used += literal_len;
+
+      if(pos == src_len) { // Last sequence
+         break;
+      }
+      if(src_len - pos < 2) {
+         return(-1);
+      }
+      size_t offset = src[pos] | (src[pos + 1] << 8);
+      pos += 2;
+      if(offset == 0 || offset > used) {
+         return(-1);
+      }
+      size_t match_len = token & 0xF;
+      if(match_len == 15) {
+         uint8_t value;
+         do {
+            if(pos >= src_len) {
+               return(-1);
+            }
+            value      = src[pos++];
+            match_len += value;
+         } while(value == 255);
+      }
+      match_len += XLOG_LZ_MIN_MATCH;
+      if(match_len > dst_size - used) {
+         return(-1);
+      }
+      // The match may overlap the bytes being written
+      const uint8_t *ref = &dst[used - offset];
+      for(size_t index = 0; index < match_len; index++) {
+         dst[used + index] = ref[index];
+      }
+      used += match_len;
+   }
+   return(used);
+}
+
+uint32_t xlog_lz_hash(uint32_t value) {
+   return((value * 2654435761U) >> (32 - XLOG_LZ_HASH_BITS));
+}
+
+uint32_t xlog_lz_read32(const uint8_t *src) {
+   uint32_t value;
+   memcpy(&value, src, sizeof(value));
+   return(value);
+}
+
+bool xlog_lz_sequence(uint8_t *dst, size_t size, size_t *used, const uint8_t *literals, size_t literal_len, uint32_t offset, size_t match_len) {
+   size_t pos = *used;
+   // Token, literal length bytes, literals, offset and match length bytes
+   if(pos + 1 + (literal_len / 255) + 1 + literal_len + 2 + (match_len / 255) + 1 > size) {
+      return(false);
+   }
+   uint8_t *token = &dst[pos++];
+   *token = (literal_len >= 15) ? 0xF0 : (literal_len << 4);
+   if(literal_len >= 15) {
+      size_t len = literal_len - 15;
+      for(; len >= 255; len -= 255) {
+         dst[pos++] = 255;
+      }
+      dst[pos++] = len;
+   }
+   memcpy(&dst[pos], literals, literal_len);
+   pos += literal_len;
+
+   if(match_len != 0) {
+      dst[pos++] = offset & 0xFF;
+      dst[pos++] = offset >> 8;
+      size_t len = match_len - XLOG_LZ_MIN_MATCH;
+      *token |= (len >= 15) ? 0xF : len;
+      if(len >= 15) {
+         for(len -= 15; len >= 255; len -= 255) {
+            dst[pos++] = 255;
+         }
+         dst[pos++] = len;
+      }
+   }
+   *used = pos;
+   return(true);
+}
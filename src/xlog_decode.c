@@ -0,0 +1,507 @@
+/*
+##########################################################################
+# If not stated otherwise in this file or this component's LICENSE
+# file the following copyright and licenses apply:
+#
+# Copyright 2019 RDK Management
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+##########################################################################
+*/
+// xlog-decode - Convert a binary log file written by xlog_binary_open() into the text which would have been logged
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <errno.h>
+#include <getopt.h>
+#include <sys/time.h>
+#ifndef XLOG_MODULE_ID
+#define XLOG_MODULE_ID XLOG_MODULE_ID_XLOG
+#endif
+#include "rdkx_logger.h"
+#include "rdkx_logger_private.h"
+
+#define XLOG_DECODE_RECORD_SIZE_MAX (1024 * 1024)
+#define XLOG_DECODE_BODY_SIZE       (64 * 1024)
+#define XLOG_DECODE_MODULE_QTY_MAX  (256)
+
+typedef struct {
+   bool        valid;
+   bool        text;
+   xlog_args_t args;
+   char *      color;
+   char *      function;
+   char *      format;
+} xlog_decode_site_t;
+
+typedef struct {
+   const uint8_t *data;
+   uint32_t       size;
+   uint32_t       used;
+   bool           error;
+} xlog_decode_reader_t;
+
+static xlog_decode_site_t *g_sites      = NULL;
+static uint32_t            g_site_qty   = 0;
+static char *              g_module_names[XLOG_DECODE_MODULE_QTY_MAX];
+static uint32_t            g_module_qty = 0;
+static const char *        g_filter_modules[XLOG_DECODE_MODULE_QTY_MAX];
+static uint32_t            g_filter_module_qty = 0;
+static xlog_level_t        g_filter_level = XLOG_LEVEL_ALL;
+
+extern const char * const g_xlog_module_id_to_str[];
+
+static void         xlog_decode_usage(const char *name);
+static xlog_level_t xlog_decode_level(const char *str);
+static bool         xlog_decode_session(xlog_decode_reader_t *reader);
+static bool         xlog_decode_site(xlog_decode_reader_t *reader);
+static bool         xlog_decode_log(xlog_decode_reader_t *reader);
+static void         xlog_decode_sites_clear(void);
+static bool         xlog_decode_filter(const xlog_args_t *args);
+static size_t       xlog_decode_body(const xlog_decode_site_t *site, xlog_decode_reader_t *reader, char *body, size_t size);
+static bool         xlog_decode_get(xlog_decode_reader_t *reader, void *value, uint32_t size);
+static char *       xlog_decode_get_str(xlog_decode_reader_t *reader, bool *is_null);
+
+int main(int argc, char *argv[]) {
+   int opt;
+   while((opt = getopt(argc, argv, "m:l:h")) != -1) {
+      switch(opt) {
+         case 'm': {
+            if(g_filter_module_qty < XLOG_DECODE_MODULE_QTY_MAX) {
+               g_filter_modules[g_filter_module_qty++] = optarg;
+            }
+            break;
+         }
+         case 'l': {
+            g_filter_level = xlog_decode_level(optarg);
+            if(g_filter_level == XLOG_LEVEL_INVALID) {
+               fprintf(stderr, "invalid level <%s>\n", optarg);
+               return(1);
+            }
+            break;
+         }
+         default: {
+            xlog_decode_usage(argv[0]);
+            return((opt == 'h') ? 0 : 1);
+         }
+      }
+   }
+
+   FILE *file = stdin;
+   if(optind < argc) {
+      file = fopen(argv[optind], "rb");
+      if(file == NULL) {
+         int errsv = errno;
+         fprintf(stderr, "unable to open <%s> <%s>\n", argv[optind], strerror(errsv));
+         return(1);
+      }
+   }
+
+   uint8_t *buffer = (uint8_t *)malloc(XLOG_DECODE_RECORD_SIZE_MAX);
+   if(buffer == NULL) {
+      fprintf(stderr, "out of memory\n");
+      return(1);
+   }
+
+   int  result  = 0;
+   bool session = false;
+   do {
+      xlog_binary_record_t record;
+      size_t rc = fread(&record, 1, sizeof(record), file);
+      if(rc == 0) {
+         break;
+      }
+      if(rc != sizeof(record) || record.size < sizeof(record) || record.size > XLOG_DECODE_RECORD_SIZE_MAX) {
+         fprintf(stderr, "invalid record header\n");
+         result = 1;
+         break;
+      }
+      uint32_t size = record.size - sizeof(record);
+      if(fread(buffer, 1, size, file) != size) {
+         fprintf(stderr, "truncated record\n");
+         result = 1;
+         break;
+      }
+
+      xlog_decode_reader_t reader = { .data = buffer, .size = size, .used = 0, .error = false };
+      bool ok = true;
+
+      if(record.type == XLOG_BINARY_RECORD_SESSION) {
+         ok = session = xlog_decode_session(&reader);
+      } else if(!session) {
+         fprintf(stderr, "missing session record\n");
+         result = 1;
+         break;
+      } else if(record.type == XLOG_BINARY_RECORD_SITE) {
+         ok = xlog_decode_site(&reader);
+      } else if(record.type == XLOG_BINARY_RECORD_LOG) {
+         ok = xlog_decode_log(&reader);
+      } // Unknown record types are skipped
+
+      if(!ok) {
+         fprintf(stderr, "invalid record type <%u>\n", record.type);
+         result = 1;
+         break;
+      }
+   } while(1);
+
+   xlog_decode_sites_clear();
+   for(uint32_t index = 0; index < g_module_qty; index++) {
+      free(g_module_names[index]);
+   }
+   free(buffer);
+   if(file != stdin) {
+      fclose(file);
+   }
+   return(result);
+}
+
+void xlog_decode_usage(const char *name) {
+   fprintf(stderr, "Usage: %s [-m MODULE]... [-l LEVEL] [FILE]\n", name);
+   fprintf(stderr, "   -m MODULE  Only print records from MODULE (may be repeated)\n");
+   fprintf(stderr, "   -l LEVEL   Only print records at LEVEL or above (DEBUG, INFO, WARN, ERROR, FATAL)\n");
+}
+
+xlog_level_t xlog_decode_level(const char *str) {
+   static const char *names[] = { "ALL", "DEBUG", "INFO", "WARN", "ERROR", "FATAL" };
+   if(strncmp(str, "XLOG_LEVEL_", 11) == 0) {
+      str += 11;
+   }
+   for(uint32_t index = 0; index < sizeof(names) / sizeof(names[0]); index++) {
+      if(strcasecmp(str, names[index]) == 0) {
+         return((xlog_level_t)index);
+      }
+   }
+   return(XLOG_LEVEL_INVALID);
+}
+
+bool xlog_decode_session(xlog_decode_reader_t *reader) {
+   char     magic[sizeof(XLOG_BINARY_MAGIC)];
+   uint32_t version = 0;
+   uint32_t module_qty = 0;
+
+   if(!xlog_decode_get(reader, magic, sizeof(magic)) || memcmp(magic, XLOG_BINARY_MAGIC, sizeof(magic)) != 0) {
+      fprintf(stderr, "invalid magic\n");
+      return(false);
+   }
+   if(!xlog_decode_get(reader, &version, sizeof(version)) || version != XLOG_BINARY_VERSION) {
+      fprintf(stderr, "unsupported version <%u>\n", version);
+      return(false);
+   }
+   if(!xlog_decode_get(reader, &module_qty, sizeof(module_qty)) || module_qty > XLOG_DECODE_MODULE_QTY_MAX) {
+      return(false);
+   }
+
+   for(uint32_t index = 0; index < g_module_qty; index++) {
+      free(g_module_names[index]);
+   }
+   g_module_qty = 0;
+
+   bool mismatch = (module_qty != XLOG_MODULE_QTY_MAX);
+   for(uint32_t index = 0; index < module_qty; index++) {
+      bool is_null;
+      g_module_names[index] = xlog_decode_get_str(reader, &is_null);
+      if(g_module_names[index] == NULL) {
+         return(false);
+      }
+      g_module_qty++;
+      if(index < XLOG_MODULE_QTY_MAX && strcmp(g_module_names[index], g_xlog_module_id_to_str[index]) != 0) {
+         mismatch = true;
+      }
+   }
+   if(mismatch) {
+      fprintf(stderr, "warning: module table in the file does not match this build.  Module names may be incorrect.\n");
+   }
+
+   // Site ids restart for each session
+   xlog_decode_sites_clear();
+   return(true);
+}
+
+bool xlog_decode_site(xlog_decode_reader_t *reader) {
+   uint32_t id, flags, options;
+   int32_t  line;
+   uint16_t level, module;
+
+   xlog_decode_get(reader, &id,      sizeof(id));
+   xlog_decode_get(reader, &flags,   sizeof(flags));
+   xlog_decode_get(reader, &options, sizeof(options));
+   xlog_decode_get(reader, &line,    sizeof(line));
+   xlog_decode_get(reader, &level,   sizeof(level));
+   xlog_decode_get(reader, &module,  sizeof(module));
+   if(reader->error) {
+      return(false);
+   }
+
+   if(id >= g_site_qty) {
+      uint32_t qty = (id + 1 > g_site_qty * 2) ? id + 1 : g_site_qty * 2;
+      xlog_decode_site_t *sites = (xlog_decode_site_t *)realloc(g_sites, qty * sizeof(*sites));
+      if(sites == NULL) {
+         return(false);
+      }
+      memset(&sites[g_site_qty], 0, (qty - g_site_qty) * sizeof(*sites));
+      g_sites    = sites;
+      g_site_qty = qty;
+   }
+   xlog_decode_site_t *site = &g_sites[id];
+   free(site->color);
+   free(site->function);
+   free(site->format);
+
+   bool color_null, function_null, format_null;
+   site->color    = xlog_decode_get_str(reader, &color_null);
+   site->function = xlog_decode_get_str(reader, &function_null);
+   site->format   = xlog_decode_get_str(reader, &format_null);
+   if(reader->error) {
+      site->valid = false;
+      return(false);
+   }
+
+   site->valid         = true;
+   site->text          = (flags & 1) ? true : false;
+   site->args.options  = options & ~(XLOG_OPTS_TID | XLOG_OPTS_TNAME); // The thread is not stored in binary records
+   site->args.color    = color_null    ? NULL : site->color;
+   site->args.function = function_null ? NULL : site->function;
+   site->args.line     = line;
+   site->args.level    = (xlog_level_t)level;
+   site->args.id       = (xlog_module_id_t)module;
+   return(true);
+}
+
+bool xlog_decode_log(xlog_decode_reader_t *reader) {
+   uint32_t id, usec;
+   int64_t  sec;
+
+   xlog_decode_get(reader, &id,   sizeof(id));
+   xlog_decode_get(reader, &usec, sizeof(usec));
+   xlog_decode_get(reader, &sec,  sizeof(sec));
+   if(reader->error) {
+      return(false);
+   }
+   if(id >= g_site_qty || !g_sites[id].valid) {
+      fprintf(stderr, "unknown site id <%u>\n", id);
+      return(true);
+   }
+   const xlog_decode_site_t *site = &g_sites[id];
+
+   if(!xlog_decode_filter(&site->args)) {
+      return(true);
+   }
+
+   static char body[XLOG_DECODE_BODY_SIZE];
+   size_t body_len = xlog_decode_body(site, reader, body, sizeof(body));
+
+   char           out[XLOG_STACK_BUF_SIZE];
+   struct timeval tv = { .tv_sec = sec, .tv_usec = usec };
+   int rc = xlog_format_record(&site->args, &tv, out, sizeof(out), body, body_len);
+   if(rc > 0) {
+      fwrite(out, 1, rc, stdout);
+   }
+   return(true);
+}
+
+void xlog_decode_sites_clear(void) {
+   for(uint32_t index = 0; index < g_site_qty; index++) {
+      free(g_sites[index].color);
+      free(g_sites[index].function);
+      free(g_sites[index].format);
+   }
+   free(g_sites);
+   g_sites    = NULL;
+   g_site_qty = 0;
+}
+
+bool xlog_decode_filter(const xlog_args_t *args) {
+   if(args->level < g_filter_level) {
+      return(false);
+   }
+   if(g_filter_module_qty == 0) {
+      return(true);
+   }
+   if(((uint32_t)args->id) >= g_module_qty) {
+      return(false);
+   }
+   for(uint32_t index = 0; index < g_filter_module_qty; index++) {
+      if(strcasecmp(g_filter_modules[index], g_module_names[args->id]) == 0) {
+         return(true);
+      }
+   }
+   return(false);
+}
+
+// Format each conversion specification separately with the unpacked argument(s) to reproduce the output of vsnprintf
+#define XLOG_DECODE_SNPRINTF(VALUE) \
+   ((spec.width_arg && spec.prec_arg) ? snprintf(&body[used], size - used, fmt, width, prec, VALUE) : \
+    (spec.width_arg)                  ? snprintf(&body[used], size - used, fmt, width, VALUE)       : \
+    (spec.prec_arg)                   ? snprintf(&body[used], size - used, fmt, prec, VALUE)        : \
+                                        snprintf(&body[used], size - used, fmt, VALUE))
+
+size_t xlog_decode_body(const xlog_decode_site_t *site, xlog_decode_reader_t *reader, char *body, size_t size) {
+   if(site->text) {
+      uint32_t len = 0;
+      if(!xlog_decode_get(reader, &len, sizeof(len)) || len > reader->size - reader->used) {
+         return(0);
+      }
+      if(len >= size) {
+         len = size - 1;
+      }
+      memcpy(body, &reader->data[reader->used], len);
+      body[len] = '\0';
+      return(len);
+   }
+
+   size_t             used = 0;
+   const char *       pos  = site->format;
+   xlog_binary_spec_t spec;
+
+   do {
+      const char *next = xlog_binary_spec_next(pos, &spec);
+      const char *end  = (spec.start != NULL) ? spec.start : next;
+
+      // Literal text with "%%" converted to "%"
+      while(pos < end && used + 1 < size) {
+         if(pos[0] == '%' && pos[1] == '%') {
+            pos++;
+         }
+         body[used++] = *pos++;
+      }
+      if(spec.start == NULL || used + 1 >= size) {
+         break;
+      }
+      pos = next;
+
+      char fmt[64];
+      if(spec.len >= sizeof(fmt)) {
+         break;
+      }
+      memcpy(fmt, spec.start, spec.len);
+      fmt[spec.len] = '\0';
+
+      int     width = 0, prec = 0;
+      int64_t value = 0;
+      if(spec.width_arg) {
+         xlog_decode_get(reader, &value, sizeof(value));
+         width = (int)value;
+      }
+      if(spec.prec_arg) {
+         xlog_decode_get(reader, &value, sizeof(value));
+         prec = (int)value;
+      }
+
+      int rc = 0;
+      switch(spec.type) {
+         case XLOG_BINARY_ARG_INT:     { xlog_decode_get(reader, &value, sizeof(value)); rc = XLOG_DECODE_SNPRINTF((int)value);                  break; }
+         case XLOG_BINARY_ARG_LONG:    { xlog_decode_get(reader, &value, sizeof(value)); rc = XLOG_DECODE_SNPRINTF((long)value);                 break; }
+         case XLOG_BINARY_ARG_LLONG:   { xlog_decode_get(reader, &value, sizeof(value)); rc = XLOG_DECODE_SNPRINTF((long long)value);            break; }
+         case XLOG_BINARY_ARG_SIZE:    { xlog_decode_get(reader, &value, sizeof(value)); rc = XLOG_DECODE_SNPRINTF((size_t)value);               break; }
+         case XLOG_BINARY_ARG_INTMAX:  { xlog_decode_get(reader, &value, sizeof(value)); rc = XLOG_DECODE_SNPRINTF((intmax_t)value);             break; }
+         case XLOG_BINARY_ARG_PTRDIFF: { xlog_decode_get(reader, &value, sizeof(value)); rc = XLOG_DECODE_SNPRINTF((ptrdiff_t)value);            break; }
+         case XLOG_BINARY_ARG_PTR:     { xlog_decode_get(reader, &value, sizeof(value)); rc = XLOG_DECODE_SNPRINTF((void *)(uintptr_t)value);    break; }
+         case XLOG_BINARY_ARG_DOUBLE: {
+            double val = 0;
+            xlog_decode_get(reader, &val, sizeof(val));
+            rc = XLOG_DECODE_SNPRINTF(val);
+            break;
+         }
+         case XLOG_BINARY_ARG_LDOUBLE: {
+            long double val = 0;
+            xlog_decode_get(reader, &val, sizeof(val));
+            rc = XLOG_DECODE_SNPRINTF(val);
+            break;
+         }
+         case XLOG_BINARY_ARG_STRING: {
+            uint32_t len = 0;
+            if(!xlog_decode_get(reader, &len, sizeof(len))) {
+               break;
+            }
+            if(len == 0xFFFFFFFF) {
+               rc = XLOG_DECODE_SNPRINTF((const char *)NULL);
+               break;
+            }
+            if(len > reader->size - reader->used) {
+               reader->error = true;
+               break;
+            }
+            char *str = (char *)malloc(len + 1);
+            if(str == NULL) {
+               break;
+            }
+            memcpy(str, &reader->data[reader->used], len);
+            str[len] = '\0';
+            reader->used += len;
+            rc = XLOG_DECODE_SNPRINTF(str);
+            free(str);
+            break;
+         }
+         case XLOG_BINARY_ARG_ERRNO: {
+            xlog_decode_get(reader, &value, sizeof(value));
+            int errsv = errno;
+            errno = (int)value;
+            rc = snprintf(&body[used], size - used, fmt, 0);
+            errno = errsv;
+            break;
+         }
+         default: {
+            break;
+         }
+      }
+      if(reader->error || rc < 0) {
+         break;
+      }
+      used += rc;
+   } while(used + 1 < size);
+
+   if(used >= size) {
+      used = size - 1;
+   }
+   body[used] = '\0';
+   return(used);
+}
+
+bool xlog_decode_get(xlog_decode_reader_t *reader, void *value, uint32_t size) {
+   if(reader->error || size > reader->size - reader->used) {
+      reader->error = true;
+      return(false);
+   }
+   memcpy(value, &reader->data[reader->used], size);
+   reader->used += size;
+   return(true);
+}
+
+char *xlog_decode_get_str(xlog_decode_reader_t *reader, bool *is_null) {
+   uint16_t len = 0;
+   *is_null = false;
+   if(!xlog_decode_get(reader, &len, sizeof(len))) {
+      return(NULL);
+   }
+   if(len == 0xFFFF) {
+      *is_null = true;
+      len = 0;
+   }
+   if(len > reader->size - reader->used) {
+      reader->error = true;
+      return(NULL);
+   }
+   char *str = (char *)malloc(len + 1);
+   if(str == NULL) {
+      reader->error = true;
+      return(NULL);
+   }
+   memcpy(str, &reader->data[reader->used], len);
+   str[len] = '\0';
+   reader->used += len;
+   return(str);
+}
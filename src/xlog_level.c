@@ -0,0 +1,131 @@
+/*
+##########################################################################
+# If not stated otherwise in this file or this component's LICENSE
+# file the following copyright and licenses apply:
+#
+# Copyright 2019 RDK Management
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+##########################################################################
+*/
+// xlog-level - Set the level of a module in every process attached to the shared memory level table (xlog_shm_attach)
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <strings.h>
+#ifndef XLOG_MODULE_ID
+#define XLOG_MODULE_ID XLOG_MODULE_ID_XLOG
+#endif
+#include "rdkx_logger.h"
+#include "rdkx_logger_private.h"
+
+extern const char * const g_xlog_module_id_to_str[];
+
+static const char *g_level_names[] = { "ALL", "DEBUG", "INFO", "WARN", "ERROR", "FATAL" };
+
+static void xlog_level_usage(const char *name);
+static bool xlog_level_module(const char *str, uint32_t *first, uint32_t *last);
+static int  xlog_level_parse(const char *str);
+static void xlog_level_print(xlog_shm_t *shm, uint32_t first, uint32_t last);
+
+int main(int argc, char *argv[]) {
+   if(argc < 2) {
+      xlog_level_usage(argv[0]);
+      return(1);
+   }
+   const char *command = argv[1];
+   uint32_t    first   = 0;
+   uint32_t    last    = XLOG_MODULE_QTY_MAX - 1;
+   int         level   = XLOG_SHM_LEVEL_UNSET;
+   bool        get     = (0 == strcmp(command, "get"));
+
+   if(0 == strcmp(command, "set") && argc == 4) {
+      level = xlog_level_parse(argv[3]);
+      if(level < 0) {
+         fprintf(stderr, "invalid level <%s>\n", argv[3]);
+         return(1);
+      }
+   } else if(0 == strcmp(command, "clear") && argc == 3) {
+      level = XLOG_SHM_LEVEL_UNSET;
+   } else if(!get || argc > 3) {
+      xlog_level_usage(argv[0]);
+      return((0 == strcmp(command, "-h")) ? 0 : 1);
+   }
+   if(argc >= 3 && !xlog_level_module(argv[2], &first, &last)) {
+      fprintf(stderr, "invalid module <%s>\n", argv[2]);
+      return(1);
+   }
+
+   xlog_shm_t *shm = xlog_shm_open(!get, !get);
+   if(shm == NULL) {
+      fprintf(stderr, "unable to open the level table%s\n", get ? " (no process has attached)" : "");
+      return(1);
+   }
+
+   if(get) {
+      xlog_level_print(shm, first, last);
+   } else {
+      for(uint32_t index = first; index <= last; index++) {
+         __atomic_store_n(&shm->levels[index], (uint8_t)level, __ATOMIC_RELAXED);
+      }
+      // Cleared entries are not applied.  Attached processes keep their current level.
+      xlog_shm_notify(shm);
+   }
+
+   xlog_shm_close(shm);
+   return(0);
+}
+
+void xlog_level_usage(const char *name) {
+   fprintf(stderr, "Usage: %s set MODULE|all LEVEL\n", name);
+   fprintf(stderr, "       %s clear MODULE|all\n", name);
+   fprintf(stderr, "       %s get [MODULE]\n", name);
+   fprintf(stderr, "LEVEL is one of ALL, DEBUG, INFO, WARN, ERROR or FATAL\n");
+}
+
+bool xlog_level_module(const char *str, uint32_t *first, uint32_t *last) {
+   if(0 == strcasecmp(str, "all")) {
+      *first = 0;
+      *last  = XLOG_MODULE_QTY_MAX - 1;
+      return(true);
+   }
+   rdkx_logger_module_t *mod = rdkx_logger_module_str_to_index(str, strlen(str));
+   if(mod == NULL || mod->id >= XLOG_MODULE_QTY_MAX) {
+      return(false);
+   }
+   *first = mod->id;
+   *last  = mod->id;
+   return(true);
+}
+
+int xlog_level_parse(const char *str) {
+   // Accept both the short name and the name used in the json configuration file (XLOG_LEVEL_DEBUG)
+   if(0 == strncasecmp(str, "XLOG_LEVEL_", 11)) {
+      str += 11;
+   }
+   for(uint32_t index = 0; index < sizeof(g_level_names) / sizeof(g_level_names[0]); index++) {
+      if(0 == strcasecmp(str, g_level_names[index])) {
+         return(index);
+      }
+   }
+   return(-1);
+}
+
+void xlog_level_print(xlog_shm_t *shm, uint32_t first, uint32_t last) {
+   for(uint32_t index = first; index <= last; index++) {
+      uint8_t level = __atomic_load_n(&shm->levels[index], __ATOMIC_RELAXED);
+      printf("%-16s %s\n", g_xlog_module_id_to_str[index], (level < XLOG_LEVEL_INVALID) ? g_level_names[level] : "-");
+   }
+}
@@ -0,0 +1,95 @@
+/*
+##########################################################################
+# If not stated otherwise in this file or this component's LICENSE
+# file the following copyright and licenses apply:
+#
+# Copyright 2019 RDK Management
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+##########################################################################
+*/
+// xlog-recorder - Print the records in a flight recorder file written by xlog_recorder_open() from oldest to newest
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#ifndef XLOG_MODULE_ID
+#define XLOG_MODULE_ID XLOG_MODULE_ID_XLOG
+#endif
+#include "rdkx_logger.h"
+#include "rdkx_logger_private.h"
+
+static void xlog_recorder_usage(const char *name);
+static void xlog_recorder_print(const xlog_args_t *args, const struct timeval *tv, const char *body, size_t len, void *data);
+
+int main(int argc, char *argv[]) {
+   if(argc != 2 || 0 == strcmp(argv[1], "-h")) {
+      xlog_recorder_usage(argv[0]);
+      return((argc == 2) ? 0 : 1);
+   }
+   const char *filename = argv[1];
+
+   int fd = open(filename, O_RDONLY);
+   if(fd < 0) {
+      int errsv = errno;
+      fprintf(stderr, "unable to open <%s> <%s>\n", filename, strerror(errsv));
+      return(1);
+   }
+   struct stat st;
+   if(fstat(fd, &st) < 0 || st.st_size == 0) {
+      fprintf(stderr, "invalid file <%s>\n", filename);
+      close(fd);
+      return(1);
+   }
+   // The file can be read while the process is still writing to it
+   const xlog_recorder_header_t *rec = (const xlog_recorder_header_t *)mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+   close(fd);
+   if(rec == MAP_FAILED) {
+      int errsv = errno;
+      fprintf(stderr, "unable to map <%s> <%s>\n", filename, strerror(errsv));
+      return(1);
+   }
+   if(!xlog_recorder_valid(rec, st.st_size)) {
+      fprintf(stderr, "<%s> is not a flight recorder file\n", filename);
+      munmap((void *)rec, st.st_size);
+      return(1);
+   }
+
+   uint64_t head = rec->head;
+   int      qty  = xlog_recorder_foreach(rec, xlog_recorder_print, stdout);
+
+   fprintf(stderr, "pid <%u> records <%d> written <%llu> slots <%u>\n", rec->pid, qty, (unsigned long long)head, rec->slot_qty);
+
+   munmap((void *)rec, st.st_size);
+   return(0);
+}
+
+void xlog_recorder_usage(const char *name) {
+   fprintf(stderr, "Usage: %s FILE\n", name);
+}
+
+void xlog_recorder_print(const xlog_args_t *args, const struct timeval *tv, const char *body, size_t len, void *data) {
+   char buffer[XLOG_STACK_BUF_SIZE];
+   int  rc = xlog_format_record(args, tv, buffer, sizeof(buffer), body, len);
+
+   if(rc > 0) {
+      fwrite(buffer, 1, rc, (FILE *)data);
+   }
+}
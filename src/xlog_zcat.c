@@ -0,0 +1,249 @@
+/*
+##########################################################################
+# If not stated otherwise in this file or this component's LICENSE
+# file the following copyright and licenses apply:
+#
+# Copyright 2019 RDK Management
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+##########################################################################
+*/
+// xlog-zcat - Decompress the compressed log files written by xlog_zfile_open() to stdout
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#ifdef USE_ZLIB
+#include <zlib.h>
+#endif
+#ifndef XLOG_MODULE_ID
+#define XLOG_MODULE_ID XLOG_MODULE_ID_XLOG
+#endif
+#include "rdkx_logger.h"
+#include "rdkx_logger_private.h"
+
+typedef struct {
+   bool     index;  // Print the block index instead of the records
+   uint64_t start;  // Skip the blocks which end before this time (us since the epoch)
+} xlog_zcat_opts_t;
+
+static void xlog_zcat_usage(const char *name);
+static int  xlog_zcat_file(const char *filename, const xlog_zcat_opts_t *opts);
+static bool xlog_zcat_block_get(const uint8_t *data, size_t size, uint64_t offset, xlog_zfile_block_t *block);
+static int  xlog_zcat_block_decode(const xlog_zfile_block_t *block, const uint8_t *src, uint8_t *dst, size_t dst_size);
+
+int main(int argc, char *argv[]) {
+   xlog_zcat_opts_t opts = { .index = false, .start = 0 };
+   int              opt;
+
+   while((opt = getopt(argc, argv, "is:h")) != -1) {
+      switch(opt) {
+         case 'i': {
+            opts.index = true;
+            break;
+         }
+         case 's': {
+            opts.start = strtoull(optarg, NULL, 0) * 1000000ULL;
+            break;
+         }
+         case 'h': {
+            xlog_zcat_usage(argv[0]);
+            return(0);
+         }
+         default: {
+            xlog_zcat_usage(argv[0]);
+            return(1);
+         }
+      }
+   }
+   if(optind >= argc) {
+      xlog_zcat_usage(argv[0]);
+      return(1);
+   }
+   int rc = 0;
+   for(int index = optind; index < argc; index++) {
+      if(xlog_zcat_file(argv[index], &opts) < 0) {
+         rc = 1;
+      }
+   }
+   return(rc);
+}
+
+void xlog_zcat_usage(const char *name) {
+   fprintf(stderr, "Usage: %s [-i] [-s SECONDS] FILE...\n", name);
+   fprintf(stderr, "  -i          print the block index\n");
+   fprintf(stderr, "  -s SECONDS  start at the block containing this time (seconds since the epoch)\n");
+}
+
+int xlog_zcat_file(const char *filename, const xlog_zcat_opts_t *opts) {
+   int fd = open(filename, O_RDONLY);
+   if(fd < 0) {
+      int errsv = errno;
+      fprintf(stderr, "unable to open <%s> <%s>\n", filename, strerror(errsv));
+      return(-1);
+   }
+   struct stat st;
+   if(fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(xlog_zfile_header_t)) {
+      fprintf(stderr, "invalid file <%s>\n", filename);
+      close(fd);
+      return(-1);
+   }
+   size_t         size = st.st_size;
+   const uint8_t *data = (const uint8_t *)mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+   close(fd);
+   if(data == MAP_FAILED) {
+      int errsv = errno;
+      fprintf(stderr, "unable to map <%s> <%s>\n", filename, strerror(errsv));
+      return(-1);
+   }
+   const xlog_zfile_header_t *header = (const xlog_zfile_header_t *)data;
+   if(memcmp(header->magic, XLOG_ZFILE_MAGIC, sizeof(header->magic)) != 0 || header->version != XLOG_ZFILE_VERSION) {
+      fprintf(stderr, "<%s> is not a compressed log file\n", filename);
+      munmap((void *)data, size);
+      return(-1);
+   }
+
+   // Use the index if the file was closed.  Otherwise (ie. the process was killed) scan the blocks.
+   xlog_zfile_index_entry_t *index     = NULL;
+   uint32_t                  index_qty = 0;
+   const char *              source    = "index";
+   if(size >= sizeof(xlog_zfile_header_t) + sizeof(xlog_zfile_trailer_t)) {
+      xlog_zfile_trailer_t trailer;
+      memcpy(&trailer, &data[size - sizeof(trailer)], sizeof(trailer));
+      if(trailer.magic == XLOG_ZFILE_TRAILER_MAGIC && trailer.offset + ((uint64_t)trailer.qty * sizeof(*index)) + sizeof(trailer) == size) {
+         index_qty = trailer.qty;
+         index     = (xlog_zfile_index_entry_t *)malloc((index_qty + 1) * sizeof(*index));
+         if(index != NULL) {
+            memcpy(index, &data[trailer.offset], index_qty * sizeof(*index));
+         }
+      }
+   }
+   if(index == NULL) {
+      uint32_t index_max = 0;
+      source    = "scan";
+      index_qty = 0;
+      xlog_zfile_block_t block;
+      for(uint64_t offset = sizeof(xlog_zfile_header_t); xlog_zcat_block_get(data, size, offset, &block);) {
+         if(index_qty == index_max) {
+            index_max = (index_max == 0) ? 64 : index_max * 2;
+            xlog_zfile_index_entry_t *entries = (xlog_zfile_index_entry_t *)realloc(index, index_max * sizeof(*index));
+            if(entries == NULL) {
+               break;
+            }
+            index = entries;
+         }
+         index[index_qty].offset    = offset;
+         index[index_qty].timestamp = block.timestamp;
+         index_qty++;
+         offset += sizeof(block) + block.data_size;
+      }
+   }
+
+   uint32_t first = 0;
+   for(uint32_t entry = 1; entry < index_qty; entry++) {
+      if(index[entry].timestamp <= opts->start) {
+         first = entry;
+      }
+   }
+
+   uint8_t *buffer     = (uint8_t *)malloc(header->block_size);
+   uint64_t raw_total  = 0;
+   uint64_t data_total = 0;
+   int      rc         = 0;
+
+   for(uint32_t entry = first; entry < index_qty && buffer != NULL; entry++) {
+      xlog_zfile_block_t block;
+      if(!xlog_zcat_block_get(data, size, index[entry].offset, &block)) {
+         fprintf(stderr, "<%s> invalid block at offset <%llu>\n", filename, (unsigned long long)index[entry].offset);
+         rc = -1;
+         break;
+      }
+      raw_total  += block.raw_size;
+      data_total += block.data_size;
+
+      if(opts->index) {
+         time_t    sec = block.timestamp / 1000000;
+         struct tm tm_val;
+         char      str[32];
+         localtime_r(&sec, &tm_val);
+         strftime(str, sizeof(str), "%Y%m%d %H:%M:%S", &tm_val);
+         printf("block <%u> offset <%llu> time <%s.%06u> codec <%u> raw <%u> data <%u>\n", entry, (unsigned long long)index[entry].offset,
+                str, (uint32_t)(block.timestamp % 1000000), block.codec, block.raw_size, block.data_size);
+         continue;
+      }
+      int len = xlog_zcat_block_decode(&block, &data[index[entry].offset + sizeof(block)], buffer, header->block_size);
+      if(len < 0) {
+         fprintf(stderr, "<%s> unable to decode block at offset <%llu>\n", filename, (unsigned long long)index[entry].offset);
+         rc = -1;
+         continue;
+      }
+      fwrite(buffer, 1, len, stdout);
+   }
+   if(opts->index) {
+      printf("blocks <%u> from <%s> raw <%llu> compressed <%llu> ratio <%.1f>\n", index_qty - first, source, (unsigned long long)raw_total,
+             (unsigned long long)data_total, (data_total == 0) ? 0.0 : (double)raw_total / data_total);
+   }
+   free(buffer);
+   free(index);
+   munmap((void *)data, size);
+   return(rc);
+}
+
+bool xlog_zcat_block_get(const uint8_t *data, size_t size, uint64_t offset, xlog_zfile_block_t *block) {
+   // Block headers are not aligned in the file
+   if(offset + sizeof(*block) > size) {
+      return(false);
+   }
+   memcpy(block, &data[offset], sizeof(*block));
+   return(block->magic == XLOG_ZFILE_BLOCK_MAGIC && offset + sizeof(*block) + block->data_size <= size);
+}
+
+int xlog_zcat_block_decode(const xlog_zfile_block_t *block, const uint8_t *src, uint8_t *dst, size_t dst_size) {
+   if(block->raw_size > dst_size) {
+      return(-1);
+   }
+   switch(block->codec) {
+      case XLOG_ZFILE_BLOCK_STORED: {
+         if(block->data_size != block->raw_size) {
+            return(-1);
+         }
+         memcpy(dst, src, block->data_size);
+         return(block->data_size);
+      }
+      case XLOG_ZFILE_BLOCK_LZ: {
+         int len = xlog_lz_decompress(src, block->data_size, dst, dst_size);
+         return((len == (int)block->raw_size) ? len : -1);
+      }
+      #ifdef USE_ZLIB
+      case XLOG_ZFILE_BLOCK_ZLIB: {
+         uLongf len = dst_size;
+         if(Z_OK != uncompress(dst, &len, src, block->data_size) || len != block->raw_size) {
+            return(-1);
+         }
+         return(len);
+      }
+      #endif
+      default: {
+         fprintf(stderr, "unsupported codec <%u>\n", block->codec);
+         return(-1);
+      }
+   }
+}